@@ -0,0 +1,373 @@
+//=====================================================================================================================
+//
+//   BoundedQueueTest.cpp
+//
+//   Standalone test and throughput benchmark for MPMCQueue and SPSCQueue.  They are compared against the
+//    primitives they were written to replace: a pair of LockFreeStacks, and a spin-locked std::deque.
+//    Build as a console program, together with the Simpleton library sources.  Returns non-zero on failure
+//
+//   The lazy man's utility library
+//   Joshua Barczak
+//   Copyright 2016 Joshua Barczak
+//
+//   LICENSE:  See Doc\License.txt for terms and conditions
+//
+//=====================================================================================================================
+
+#include "BoundedQueue.h"
+#include "LockFreeStack.h"
+#include "SpinLock.h"
+#include "Thread.h"
+#include "Timer.h"
+
+#include <stdio.h>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <algorithm>
+
+using namespace Simpleton;
+
+namespace
+{
+    int g_nFailures = 0;
+
+    void Check( bool b, const char* pWhat )
+    {
+        printf( "%s: %s\n", b ? "PASS" : "FAIL", pWhat );
+        if( !b )
+            g_nFailures++;
+    }
+
+    const size_t CAPACITY = 1024;
+
+    //=====================================================================================================================
+    //  Every channel under test has the same non-blocking interface
+    //=====================================================================================================================
+
+    class MPMCChannel
+    {
+    public:
+        MPMCChannel() : m_Queue(CAPACITY) {}
+        bool TryPush( uint64 n ) { return m_Queue.TryPush(n); }
+        bool TryPop( uint64& n ) { return m_Queue.TryPop(n); }
+        void Push( uint64 n ) { m_Queue.Push(n); }
+        void Pop( uint64& n ) { m_Queue.Pop(n); }
+    private:
+        MPMCQueue<uint64> m_Queue;
+    };
+
+    class SPSCChannel
+    {
+    public:
+        SPSCChannel() : m_Queue(CAPACITY) {}
+        bool TryPush( uint64 n ) { return m_Queue.TryPush(n); }
+        bool TryPop( uint64& n ) { return m_Queue.TryPop(n); }
+        void Push( uint64 n ) { m_Queue.Push(n); }
+        void Pop( uint64& n ) { m_Queue.Pop(n); }
+    private:
+        SPSCQueue<uint64> m_Queue;
+    };
+
+    /// Producers take a node from a free list, fill it, and push it onto the full list.  Consumers do the reverse.
+    ///  Both lists are LIFO, so there is no ordering between items
+    class StackChannel
+    {
+    public:
+        StackChannel() : m_Nodes(CAPACITY)
+        {
+            for( size_t i=0; i<m_Nodes.size(); i++ )
+                m_Free.push_front( &m_Nodes[i] );
+        }
+        bool TryPush( uint64 n )
+        {
+            ValueNode* pNode = static_cast<ValueNode*>( m_Free.pop_front() );
+            if( !pNode )
+                return false;
+            pNode->nValue = n;
+            m_Full.push_front( pNode );
+            return true;
+        }
+        bool TryPop( uint64& n )
+        {
+            ValueNode* pNode = static_cast<ValueNode*>( m_Full.pop_front() );
+            if( !pNode )
+                return false;
+            n = pNode->nValue;
+            m_Free.push_front( pNode );
+            return true;
+        }
+    private:
+        struct ValueNode : public LockFreeStack::Node
+        {
+            uint64 nValue;
+        };
+        std::vector<ValueNode> m_Nodes;
+        LockFreeStack m_Free;
+        LockFreeStack m_Full;
+    };
+
+    /// What ThreadPool used to do
+    class LockedDequeChannel
+    {
+    public:
+        bool TryPush( uint64 n )
+        {
+            m_Lock.Take();
+            bool bRoom = m_Items.size() < CAPACITY;
+            if( bRoom )
+                m_Items.push_back(n);
+            m_Lock.Release();
+            return bRoom;
+        }
+        bool TryPop( uint64& n )
+        {
+            m_Lock.Take();
+            bool bAny = !m_Items.empty();
+            if( bAny )
+            {
+                n = m_Items.front();
+                m_Items.pop_front();
+            }
+            m_Lock.Release();
+            return bAny;
+        }
+    private:
+        SpinLock m_Lock;
+        std::deque<uint64> m_Items;
+    };
+
+    /// Calls 'tryOp' until it succeeds.  Backs off to a yield, so that oversubscribed runs still make progress
+    template< class Try_T >
+    void Retry( const Try_T& tryOp )
+    {
+        uint nFails = 0;
+        while( !tryOp() )
+        {
+            if( ++nFails < 64 )
+                _mm_pause();
+            else
+                std::this_thread::yield();
+        }
+    }
+
+    //=====================================================================================================================
+    /// Producers send (producer index, sequence number) pairs.  Consumers check that each producer's items arrive
+    ///  in order, and sum up what they receive
+    //=====================================================================================================================
+    template< class Channel_T >
+    class ChannelThread : public Thread
+    {
+    public:
+
+        Channel_T* m_pChannel;
+        std::atomic<uint64>* m_pConsumed;   ///< Items received by all consumers, so that they know when to stop
+        uint64 m_nTotal;                    ///< Items sent by all producers
+        uint32 m_nProducer;                 ///< Index of this producer, or ~0 for a consumer
+        uint32 m_nItems;                    ///< Items sent by this producer
+        uint32 m_nProducers;
+        bool m_bBlocking;                   ///< Use Push/Pop, rather than TryPush/TryPop
+        bool m_bCheckOrder;
+
+        bool m_bInOrder;
+        uint64 m_nSum;
+
+    protected:
+
+        virtual void OnExecuteThread()
+        {
+            m_bInOrder = true;
+            m_nSum = 0;
+            if( m_nProducer != ~0u )
+                Produce();
+            else
+                Consume();
+        }
+
+    private:
+
+        void Produce()
+        {
+            for( uint32 i=0; i<m_nItems; i++ )
+            {
+                uint64 n = ((uint64)m_nProducer << 32) | i;
+                if( m_bBlocking )
+                    BlockingPush( *m_pChannel, n );
+                else
+                    Retry( [&]() { return m_pChannel->TryPush(n); } );
+            }
+        }
+
+        void Consume()
+        {
+            std::vector<int64> last( m_nProducers, -1 );
+            uint64 nTotal = m_nTotal;
+            while( m_pConsumed->load( std::memory_order_relaxed ) < nTotal )
+            {
+                uint64 n;
+                if( m_bBlocking )
+                {
+                    // a blocking pop would never return once the last item is gone, so only one is issued per
+                    //  item.  Claim the right to pop first
+                    if( m_pConsumed->fetch_add(1) >= nTotal )
+                        break;
+                    BlockingPop( *m_pChannel, n );
+                }
+                else
+                {
+                    if( !m_pChannel->TryPop(n) )
+                    {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    m_pConsumed->fetch_add(1, std::memory_order_relaxed );
+                }
+
+                uint32 nProducer = (uint32)(n >> 32);
+                int64 nSeq = (int64)(n & 0xffffffff);
+                if( m_bCheckOrder && ( nProducer >= m_nProducers || nSeq <= last[nProducer] ) )
+                    m_bInOrder = false;
+                if( nProducer < m_nProducers )
+                    last[nProducer] = nSeq;
+                m_nSum += n;
+            }
+        }
+
+        template< class C > static void BlockingPush( C& c, uint64 n ) { c.Push(n); }
+        template< class C > static void BlockingPop( C& c, uint64& n ) { c.Pop(n); }
+        static void BlockingPush( StackChannel& c, uint64 n ) { Retry( [&]() { return c.TryPush(n); } ); }
+        static void BlockingPop( StackChannel& c, uint64& n ) { Retry( [&]() { return c.TryPop(n); } ); }
+        static void BlockingPush( LockedDequeChannel& c, uint64 n ) { Retry( [&]() { return c.TryPush(n); } ); }
+        static void BlockingPop( LockedDequeChannel& c, uint64& n ) { Retry( [&]() { return c.TryPop(n); } ); }
+    };
+
+    /// Runs producers and consumers to completion.  Returns microseconds taken.
+    ///   'bOK' is set if every item arrived once, and in order where the channel promises it
+    template< class Channel_T >
+    unsigned long Run( uint32 nProducers, uint32 nConsumers, uint32 nItemsPerProducer, bool bBlocking, bool bFIFO, bool& bOK )
+    {
+        Channel_T channel;
+        std::atomic<uint64> nConsumed(0);
+        uint64 nTotal = (uint64) nProducers * nItemsPerProducer;
+
+        std::vector< ChannelThread<Channel_T> > threads( nProducers + nConsumers );
+        for( uint32 i=0; i<threads.size(); i++ )
+        {
+            threads[i].m_pChannel = &channel;
+            threads[i].m_pConsumed = &nConsumed;
+            threads[i].m_nTotal = nTotal;
+            threads[i].m_nProducer = (i < nProducers) ? i : ~0u;
+            threads[i].m_nItems = nItemsPerProducer;
+            threads[i].m_nProducers = nProducers;
+            threads[i].m_bBlocking = bBlocking;
+            threads[i].m_bCheckOrder = bFIFO;
+        }
+
+        Timer timer;
+        for( size_t i=0; i<threads.size(); i++ )
+            threads[i].Start();
+        for( size_t i=0; i<threads.size(); i++ )
+            threads[i].WaitForCompletion();
+        unsigned long nMicros = std::max( 1ul, timer.TickMicroSeconds() );
+
+        // sum of (p<<32 | i) over all producers p and sequence numbers i
+        uint64 nN = nItemsPerProducer;
+        uint64 nExpected = 0;
+        for( uint64 p=0; p<nProducers; p++ )
+            nExpected += (p << 32)*nN + nN*(nN-1)/2;
+
+        uint64 nSum = 0;
+        bOK = true;
+        for( size_t i=0; i<threads.size(); i++ )
+        {
+            nSum += threads[i].m_nSum;
+            bOK = bOK && threads[i].m_bInOrder;
+        }
+        bOK = bOK && nSum == nExpected;
+        return nMicros;
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void TestSerial()
+    {
+        MPMCQueue<int> q(5);
+        int n;
+        bool bOK = q.GetCapacity() == 8 && !q.TryPop(n);
+        for( int i=0; i<8; i++ )
+            bOK = bOK && q.TryPush(i);
+        bOK = bOK && !q.TryPush(8) && q.GetSizeApprox() == 8;
+        for( int i=0; i<8; i++ )
+            bOK = bOK && q.TryPop(n) && n == i;
+        bOK = bOK && !q.TryPop(n);
+        Check( bOK, "MPMCQueue fills, refuses when full, and empties in order" );
+
+        SPSCQueue<int> s(8);
+        bOK = s.GetCapacity() == 8 && !s.TryPop(n);
+        for( int lap=0; lap<3; lap++ )
+        {
+            for( int i=0; i<8; i++ )
+                bOK = bOK && s.TryPush(i);
+            bOK = bOK && !s.TryPush(8);
+            for( int i=0; i<8; i++ )
+                bOK = bOK && s.TryPop(n) && n == i;
+            bOK = bOK && !s.TryPop(n);
+        }
+        Check( bOK, "SPSCQueue fills, refuses when full, and empties in order" );
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void TestThreads()
+    {
+        bool bOK;
+        Run<MPMCChannel>( 4, 4, 200000, false, true, bOK );
+        Check( bOK, "MPMCQueue, 4 producers, 4 consumers, try" );
+        Run<MPMCChannel>( 4, 4, 200000, true, true, bOK );
+        Check( bOK, "MPMCQueue, 4 producers, 4 consumers, blocking" );
+        Run<SPSCChannel>( 1, 1, 1000000, false, true, bOK );
+        Check( bOK, "SPSCQueue, try" );
+        Run<SPSCChannel>( 1, 1, 1000000, true, true, bOK );
+        Check( bOK, "SPSCQueue, blocking" );
+    }
+
+    //=====================================================================================================================
+    /// Items per microsecond, for each channel and producer/consumer count
+    //=====================================================================================================================
+    template< class Channel_T >
+    void Time( const char* pName, uint32 nProducers, uint32 nConsumers, uint32 nItems, bool bBlocking, bool bFIFO )
+    {
+        bool bOK;
+        unsigned long nMicros = Run<Channel_T>( nProducers, nConsumers, nItems, bBlocking, bFIFO, bOK );
+        printf( "  %-14s %2u -> %-2u %-8s %8.2f M items/s\n", pName, nProducers, nConsumers, bBlocking ? "blocking" : "try",
+                (double) nItems*nProducers / nMicros );
+        Check( bOK, "items arrive intact" );
+    }
+
+    void Benchmark()
+    {
+        const uint32 ITEMS = 1000000;
+        unsigned int nMaxThreads = std::max( 2u, std::min( 16u, Thread::GetHardwareThreadCount() ) );
+
+        Time<SPSCChannel>(        "SPSCQueue",    1, 1, ITEMS, false, true );
+        Time<SPSCChannel>(        "SPSCQueue",    1, 1, ITEMS, true,  true );
+        for( uint32 n=1; 2*n<=nMaxThreads; n *= 2 )
+        {
+            Time<MPMCChannel>(        "MPMCQueue",    n, n, ITEMS/n, false, true );
+            Time<MPMCChannel>(        "MPMCQueue",    n, n, ITEMS/n, true,  true );
+            Time<StackChannel>(       "LockFreeStack", n, n, ITEMS/n, false, false );
+            Time<LockedDequeChannel>( "SpinLock+deque", n, n, ITEMS/n, false, true );
+        }
+    }
+}
+
+int main()
+{
+    TestSerial();
+    TestThreads();
+    Benchmark();
+
+    printf( "%d failures\n", g_nFailures );
+    return g_nFailures ? 1 : 0;
+}
@@ -0,0 +1,256 @@
+//=====================================================================================================================
+//
+//   ConcurrentPoolAllocatorTest.cpp
+//
+//   Standalone test and allocation-rate benchmark for ConcurrentPoolAllocator.
+//    Build as a console program, together with the Simpleton library sources.  Returns non-zero on failure
+//
+//   The lazy man's utility library
+//   Joshua Barczak
+//   Copyright 2016 Joshua Barczak
+//
+//   LICENSE:  See Doc\License.txt for terms and conditions
+//
+//=====================================================================================================================
+
+#include "ConcurrentPoolAllocator.h"
+#include "Thread.h"
+#include "Timer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+
+using namespace Simpleton;
+
+namespace
+{
+    int g_nFailures = 0;
+
+    void Check( bool b, const char* pWhat )
+    {
+        printf( "%s: %s\n", b ? "PASS" : "FAIL", pWhat );
+        if( !b )
+            g_nFailures++;
+    }
+
+    /// Counts the distinct 64KB chunks that a set of allocations came from.  Chunks are 64KB aligned by malloc
+    ///  only by accident, so this counts gaps between consecutive allocations instead
+    size_t CountChunks( std::vector<char*> ptrs )
+    {
+        std::sort( ptrs.begin(), ptrs.end() );
+        size_t nChunks = ptrs.empty() ? 0 : 1;
+        for( size_t i=1; i<ptrs.size(); i++ )
+        {
+            if( ptrs[i] - ptrs[i-1] > 1024 )
+                nChunks++;
+        }
+        return nChunks;
+    }
+
+    //=====================================================================================================================
+    /// Interleaved allocations from many live allocators must not evict each other's chunks
+    //=====================================================================================================================
+    void TestManyAllocators()
+    {
+        const int ALLOCATORS = 12;
+        const int ALLOCS = 2000;
+        ConcurrentPoolAllocator a[ALLOCATORS];
+
+        std::vector<char*> ptrs[ALLOCATORS];
+        for( int i=0; i<ALLOCS; i++ )
+        {
+            for( int k=0; k<ALLOCATORS; k++ )
+                ptrs[k].push_back( (char*) a[k].GetMore(16) );
+        }
+
+        bool bOK = true;
+        for( int k=0; k<ALLOCATORS; k++ )
+            bOK = bOK && CountChunks( ptrs[k] ) == 1;
+        Check( bOK, "interleaved allocators each stay in one chunk" );
+
+        // recycled and freed allocators get new identities.  Their stale entries must not crowd out the live ones
+        for( int r=0; r<100; r++ )
+        {
+            a[0].Recycle();
+            a[0].GetMore(16);
+            a[1].FreeAll();
+            a[1].GetMore(16);
+        }
+
+        std::vector<char*> p2, p3;
+        for( int i=0; i<ALLOCS; i++ )
+        {
+            p2.push_back( (char*) a[2].GetMore(16) );
+            p3.push_back( (char*) a[3].GetMore(16) );
+        }
+        Check( CountChunks( p2 ) == 1 && CountChunks( p3 ) == 1, "allocators survive recycling of others" );
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void TestRecycle()
+    {
+        ConcurrentPoolAllocator a;
+        std::vector<char*> first;
+        for( int i=0; i<10000; i++ )
+            first.push_back( (char*) a.GetMore(48) );
+
+        a.Recycle();
+
+        std::vector<char*> second;
+        for( int i=0; i<10000; i++ )
+            second.push_back( (char*) a.GetMore(48) );
+
+        // every chunk is reused, so the second pass may not need memory the first pass didn't have
+        std::sort( first.begin(), first.end() );
+        size_t nReused = 0;
+        for( size_t i=0; i<second.size(); i++ )
+        {
+            std::vector<char*>::iterator it = std::upper_bound( first.begin(), first.end(), second[i] );
+            if( it != first.begin() && second[i] - *(it-1) < 64*1024 )
+                nReused++;
+        }
+        Check( nReused == second.size(), "Recycle reuses chunks" );
+
+        void* pBig = a.GetMore( 1024*1024 );
+        memset( pBig, 0xab, 1024*1024 );
+        void* pSmall = a.GetMore( 16 );
+        Check( pBig && pSmall && (((uintptr_t)pBig | (uintptr_t)pSmall) & 15) == 0, "large allocs, alignment" );
+
+        a.FreeAll();
+        Check( a.GetMore( 16 ) != 0, "allocation after FreeAll" );
+    }
+
+    //=====================================================================================================================
+    /// Threads allocate from two shared allocators, and fill their allocations with a pattern.
+    ///  Any overlap between threads shows up as a corrupted pattern
+    //=====================================================================================================================
+    class AllocThread : public Thread
+    {
+    public:
+
+        ConcurrentPoolAllocator* m_pAllocators[2];
+        unsigned char m_nTag;
+        int m_nAllocs;
+        bool m_bOK;
+        std::vector<unsigned char*> m_Ptrs;
+
+    protected:
+
+        virtual void OnExecuteThread()
+        {
+            m_bOK = true;
+            m_Ptrs.reserve( m_nAllocs );
+            for( int i=0; i<m_nAllocs; i++ )
+            {
+                size_t nSize = 16 + (i % 7)*8;
+                unsigned char* p = (unsigned char*) m_pAllocators[i&1]->GetMore( nSize );
+                memset( p, m_nTag, nSize );
+                m_Ptrs.push_back(p);
+            }
+            for( int i=0; i<m_nAllocs; i++ )
+            {
+                size_t nSize = 16 + (i % 7)*8;
+                for( size_t j=0; j<nSize; j++ )
+                    m_bOK = m_bOK && m_Ptrs[i][j] == m_nTag;
+            }
+        }
+    };
+
+    void TestThreads()
+    {
+        const int THREADS = 8;
+        ConcurrentPoolAllocator a, b;
+        for( int nRound=0; nRound<3; nRound++ )
+        {
+            AllocThread threads[THREADS];
+            for( int i=0; i<THREADS; i++ )
+            {
+                threads[i].m_pAllocators[0] = &a;
+                threads[i].m_pAllocators[1] = &b;
+                threads[i].m_nTag = (unsigned char)(i+1);
+                threads[i].m_nAllocs = 100000;
+                threads[i].Start();
+            }
+
+            bool bOK = true;
+            for( int i=0; i<THREADS; i++ )
+            {
+                threads[i].WaitForCompletion();
+                bOK = bOK && threads[i].m_bOK;
+            }
+            Check( bOK, "concurrent allocations don't overlap" );
+
+            if( nRound == 0 )
+                a.Recycle();
+            else
+                a.FreeAll();
+            b.Recycle();
+        }
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    class BenchThread : public Thread
+    {
+    public:
+
+        ConcurrentPoolAllocator* m_pAllocator;
+        int m_nAllocs;
+
+    protected:
+
+        virtual void OnExecuteThread()
+        {
+            for( int i=0; i<m_nAllocs; i++ )
+            {
+                void* p = m_pAllocator ? m_pAllocator->GetMore(32) : malloc(32);
+                *(volatile char*)p = 0;
+                if( !m_pAllocator )
+                    free(p);
+            }
+        }
+    };
+
+    void Benchmark()
+    {
+        const int ALLOCS = 2000000;
+        unsigned int nMaxThreads = std::max( 1u, std::min( 8u, Thread::GetHardwareThreadCount() ) );
+        for( unsigned int nThreads=1; nThreads<=nMaxThreads; nThreads *= 2 )
+        {
+            for( int nMode=0; nMode<2; nMode++ )
+            {
+                ConcurrentPoolAllocator alloc;
+                std::vector<BenchThread> threads( nThreads );
+
+                Timer timer;
+                for( unsigned int i=0; i<nThreads; i++ )
+                {
+                    threads[i].m_pAllocator = nMode ? &alloc : 0;
+                    threads[i].m_nAllocs = ALLOCS;
+                    threads[i].Start();
+                }
+                for( unsigned int i=0; i<nThreads; i++ )
+                    threads[i].WaitForCompletion();
+
+                unsigned long nMicros = std::max( 1ul, timer.TickMicroSeconds() );
+                printf( "%u threads, %-24s %8.1f M allocs/s\n", nThreads, nMode ? "ConcurrentPoolAllocator:" : "malloc/free:",
+                        (double)ALLOCS*nThreads / nMicros );
+            }
+        }
+    }
+}
+
+int main()
+{
+    TestManyAllocators();
+    TestRecycle();
+    TestThreads();
+    Benchmark();
+
+    printf( "%d failures\n", g_nFailures );
+    return g_nFailures ? 1 : 0;
+}
@@ -0,0 +1,295 @@
+//=====================================================================================================================
+//
+//   FastMathTest.cpp
+//
+//   Accuracy and speed of FastMath.h, measured against double-precision libm.  Checks the error bounds
+//    documented in FastMath.h, and times each function against its float libm counterpart.
+//    Build as a console program, together with the Simpleton library sources.  Returns non-zero on failure
+//
+//   The lazy man's utility library
+//   Joshua Barczak
+//   Copyright 2016 Joshua Barczak
+//
+//   LICENSE:  See Doc\License.txt for terms and conditions
+//
+//=====================================================================================================================
+
+#include "FastMath.h"
+#include "PPMImage.h"
+#include "Rand.h"
+#include "Timer.h"
+
+#include <stdio.h>
+#include <math.h>
+#include <float.h>
+#include <vector>
+#include <algorithm>
+
+using namespace Simpleton;
+
+namespace
+{
+    int g_nFailures = 0;
+
+    void Check( bool b, const char* pWhat )
+    {
+        printf( "%s: %s\n", b ? "PASS" : "FAIL", pWhat );
+        if( !b )
+            g_nFailures++;
+    }
+
+    const size_t SAMPLES = 1 << 20;   ///< Multiple of 8
+    const int    REPEATS = 20;        ///< Passes over the samples when timing
+
+    /// Accumulates the worst error, and where it happened
+    struct ErrorStats
+    {
+        ErrorStats() : fMax(0), fWorstX(0) {}
+        void Add( double fErr, float x ) { if( !(fErr <= fMax) ) { fMax = fErr; fWorstX = x; } }
+        double fMax;
+        float fWorstX;
+    };
+
+    void Report( const char* pName, const ErrorStats& err, double fBound )
+    {
+        char buffer[128];
+        sprintf( buffer, "%-10s max error %.3g (bound %.3g) at x=%g", pName, err.fMax, fBound, err.fWorstX );
+        Check( err.fMax <= fBound, buffer );
+    }
+
+    /// Times 'fast' over the samples 8 at a time, and 'slow' one at a time.  Results are summed so that
+    ///  neither loop can be optimized away
+    template< class Fast_T, class Slow_T >
+    void Time( const char* pName, const std::vector<float>& in, Fast_T fast, Slow_T slow )
+    {
+        volatile float fSink = 0;
+        Timer timer;
+        float8 sum(0.0f);
+        for( int r=0; r<REPEATS; r++ )
+        {
+            for( size_t i=0; i<in.size(); i += 8 )
+                sum = sum + fast( float8::Load( &in[i] ) );
+        }
+        unsigned long nFast = std::max( 1ul, timer.TickMicroSeconds() );
+        float sums[8];
+        sum.Store( sums );
+        fSink = sums[0];
+
+        timer.Reset();
+        float fSum = 0.0f;
+        for( int r=0; r<REPEATS; r++ )
+        {
+            for( size_t i=0; i<in.size(); i++ )
+                fSum += slow( in[i] );
+        }
+        unsigned long nSlow = std::max( 1ul, timer.TickMicroSeconds() );
+        fSink = fSum;
+
+        double fCount = (double) in.size() * REPEATS;
+        printf( "  %-10s %7.2f ns/value fast, %7.2f ns/value libm, %5.1fx\n", pName,
+                1000.0*nFast / fCount, 1000.0*nSlow / fCount, (double) nSlow / nFast );
+        (void) fSink;
+    }
+
+    /// Evaluates 'fast' over the samples, 8 at a time
+    template< class Fast_T >
+    void Evaluate( std::vector<float>& out, const std::vector<float>& in, Fast_T fast )
+    {
+        out.resize( in.size() );
+        for( size_t i=0; i<in.size(); i += 8 )
+            fast( float8::Load( &in[i] ) ).Store( &out[i] );
+    }
+
+    /// Values spread evenly in log scale, over [2^nMinExp, 2^nMaxExp)
+    void LogUniform( std::vector<float>& v, PCG32& rng, float fMinExp, float fMaxExp )
+    {
+        v.resize( SAMPLES );
+        for( size_t i=0; i<v.size(); i++ )
+            v[i] = (float) ldexp( 1.0 + rng.NextFloat(), (int) floorf( rng.NextFloat( fMinExp, fMaxExp ) ) );
+    }
+
+    void Uniform( std::vector<float>& v, PCG32& rng, float a, float b )
+    {
+        v.resize( SAMPLES );
+        for( size_t i=0; i<v.size(); i++ )
+            v[i] = rng.NextFloat( a, b );
+    }
+
+    float8 Rsqrt8( const float8& x ) { return FastRsqrt(x); }
+    float8 Exp28( const float8& x )  { return FastExp2(x); }
+    float8 Log28( const float8& x )  { return FastLog2(x); }
+    float8 Pow8( const float8& x )   { return FastPow( x, float8(2.2f) ); }
+    float8 Sin8( const float8& x )   { float8 s, c; FastSinCos(x,s,c); return s; }
+    float8 Cos8( const float8& x )   { float8 s, c; FastSinCos(x,s,c); return c; }
+    float8 SinCos8( const float8& x ){ float8 s, c; FastSinCos(x,s,c); return s+c; }
+    float8 Acos8( const float8& x )  { return FastAcos(x); }
+
+    float LibRsqrt( float x ) { return 1.0f / ::sqrtf(x); }
+    float LibExp2( float x )  { return exp2f(x); }
+    float LibLog2( float x )  { return log2f(x); }
+    float LibPow( float x )   { return powf( x, 2.2f ); }
+    float LibSinCos( float x ){ return sinf(x) + cosf(x); }
+    float LibAcos( float x )  { return acosf(x); }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void TestAccuracy()
+    {
+        PCG32 rng;
+        std::vector<float> in, out;
+        bool bScalarMatches = true;
+
+        {
+            LogUniform( in, rng, -126.0f, 127.0f );
+            Evaluate( out, in, Rsqrt8 );
+            ErrorStats err;
+            for( size_t i=0; i<in.size(); i++ )
+            {
+                double ref = 1.0 / sqrt( (double) in[i] );
+                err.Add( fabs( out[i] - ref ) / ref, in[i] );
+                bScalarMatches = bScalarMatches && ( i % 97 || FastRsqrt( in[i] ) == out[i] );
+            }
+            Report( "FastRsqrt", err, 3.0e-7 );
+        }
+        {
+            Uniform( in, rng, -126.0f, 128.0f );
+            Evaluate( out, in, Exp28 );
+            ErrorStats err;
+            for( size_t i=0; i<in.size(); i++ )
+            {
+                double ref = exp2( (double) in[i] );
+                err.Add( fabs( out[i] - ref ) / ref, in[i] );
+                bScalarMatches = bScalarMatches && ( i % 97 || FastExp2( in[i] ) == out[i] );
+            }
+            Report( "FastExp2", err, 1.5e-7 );
+        }
+        {
+            LogUniform( in, rng, -126.0f, 128.0f );
+            for( size_t i=0; i<SAMPLES/4; i++ )
+                in[i] = rng.NextFloat( 0.5f, 2.0f );    // near 1, where the error is absolute
+            Evaluate( out, in, Log28 );
+            ErrorStats err;
+            for( size_t i=0; i<in.size(); i++ )
+            {
+                double ref = log2( (double) in[i] );
+                double fErr = fabs( out[i] - ref );
+                err.Add( (fabs(ref) < 1.0) ? fErr : fErr / fabs(ref), in[i] );
+                bScalarMatches = bScalarMatches && ( i % 97 || FastLog2( in[i] ) == out[i] );
+            }
+            Report( "FastLog2", err, 1.5e-7 );
+        }
+        {
+            // exponents from -4 to 4, with bases chosen so that x^y stays well inside float range
+            std::vector<float> y( SAMPLES );
+            in.resize( SAMPLES );
+            out.resize( SAMPLES );
+            ErrorStats err;
+            for( size_t i=0; i<in.size(); i++ )
+            {
+                y[i]  = rng.NextFloat( -4.0f, 4.0f );
+                in[i] = (float) ldexp( 1.0 + rng.NextFloat(), (int) floorf( rng.NextFloat( -28.0f, 28.0f ) ) );
+            }
+            for( size_t i=0; i<in.size(); i += 8 )
+                FastPow( float8::Load( &in[i] ), float8::Load( &y[i] ) ).Store( &out[i] );
+            for( size_t i=0; i<in.size(); i++ )
+            {
+                double ref = pow( (double) in[i], (double) y[i] );
+                double fScale = 1.0 + fabs( y[i] * log2( (double) in[i] ) );
+                err.Add( fabs( out[i] - ref ) / ref / fScale, in[i] );
+                bScalarMatches = bScalarMatches && ( i % 97 || FastPow( in[i], y[i] ) == out[i] );
+            }
+            Report( "FastPow", err, 1.5e-7 );
+
+            Check( FastPow( 0.0f, 0.0f ) == 1.0f && FastPow( 0.0f, 2.2f ) == 0.0f && FastPow( 5.0f, 0.0f ) == 1.0f,
+                   "FastPow(0,0)=1, FastPow(0,y)=0, FastPow(x,0)=1" );
+        }
+        {
+            Uniform( in, rng, -8192.0f, 8192.0f );
+            for( size_t i=0; i<SAMPLES/4; i++ )
+                in[i] = rng.NextFloat( -7.0f, 7.0f );
+            std::vector<float> sin, cos;
+            Evaluate( sin, in, Sin8 );
+            Evaluate( cos, in, Cos8 );
+            ErrorStats errSin, errCos;
+            for( size_t i=0; i<in.size(); i++ )
+            {
+                errSin.Add( fabs( sin[i] - ::sin( (double) in[i] ) ), in[i] );
+                errCos.Add( fabs( cos[i] - ::cos( (double) in[i] ) ), in[i] );
+                if( i % 97 == 0 )
+                {
+                    float s, c;
+                    FastSinCos( in[i], s, c );
+                    bScalarMatches = bScalarMatches && s == sin[i] && c == cos[i];
+                }
+            }
+            Report( "FastSin", errSin, 1.5e-7 );
+            Report( "FastCos", errCos, 1.5e-7 );
+        }
+        {
+            Uniform( in, rng, -1.0f, 1.0f );
+            in[0] = -1.0f;
+            in[1] = 1.0f;
+            in[2] = 0.0f;
+            Evaluate( out, in, Acos8 );
+            ErrorStats err;
+            for( size_t i=0; i<in.size(); i++ )
+            {
+                err.Add( fabs( out[i] - acos( (double) in[i] ) ), in[i] );
+                bScalarMatches = bScalarMatches && ( i % 97 || FastAcos( in[i] ) == out[i] );
+            }
+            Report( "FastAcos", err, 5.0e-7 );
+        }
+
+        // the scalar forms run the same code on one lane, so they must agree bit for bit
+        Check( bScalarMatches, "scalar forms match the vector forms" );
+    }
+
+    //=====================================================================================================================
+    /// Gamma correction with an exponent of zero turns everything white, black included
+    //=====================================================================================================================
+    void TestImagePow()
+    {
+        PPMImage img( 2, 1 );
+        img.SetPixel( 0, 0, (unsigned char) 0, 0, 0 );
+        img.SetPixel( 1, 0, (unsigned char) 128, 64, 255 );
+        img.Pow( 0.0f );
+
+        unsigned char black[3], other[3];
+        img.GetPixelBytes( 0, 0, black );
+        img.GetPixelBytes( 1, 0, other );
+        Check( black[0] == 255 && black[1] == 255 && black[2] == 255 && other[0] == 255 && other[1] == 255 && other[2] == 255,
+               "PPMImage::Pow(0) maps every pixel to 255" );
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void Benchmark()
+    {
+        PCG32 rng;
+        std::vector<float> in;
+
+        LogUniform( in, rng, -20.0f, 20.0f );
+        Time( "Rsqrt", in, Rsqrt8, LibRsqrt );
+        Time( "Log2", in, Log28, LibLog2 );
+        Time( "Pow", in, Pow8, LibPow );
+
+        Uniform( in, rng, -60.0f, 60.0f );
+        Time( "Exp2", in, Exp28, LibExp2 );
+
+        Uniform( in, rng, -100.0f, 100.0f );
+        Time( "SinCos", in, SinCos8, LibSinCos );
+
+        Uniform( in, rng, -1.0f, 1.0f );
+        Time( "Acos", in, Acos8, LibAcos );
+    }
+}
+
+int main()
+{
+    TestAccuracy();
+    TestImagePow();
+    Benchmark();
+
+    printf( "%d failures\n", g_nFailures );
+    return g_nFailures ? 1 : 0;
+}
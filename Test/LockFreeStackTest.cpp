@@ -0,0 +1,201 @@
+//=====================================================================================================================
+//
+//   LockFreeStackTest.cpp
+//
+//   Multi-producer/multi-consumer stress test for LockFreeStack.
+//    Build as a console program, together with the Simpleton library sources.  Returns non-zero on failure
+//
+//   The lazy man's utility library
+//   Joshua Barczak
+//   Copyright 2016 Joshua Barczak
+//
+//   LICENSE:  See Doc\License.txt for terms and conditions
+//
+//=====================================================================================================================
+
+#include "LockFreeStack.h"
+#include "Thread.h"
+#include "Timer.h"
+
+#include <stdio.h>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+
+using namespace Simpleton;
+
+namespace
+{
+    int g_nFailures = 0;
+
+    void Check( bool b, const char* pWhat )
+    {
+        printf( "%s: %s\n", b ? "PASS" : "FAIL", pWhat );
+        if( !b )
+            g_nFailures++;
+    }
+
+    /// A node which counts how many threads think they own it.  An ABA failure hands the same node to two threads
+    struct TestNode : public LockFreeStack::Node
+    {
+        std::atomic<int> nOwners;
+        int nIndex;
+    };
+
+    //=====================================================================================================================
+    /// Each thread repeatedly pops a few nodes, checks that it is their only owner, and pushes them back.
+    ///  Some are pushed back one at a time, others as a chain.  Holding several nodes at once, and pushing them
+    ///  back in a different order, is what recreates an old head pointer under a racing pop
+    //=====================================================================================================================
+    class StressThread : public Thread
+    {
+    public:
+
+        LockFreeStack* m_pStack;
+        int m_nIterations;
+        bool m_bOK;
+        unsigned int m_nEmpty;
+
+    protected:
+
+        virtual void OnExecuteThread()
+        {
+            m_bOK = true;
+            m_nEmpty = 0;
+            for( int i=0; i<m_nIterations; i++ )
+            {
+                TestNode* pHeld[4];
+                int nHeld = 0;
+                int nWant = 1 + (i & 3);
+                while( nHeld < nWant )
+                {
+                    TestNode* pNode = static_cast<TestNode*>( m_pStack->pop_front() );
+                    if( !pNode )
+                    {
+                        m_nEmpty++;
+                        break;
+                    }
+                    if( pNode->nOwners.fetch_add(1) != 0 )
+                        m_bOK = false;
+                    pHeld[nHeld++] = pNode;
+                }
+
+                for( int j=0; j<nHeld; j++ )
+                    pHeld[j]->nOwners.fetch_sub(1);
+
+                if( nHeld > 1 && (i & 4) )
+                {
+                    for( int j=0; j<nHeld-1; j++ )
+                        LockFreeStack::Link( pHeld[j], pHeld[j+1] );
+                    m_pStack->push_chain( pHeld[0], pHeld[nHeld-1] );
+                }
+                else
+                {
+                    for( int j=0; j<nHeld; j++ )
+                        m_pStack->push_front( pHeld[j] );
+                }
+            }
+        }
+    };
+
+    /// Pops everything, and checks that each node is there exactly once
+    bool CheckContents( LockFreeStack& stack, std::vector<TestNode>& nodes )
+    {
+        std::vector<int> seen( nodes.size(), 0 );
+        for( LockFreeStack::Node* p = stack.pop_all(); p; p = LockFreeStack::Next(p) )
+        {
+            TestNode* pNode = static_cast<TestNode*>(p);
+            if( pNode->nOwners.load() != 0 || seen[pNode->nIndex]++ )
+                return false;
+        }
+        return std::count( seen.begin(), seen.end(), 1 ) == (int) nodes.size() && stack.empty();
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void TestSerial()
+    {
+        LockFreeStack stack;
+        std::vector<TestNode> nodes( 8 );
+        for( size_t i=0; i<nodes.size(); i++ )
+        {
+            nodes[i].nOwners = 0;
+            nodes[i].nIndex = (int) i;
+        }
+
+        Check( stack.empty() && stack.pop_front() == 0, "new stack is empty" );
+
+        for( size_t i=0; i<4; i++ )
+            stack.push_front( &nodes[i] );
+        for( size_t i=4; i<7; i++ )
+            LockFreeStack::Link( &nodes[i], &nodes[i+1] );
+        stack.push_chain( &nodes[4], &nodes[7] );
+
+        bool bOrder = true;
+        int nExpected[] = { 4, 5, 6, 7, 3, 2, 1, 0 };
+        for( int i=0; i<8; i++ )
+        {
+            TestNode* pNode = static_cast<TestNode*>( stack.pop_front() );
+            bOrder = bOrder && pNode && pNode->nIndex == nExpected[i];
+        }
+        Check( bOrder && stack.empty(), "push_front, push_chain and pop_front order" );
+
+        for( size_t i=0; i<nodes.size(); i++ )
+            stack.push_front_serial( &nodes[i] );
+        LockFreeStack copy;
+        copy.CopyFrom( stack );
+        Check( stack.pop_front_serial() == &nodes[7] && copy.pop_front() == &nodes[7], "serial operations, CopyFrom" );
+
+        stack.clear();
+        Check( stack.empty(), "clear" );
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void TestStress()
+    {
+        const int THREADS = 8;
+        const int NODES   = 6;  ///< Few enough that the stack often runs dry, and heads are reused constantly
+
+        LockFreeStack stack;
+        std::vector<TestNode> nodes( NODES );
+        for( int i=0; i<NODES; i++ )
+        {
+            nodes[i].nOwners = 0;
+            nodes[i].nIndex = i;
+            stack.push_front( &nodes[i] );
+        }
+
+        Timer timer;
+        StressThread threads[THREADS];
+        for( int i=0; i<THREADS; i++ )
+        {
+            threads[i].m_pStack = &stack;
+            threads[i].m_nIterations = 1000000;
+            threads[i].Start();
+        }
+
+        bool bOK = true;
+        unsigned int nEmpty = 0;
+        for( int i=0; i<THREADS; i++ )
+        {
+            threads[i].WaitForCompletion();
+            bOK = bOK && threads[i].m_bOK;
+            nEmpty += threads[i].m_nEmpty;
+        }
+        unsigned int nMS = timer.Tick();
+
+        printf( "  %d threads, %d iterations each, %u empty pops, %u ms\n", THREADS, 1000000, nEmpty, nMS );
+        Check( bOK, "no node is popped by two threads at once" );
+        Check( CheckContents( stack, nodes ), "every node is on the stack exactly once" );
+    }
+}
+
+int main()
+{
+    TestSerial();
+    TestStress();
+
+    printf( "%d failures\n", g_nFailures );
+    return g_nFailures ? 1 : 0;
+}
@@ -0,0 +1,279 @@
+//=====================================================================================================================
+//
+//   MeshSimplifyTest.cpp
+//
+//   Standalone test for SimplifyMesh.  Spheres with more than 64K triangles are used, so that the cluster-parallel
+//    version splits them into several clusters.
+//    Build as a console program, together with the Simpleton library sources.  Returns non-zero on failure
+//
+//   The lazy man's utility library
+//   Joshua Barczak
+//   Copyright 2016 Joshua Barczak
+//
+//   LICENSE:  See Doc\License.txt for terms and conditions
+//
+//=====================================================================================================================
+
+#include "MeshSimplify.h"
+#include "Mesh.h"
+#include "ThreadPool.h"
+#include "Timer.h"
+
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+
+using namespace Simpleton;
+
+namespace
+{
+    int g_nFailures = 0;
+
+    void Check( bool b, const char* pWhat )
+    {
+        printf( "%s: %s\n", b ? "PASS" : "FAIL", pWhat );
+        if( !b )
+            g_nFailures++;
+    }
+
+    struct SphereVertex
+    {
+        float P[3];
+        float UV[2];
+    };
+
+    const uint32 SLICES = 256;
+    const uint32 RINGS  = 130;
+
+    /// Unit sphere with a UV seam along one meridian.  Each slice has its own vertex at each pole
+    void BuildSphere( std::vector<SphereVertex>& vb, std::vector<uint32>& ib )
+    {
+        const float PI = 3.14159265f;
+        vb.clear();
+        ib.clear();
+
+        // rows 0 and RINGS+1 are the poles
+        for( uint32 r=0; r<=RINGS+1; r++ )
+        {
+            for( uint32 s=0; s<=SLICES; s++ )
+            {
+                bool bPole = (r == 0 || r == RINGS+1);
+                float u = bPole ? (s + 0.5f) / SLICES : (float) s / SLICES;
+                float v = (float) r / (RINGS+1);
+                float fTheta = 2.0f*PI*u;
+                float fPhi = PI*v;
+
+                SphereVertex vert;
+                vert.P[0] = sinf(fPhi)*cosf(fTheta);
+                vert.P[1] = cosf(fPhi);
+                vert.P[2] = sinf(fPhi)*sinf(fTheta);
+                vert.UV[0] = u;
+                vert.UV[1] = v;
+                if( bPole )
+                    vert.P[0] = vert.P[2] = 0.0f;
+                vb.push_back( vert );
+            }
+        }
+
+        for( uint32 r=0; r<=RINGS; r++ )
+        {
+            for( uint32 s=0; s<SLICES; s++ )
+            {
+                uint32 i00 = r*(SLICES+1) + s;
+                uint32 i01 = i00 + 1;
+                uint32 i10 = i00 + SLICES+1;
+                uint32 i11 = i10 + 1;
+                if( r != 0 )
+                {
+                    ib.push_back( i00 ); ib.push_back( i01 ); ib.push_back( i11 );
+                }
+                if( r != RINGS )
+                {
+                    ib.push_back( i00 ); ib.push_back( i11 ); ib.push_back( i10 );
+                }
+            }
+        }
+    }
+
+    /// Largest distance of any triangle's centroid from the unit sphere, relative to its diameter, as the simplifier
+    ///  measures error.  Vertices never move, so this is how far the flattened triangles have pulled away
+    float MeasureError( const std::vector<SphereVertex>& vb, const uint32* pIndices, uint32 nTriangles )
+    {
+        float fError = 0.0f;
+        for( uint32 t=0; t<nTriangles; t++ )
+        {
+            float C[3] = { 0, 0, 0 };
+            for( int k=0; k<3; k++ )
+            {
+                for( int i=0; i<3; i++ )
+                    C[i] += vb[ pIndices[3*t+k] ].P[i] / 3.0f;
+            }
+            fError = std::max( fError, (1.0f - sqrtf( C[0]*C[0] + C[1]*C[1] + C[2]*C[2] )) / 2.0f );
+        }
+        return fError;
+    }
+
+    /// True if no triangle straddles the UV seam
+    bool IsSeamIntact( const std::vector<SphereVertex>& vb, const uint32* pIndices, uint32 nTriangles )
+    {
+        for( uint32 t=0; t<nTriangles; t++ )
+        {
+            float u0 = vb[ pIndices[3*t] ].UV[0];
+            float u1 = vb[ pIndices[3*t+1] ].UV[0];
+            float u2 = vb[ pIndices[3*t+2] ].UV[0];
+            if( std::max( u0, std::max( u1, u2 ) ) - std::min( u0, std::min( u1, u2 ) ) > 0.5f )
+                return false;
+        }
+        return true;
+    }
+
+    /// Number of distinct vertices on the u=1 side of the seam which are still in use
+    uint32 CountSeamVertices( const std::vector<SphereVertex>& vb, const uint32* pIndices, uint32 nTriangles )
+    {
+        std::vector<uint32> seam;
+        for( uint32 i=0; i<3*nTriangles; i++ )
+        {
+            if( vb[ pIndices[i] ].UV[0] == 1.0f )
+                seam.push_back( pIndices[i] );
+        }
+        std::sort( seam.begin(), seam.end() );
+        return (uint32)( std::unique( seam.begin(), seam.end() ) - seam.begin() );
+    }
+
+    //=====================================================================================================================
+    /// Flat shading leaves a copy of every vertex for each of its faces.  These are all identical, and must not be
+    ///  mistaken for seams
+    //=====================================================================================================================
+    void TestUnwelded( ThreadPool& pool )
+    {
+        std::vector<SphereVertex> vb;
+        std::vector<uint32> ib;
+        BuildSphere( vb, ib );
+        uint32 nTriangles = (uint32)( ib.size() / 3 );
+
+        std::vector<SphereVertex> soup( ib.size() );
+        std::vector<uint32> soupIndices( ib.size() );
+        for( size_t i=0; i<ib.size(); i++ )
+        {
+            soup[i] = vb[ ib[i] ];
+            soup[i].UV[0] = soup[i].UV[1] = 0.0f;
+            soupIndices[i] = (uint32) i;
+        }
+
+        uint32 nTarget = nTriangles / 10;
+        std::vector<uint32> out( ib.size() );
+        for( int nPool=0; nPool<2; nPool++ )
+        {
+            float fError = 0.0f;
+            uint32 nOut;
+            if( nPool )
+                nOut = SimplifyMesh( pool, out.data(), soupIndices.data(), nTriangles, soup[0].P, sizeof(SphereVertex),
+                                     (uint32) soup.size(), nTarget, 1.0f, &fError );
+            else
+                nOut = SimplifyMesh( out.data(), soupIndices.data(), nTriangles, soup[0].P, sizeof(SphereVertex),
+                                     (uint32) soup.size(), nTarget, 1.0f, &fError );
+
+            printf( "  unwelded %s: %u -> %u triangles\n", nPool ? "parallel" : "serial", nTriangles, nOut );
+            Check( nOut <= nTarget + nTarget/10, nPool ? "parallel simplifies unwelded mesh" : "serial simplifies unwelded mesh" );
+        }
+    }
+
+    //=====================================================================================================================
+    /// UV seams must collapse, without any triangle crossing from one side to the other
+    //=====================================================================================================================
+    void TestSeams( ThreadPool& pool )
+    {
+        std::vector<SphereVertex> vb;
+        std::vector<uint32> ib;
+        BuildSphere( vb, ib );
+        uint32 nTriangles = (uint32)( ib.size() / 3 );
+
+        WeldFormat format( sizeof(SphereVertex), 0 );
+        format.nUVOffset = sizeof(float)*3;
+
+        uint32 nSeam = CountSeamVertices( vb, ib.data(), nTriangles );
+        uint32 nTarget = nTriangles / 10;
+        std::vector<uint32> out( ib.size() );
+        for( int nPool=0; nPool<2; nPool++ )
+        {
+            uint32 nOut;
+            if( nPool )
+                nOut = SimplifyMesh( pool, out.data(), ib.data(), nTriangles, vb.data(), (uint32) vb.size(), format, nTarget, 1.0f );
+            else
+                nOut = SimplifyMesh( out.data(), ib.data(), nTriangles, vb.data(), (uint32) vb.size(), format, nTarget, 1.0f );
+
+            uint32 nSeamOut = CountSeamVertices( vb, out.data(), nOut );
+            printf( "  seams %s: %u -> %u triangles, %u -> %u seam vertices\n", nPool ? "parallel" : "serial",
+                    nTriangles, nOut, nSeam, nSeamOut );
+            Check( nOut <= nTarget + nTarget/10, "mesh with seams reaches its target" );
+            Check( IsSeamIntact( vb, out.data(), nOut ), "seam is preserved" );
+            Check( nSeamOut > 0 && nSeamOut < nSeam/2, "seam is simplified" );
+        }
+    }
+
+    //=====================================================================================================================
+    /// The error bound must hold for the whole mesh, including what the clusters did before the final pass
+    //=====================================================================================================================
+    void TestErrorBound( ThreadPool& pool )
+    {
+        std::vector<SphereVertex> vb;
+        std::vector<uint32> ib;
+        BuildSphere( vb, ib );
+        uint32 nTriangles = (uint32)( ib.size() / 3 );
+
+        WeldFormat format( sizeof(SphereVertex), 0 );
+        format.nUVOffset = sizeof(float)*3;
+
+        const float fTargetError = 0.002f;
+        std::vector<uint32> out( ib.size() );
+        float fSerialError = 0.0f;
+        float fSerialMeasured = 0.0f;
+        for( int nPool=0; nPool<2; nPool++ )
+        {
+            Timer timer;
+            float fError = 0.0f;
+            uint32 nOut;
+            if( nPool )
+                nOut = SimplifyMesh( pool, out.data(), ib.data(), nTriangles, vb.data(), (uint32) vb.size(), format,
+                                     0, fTargetError, &fError );
+            else
+                nOut = SimplifyMesh( out.data(), ib.data(), nTriangles, vb.data(), (uint32) vb.size(), format,
+                                     0, fTargetError, &fError );
+            unsigned int nMS = timer.Tick();
+
+            float fMeasured = MeasureError( vb, out.data(), nOut );
+            printf( "  error bound %s: %u -> %u triangles, reported %f, measured %f, %u ms\n", nPool ? "parallel" : "serial",
+                    nTriangles, nOut, fError, fMeasured, nMS );
+
+            // the sag of a triangle isn't the quantity the quadrics measure, so the measured error is compared to
+            //  the serial version's, rather than to the target
+            Check( fError <= fTargetError, "reported error is within the target" );
+            if( nPool )
+            {
+                Check( fMeasured <= 1.25f*fSerialMeasured, "parallel error is as small as serial" );
+                Check( fError >= 0.75f*fSerialError, "parallel reported error is not an underestimate" );
+            }
+            else
+            {
+                fSerialError = fError;
+                fSerialMeasured = fMeasured;
+            }
+        }
+    }
+}
+
+int main()
+{
+    ThreadPool pool;
+    pool.Start( 4 );
+
+    TestUnwelded( pool );
+    TestSeams( pool );
+    TestErrorBound( pool );
+
+    pool.Shutdown();
+
+    printf( "%d failures\n", g_nFailures );
+    return g_nFailures ? 1 : 0;
+}
@@ -0,0 +1,434 @@
+//=====================================================================================================================
+//
+//   ThreadPoolTest.cpp
+//
+//   Standalone test and benchmarks for ThreadPool: contention, idle CPU use, and wakeup latency.
+//    The work-stealing pool is compared against the design it replaced, which is reproduced here:
+//    one spin-locked deque shared by every thread, polled by idle workers.
+//    Build as a console program, together with the Simpleton library sources.  Returns non-zero on failure
+//
+//   The lazy man's utility library
+//   Joshua Barczak
+//   Copyright 2016 Joshua Barczak
+//
+//   LICENSE:  See Doc\License.txt for terms and conditions
+//
+//=====================================================================================================================
+
+#include "ThreadPool.h"
+#include "SpinLock.h"
+#include "Thread.h"
+#include "Timer.h"
+
+#include <stdio.h>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+
+#ifdef WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#else
+    #include <sys/resource.h>
+#endif
+
+using namespace Simpleton;
+
+namespace
+{
+    int g_nFailures = 0;
+
+    void Check( bool b, const char* pWhat )
+    {
+        printf( "%s: %s\n", b ? "PASS" : "FAIL", pWhat );
+        if( !b )
+            g_nFailures++;
+    }
+
+    /// CPU time used by the whole process so far, summed over all of its threads, in microseconds
+    double GetProcessCPUMicroseconds()
+    {
+    #ifdef WIN32
+        FILETIME create, exit, kernel, user;
+        GetProcessTimes( GetCurrentProcess(), &create, &exit, &kernel, &user );
+        ULARGE_INTEGER k, u;
+        k.LowPart  = kernel.dwLowDateTime;
+        k.HighPart = kernel.dwHighDateTime;
+        u.LowPart  = user.dwLowDateTime;
+        u.HighPart = user.dwHighDateTime;
+        return (double)( k.QuadPart + u.QuadPart ) / 10.0;    // FILETIME counts 100ns ticks
+    #else
+        rusage r;
+        getrusage( RUSAGE_SELF, &r );
+        return 1e6*(double)( r.ru_utime.tv_sec + r.ru_stime.tv_sec ) + (double)( r.ru_utime.tv_usec + r.ru_stime.tv_usec );
+    #endif
+    }
+
+    //=====================================================================================================================
+    /// The old ThreadPool.  Every push and pop takes the same lock, and idle workers poll it forever
+    //=====================================================================================================================
+    class GlobalQueuePool
+    {
+    public:
+
+        GlobalQueuePool() : m_bShutdown(false) {}
+        ~GlobalQueuePool() { Shutdown(); }
+
+        void Start( size_t nWorkers )
+        {
+            m_bShutdown = false;
+            for( size_t i=0; i<nWorkers; i++ )
+            {
+                WorkerThread* pThread = new WorkerThread(this);
+                m_WorkerThreads.push_back(pThread);
+                pThread->Start();
+            }
+        }
+
+        void Shutdown()
+        {
+            WaitAll();
+            m_bShutdown = true;
+            for( size_t i=0; i<m_WorkerThreads.size(); i++ )
+            {
+                m_WorkerThreads[i]->WaitForCompletion();
+                delete m_WorkerThreads[i];
+            }
+            m_WorkerThreads.clear();
+        }
+
+        void PushWork( WorkItem* pItem )
+        {
+            m_Lock.Take();
+            m_WorkItems.push_back(pItem);
+            m_Lock.Release();
+        }
+
+        bool DoWork()
+        {
+            m_Lock.Take();
+            if( m_WorkItems.empty() )
+            {
+                m_Lock.Release();
+                return false;
+            }
+            WorkItem* pWork = m_WorkItems.front();
+            m_WorkItems.pop_front();
+            m_Lock.Release();
+
+            pWork->Do();
+            return true;
+        }
+
+        void WaitAll()
+        {
+            while( DoWork() )
+                ;
+        }
+
+    private:
+
+        class WorkerThread : public Thread
+        {
+        public:
+            WorkerThread( GlobalQueuePool* pPool ) : m_pPool(pPool) {}
+        protected:
+            virtual void OnExecuteThread()
+            {
+                while( !m_pPool->m_bShutdown )
+                {
+                    if( !m_pPool->DoWork() )
+                        _mm_pause();
+                }
+            }
+        private:
+            GlobalQueuePool* m_pPool;
+        };
+
+        std::vector<Thread*> m_WorkerThreads;
+        std::atomic<bool> m_bShutdown;
+        SpinLock m_Lock;
+        std::deque<WorkItem*> m_WorkItems;
+    };
+
+    //=====================================================================================================================
+    /// Work items form an implicit binary tree.  Item i pushes items 2i+1 and 2i+2 before doing its own work,
+    ///  so after the first few levels, all of the work is pushed from inside the pool
+    //=====================================================================================================================
+    template< class Pool_T >
+    class TreeItem : public WorkItem
+    {
+    public:
+
+        virtual void Do()
+        {
+            size_t nFirstChild = 2*m_nIndex + 1;
+            for( size_t i=nFirstChild; i<nFirstChild+2 && i<m_pItems->size(); i++ )
+                m_pPool->PushWork( &(*m_pItems)[i] );
+
+            // a little busy work, so that the scheduler isn't the only thing being measured
+            uint32 x = (uint32) m_nIndex;
+            for( uint32 i=0; i<m_nSpin; i++ )
+                x = x*1664525 + 1013904223;
+            m_nResult = x;
+
+            m_nRuns++;
+            m_pDone->fetch_add(1, std::memory_order_release );
+        }
+
+        Pool_T* m_pPool;
+        std::vector<TreeItem>* m_pItems;
+        std::atomic<size_t>* m_pDone;
+        size_t m_nIndex;
+        uint32 m_nSpin;
+        uint32 m_nResult;
+        int m_nRuns;
+    };
+
+    /// Runs a tree of 'nItems' items on 'pool', starting from the calling thread.  Returns microseconds taken.
+    ///  'bOnce' is set if every item ran exactly once
+    template< class Pool_T >
+    unsigned long RunTree( Pool_T& pool, size_t nItems, uint32 nSpin, bool& bOnce )
+    {
+        std::vector< TreeItem<Pool_T> > items( nItems );
+        std::atomic<size_t> nDone(0);
+        for( size_t i=0; i<nItems; i++ )
+        {
+            items[i].m_pPool = &pool;
+            items[i].m_pItems = &items;
+            items[i].m_pDone = &nDone;
+            items[i].m_nIndex = i;
+            items[i].m_nSpin = nSpin;
+            items[i].m_nRuns = 0;
+        }
+
+        Timer timer;
+        pool.PushWork( &items[0] );
+        while( nDone.load( std::memory_order_acquire ) < nItems )
+        {
+            if( !pool.DoWork() )
+                _mm_pause();
+        }
+        unsigned long nMicros = std::max( 1ul, timer.TickMicroSeconds() );
+
+        bOnce = true;
+        for( size_t i=0; i<nItems; i++ )
+            bOnce = bOnce && items[i].m_nRuns == 1;
+        return nMicros;
+    }
+
+    /// Same items, all pushed from outside the pool up front.  They go through the work-stealing pool's
+    ///  submission queue, which is still a single lock.  Returns microseconds taken
+    template< class Pool_T >
+    unsigned long RunFlat( Pool_T& pool, size_t nItems, uint32 nSpin, bool& bOnce )
+    {
+        std::vector< TreeItem<Pool_T> > items( nItems );
+        std::atomic<size_t> nDone(0);
+        for( size_t i=0; i<nItems; i++ )
+        {
+            items[i].m_pPool = &pool;
+            items[i].m_pItems = &items;
+            items[i].m_pDone = &nDone;
+            items[i].m_nIndex = nItems;     // no children
+            items[i].m_nSpin = nSpin;
+            items[i].m_nRuns = 0;
+        }
+
+        Timer timer;
+        for( size_t i=0; i<nItems; i++ )
+            pool.PushWork( &items[i] );
+        while( nDone.load( std::memory_order_acquire ) < nItems )
+        {
+            if( !pool.DoWork() )
+                _mm_pause();
+        }
+        unsigned long nMicros = std::max( 1ul, timer.TickMicroSeconds() );
+
+        bOnce = true;
+        for( size_t i=0; i<nItems; i++ )
+            bOnce = bOnce && items[i].m_nRuns == 1;
+        return nMicros;
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void TestCorrectness()
+    {
+        ThreadPool pool;
+        pool.Start( std::max( 2u, std::min( 8u, Thread::GetHardwareThreadCount() ) ) );
+
+        bool bOK = true;
+        for( int r=0; r<20; r++ )
+        {
+            bool bOnce;
+            RunTree( pool, 10000, 0, bOnce );
+            bOK = bOK && bOnce;
+            RunFlat( pool, 10000, 0, bOnce );
+            bOK = bOK && bOnce;
+        }
+        pool.Shutdown();
+        Check( bOK, "every item runs exactly once" );
+
+        // a restarted pool must still work, and Shutdown must drain whatever is left
+        pool.Start( 2 );
+        std::vector< TreeItem<ThreadPool> > items( 1000 );
+        std::atomic<size_t> nDone(0);
+        for( size_t i=0; i<items.size(); i++ )
+        {
+            items[i].m_pPool = &pool;
+            items[i].m_pItems = &items;
+            items[i].m_pDone = &nDone;
+            items[i].m_nIndex = i;
+            items[i].m_nSpin = 1000;
+            items[i].m_nRuns = 0;
+        }
+        pool.PushWork( &items[0] );
+        pool.Shutdown();
+        Check( nDone.load() == items.size(), "Shutdown drains the pool" );
+    }
+
+    //=====================================================================================================================
+    /// Time per item for both pools, at increasing worker counts.  The calling thread helps, as WaitAll would
+    //=====================================================================================================================
+    void Benchmark()
+    {
+        const size_t ITEMS = 1 << 18;
+        const uint32 SPINS[] = { 0, 200 };
+
+        unsigned int nMaxWorkers = std::max( 1u, std::min( 32u, Thread::GetHardwareThreadCount() ) ) - 1;
+        printf( "  %-8s %-6s %-6s %18s %18s\n", "workers", "push", "spin", "work stealing", "global queue" );
+        for( int nSpin=0; nSpin<2; nSpin++ )
+        {
+            for( unsigned int nWorkers=0; ; nWorkers = nWorkers ? 2*nWorkers+1 : 1 )
+            {
+                nWorkers = std::min( nWorkers, nMaxWorkers );
+                for( int bTree=1; bTree>=0; bTree-- )
+                {
+                    bool bOnce;
+                    ThreadPool pool;
+                    pool.Start( nWorkers );
+                    unsigned long nNew = bTree ? RunTree( pool, ITEMS, SPINS[nSpin], bOnce ) : RunFlat( pool, ITEMS, SPINS[nSpin], bOnce );
+                    pool.Shutdown();
+
+                    GlobalQueuePool old;
+                    old.Start( nWorkers );
+                    unsigned long nOld = bTree ? RunTree( old, ITEMS, SPINS[nSpin], bOnce ) : RunFlat( old, ITEMS, SPINS[nSpin], bOnce );
+                    old.Shutdown();
+
+                    printf( "  %-8u %-6s %-6u %12.1f ns/item %12.1f ns/item\n", nWorkers, bTree ? "inner" : "outer",
+                            SPINS[nSpin], 1000.0*nNew / ITEMS, 1000.0*nOld / ITEMS );
+                }
+                if( nWorkers == nMaxWorkers )
+                    break;
+            }
+        }
+    }
+
+    //=====================================================================================================================
+    /// Records when it ran, relative to a timer shared with whoever pushed it.  The time may well be zero, so completion
+    ///  is signalled separately
+    //=====================================================================================================================
+    class StampItem : public WorkItem
+    {
+    public:
+        virtual void Do()
+        {
+            m_nRanAt = m_pTimer->TickMicroSeconds();
+            m_bDone.store( true, std::memory_order_release );
+        }
+
+        const Timer* m_pTimer;
+        unsigned long m_nRanAt;
+        std::atomic<bool> m_bDone;
+    };
+
+    /// Push-to-execute latency, in microseconds, for an item pushed from outside the pool.
+    ///  If 'nIdleMS' is non-zero, the pool sits idle for that long first, so that its workers have gone to sleep
+    template< class Pool_T >
+    unsigned long MeasureWakeup( Pool_T& pool, unsigned int nIdleMS )
+    {
+        if( nIdleMS )
+            std::this_thread::sleep_for( std::chrono::milliseconds( nIdleMS ) );
+
+        Timer timer;
+        StampItem item;
+        item.m_pTimer = &timer;
+        item.m_nRanAt = 0;
+        item.m_bDone.store( false );
+
+        unsigned long nPushedAt = timer.TickMicroSeconds();
+        pool.PushWork( &item );
+        while( !item.m_bDone.load( std::memory_order_acquire ) )
+            std::this_thread::yield();
+        return item.m_nRanAt - nPushedAt;
+    }
+
+    /// Process CPU time, as a fraction of one core, while 'pool' sits idle for 'nMS' milliseconds
+    double MeasureIdleCPU( unsigned int nMS )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) );    // let workers settle
+        Timer timer;
+        double fStart = GetProcessCPUMicroseconds();
+        std::this_thread::sleep_for( std::chrono::milliseconds( nMS ) );
+        double fCPU = GetProcessCPUMicroseconds() - fStart;
+        return fCPU / std::max( 1ul, timer.TickMicroSeconds() );
+    }
+
+    template< class Pool_T >
+    void MeasureIdle( Pool_T& pool, const char* pName, double& fIdleCPU )
+    {
+        const int SAMPLES = 32;
+        fIdleCPU = MeasureIdleCPU( 250 );
+
+        // hot wakeups follow each other immediately, so workers may still be spinning.  Cold ones come after a rest
+        std::vector<unsigned long> hot, cold;
+        for( int i=0; i<SAMPLES; i++ )
+        {
+            hot.push_back( MeasureWakeup( pool, 0 ) );
+            cold.push_back( MeasureWakeup( pool, 5 ) );
+        }
+        std::sort( hot.begin(), hot.end() );
+        std::sort( cold.begin(), cold.end() );
+
+        printf( "  %-14s idle CPU %6.1f%% of a core.  Wakeup latency median/max: hot %4lu/%5lu us, cold %4lu/%5lu us\n",
+                pName, 100.0*fIdleCPU, hot[SAMPLES/2], hot.back(), cold[SAMPLES/2], cold.back() );
+    }
+
+    //=====================================================================================================================
+    /// An idle pool should cost nothing, and still pick up new work promptly
+    //=====================================================================================================================
+    void BenchmarkIdle()
+    {
+        unsigned int nWorkers = std::max( 1u, std::min( 8u, Thread::GetHardwareThreadCount() ) );
+        printf( "  %u workers\n", nWorkers );
+
+        double fNewIdle, fOldIdle;
+        {
+            ThreadPool pool;
+            pool.Start( nWorkers );
+            MeasureIdle( pool, "work stealing", fNewIdle );
+            pool.Shutdown();
+        }
+        {
+            GlobalQueuePool old;
+            old.Start( nWorkers );
+            MeasureIdle( old, "global queue", fOldIdle );
+            old.Shutdown();
+        }
+
+        Check( fNewIdle < 0.05, "idle workers sleep" );
+    }
+}
+
+int main()
+{
+    TestCorrectness();
+    Benchmark();
+    BenchmarkIdle();
+
+    printf( "%d failures\n", g_nFailures );
+    return g_nFailures ? 1 : 0;
+}
@@ -0,0 +1,369 @@
+//=====================================================================================================================
+//
+//   BoundedQueue.h
+//
+//   Definition of classes: Simpleton::MPMCQueue, Simpleton::SPSCQueue
+//
+//   The lazy man's utility library
+//   Joshua Barczak
+//   Copyright 2016 Joshua Barczak
+//
+//   LICENSE:  See Doc\License.txt for terms and conditions
+//
+//=====================================================================================================================
+
+#ifndef _BOUNDED_QUEUE_H_
+#define _BOUNDED_QUEUE_H_
+
+#include <atomic>
+#include <thread>
+#include <emmintrin.h>
+#include "Types.h"
+#include "EventCount.h"
+
+namespace Simpleton
+{
+
+    namespace _INTERNAL
+    {
+        enum
+        {
+            QUEUE_CACHE_LINE  = 64,
+            QUEUE_SPIN_COUNT  = 128,   ///< Number of failed attempts before a blocking call goes to sleep
+        };
+
+        inline size_t RoundUpPow2( size_t n )
+        {
+            size_t nPow2 = 2;
+            while( nPow2 < n )
+                nPow2 *= 2;
+            return nPow2;
+        }
+
+        /// Spins, then sleeps, until 'try' succeeds.  The caller must notify 'ec' whenever 'try' might start succeeding
+        template< class Try_T >
+        void BlockUntil( EventCount& ec, const Try_T& tryOp )
+        {
+            for( uint i=0; i<QUEUE_SPIN_COUNT; i++ )
+            {
+                if( tryOp() )
+                    return;
+                _mm_pause();
+            }
+
+            while( !tryOp() )
+            {
+                uint32 nKey = ec.PrepareWait();
+                if( tryOp() )
+                {
+                    ec.CancelWait();
+                    return;
+                }
+                ec.Wait(nKey);
+            }
+        }
+    }
+
+    //=====================================================================================================================
+    /// \ingroup Simpleton
+    /// \brief Fixed-capacity, multi-producer multi-consumer FIFO queue
+    ///
+    ///   Ring buffer in which each cell carries a sequence number, after Dmitry Vyukov's bounded MPMC queue.
+    ///     Producers and consumers each claim a cell with one CAS, and hand it off by bumping its sequence number.
+    ///     Nothing is ever allocated after construction.
+    ///
+    ///   T must be default-constructible and assignable.  Capacity is rounded up to a power of two.
+    ///
+    ///   The blocking Push/Pop spin for a bit, then sleep on an EventCount.  The Try forms never block,
+    ///     but they do pay for a wakeup check, so that the two forms can be freely mixed.
+    ///
+    //=====================================================================================================================
+    template< class T >
+    class MPMCQueue
+    {
+    public:
+
+        MPMCQueue( size_t nCapacity )
+        {
+            nCapacity = _INTERNAL::RoundUpPow2( nCapacity );
+            m_nMask = nCapacity-1;
+            m_pCells = new Cell[nCapacity];
+            for( size_t i=0; i<nCapacity; i++ )
+                m_pCells[i].nSequence.store( i, std::memory_order_relaxed );
+
+            m_nEnqueue.store( 0, std::memory_order_relaxed );
+            m_nDequeue.store( 0, std::memory_order_relaxed );
+        }
+
+        ~MPMCQueue()
+        {
+            delete[] m_pCells;
+        }
+
+        size_t GetCapacity() const { return m_nMask+1; }
+
+        //=====================================================================================================================
+        /// \return False if the queue is full
+        //=====================================================================================================================
+        bool TryPush( const T& item )
+        {
+            if( !TryPushNoNotify(item) )
+                return false;
+            m_NotEmpty.NotifyOne();
+            return true;
+        }
+
+        //=====================================================================================================================
+        /// \return False if the queue is empty
+        //=====================================================================================================================
+        bool TryPop( T& item )
+        {
+            if( !TryPopNoNotify(item) )
+                return false;
+            m_NotFull.NotifyOne();
+            return true;
+        }
+
+        //=====================================================================================================================
+        /// Waits for room in the queue
+        //=====================================================================================================================
+        void Push( const T& item )
+        {
+            _INTERNAL::BlockUntil( m_NotFull, [&]() { return this->TryPushNoNotify(item); } );
+            m_NotEmpty.NotifyOne();
+        }
+
+        //=====================================================================================================================
+        /// Waits for an item to arrive
+        //=====================================================================================================================
+        void Pop( T& item )
+        {
+            _INTERNAL::BlockUntil( m_NotEmpty, [&]() { return this->TryPopNoNotify(item); } );
+            m_NotFull.NotifyOne();
+        }
+
+        //=====================================================================================================================
+        /// Racy size estimate
+        //=====================================================================================================================
+        size_t GetSizeApprox() const
+        {
+            size_t nDeq = m_nDequeue.load( std::memory_order_relaxed );
+            size_t nEnq = m_nEnqueue.load( std::memory_order_relaxed );
+            return (nEnq > nDeq) ? nEnq-nDeq : 0;
+        }
+
+    private:
+
+        MPMCQueue( const MPMCQueue& );
+        MPMCQueue& operator=( const MPMCQueue& );
+
+        struct Cell
+        {
+            std::atomic<size_t> nSequence;
+            T Data;
+        };
+
+        bool TryPushNoNotify( const T& item )
+        {
+            size_t nPos = m_nEnqueue.load( std::memory_order_relaxed );
+            Cell* pCell;
+            while(1)
+            {
+                pCell = &m_pCells[nPos & m_nMask];
+                size_t nSeq = pCell->nSequence.load( std::memory_order_acquire );
+                intptr_t nDiff = (intptr_t)nSeq - (intptr_t)nPos;
+                if( nDiff == 0 )
+                {
+                    // cell is free.  Try to claim it
+                    if( m_nEnqueue.compare_exchange_weak( nPos, nPos+1, std::memory_order_relaxed ) )
+                        break;
+                }
+                else if( nDiff < 0 )
+                {
+                    // cell still holds the item from one lap ago
+                    return false;
+                }
+                else
+                {
+                    // someone else claimed it
+                    nPos = m_nEnqueue.load( std::memory_order_relaxed );
+                }
+            }
+
+            pCell->Data = item;
+            pCell->nSequence.store( nPos+1, std::memory_order_release );
+            return true;
+        }
+
+        bool TryPopNoNotify( T& item )
+        {
+            size_t nPos = m_nDequeue.load( std::memory_order_relaxed );
+            Cell* pCell;
+            while(1)
+            {
+                pCell = &m_pCells[nPos & m_nMask];
+                size_t nSeq = pCell->nSequence.load( std::memory_order_acquire );
+                intptr_t nDiff = (intptr_t)nSeq - (intptr_t)(nPos+1);
+                if( nDiff == 0 )
+                {
+                    if( m_nDequeue.compare_exchange_weak( nPos, nPos+1, std::memory_order_relaxed ) )
+                        break;
+                }
+                else if( nDiff < 0 )
+                {
+                    // not written yet
+                    return false;
+                }
+                else
+                {
+                    nPos = m_nDequeue.load( std::memory_order_relaxed );
+                }
+            }
+
+            item = pCell->Data;
+            pCell->nSequence.store( nPos + m_nMask + 1, std::memory_order_release );
+            return true;
+        }
+
+        // producers and consumers hammer different counters.  Keep them on separate cache lines
+        char m_Pad0[_INTERNAL::QUEUE_CACHE_LINE];
+        Cell* m_pCells;
+        size_t m_nMask;
+        char m_Pad1[_INTERNAL::QUEUE_CACHE_LINE];
+        std::atomic<size_t> m_nEnqueue;
+        char m_Pad2[_INTERNAL::QUEUE_CACHE_LINE];
+        std::atomic<size_t> m_nDequeue;
+        char m_Pad3[_INTERNAL::QUEUE_CACHE_LINE];
+
+        EventCount m_NotEmpty;  ///< Consumers sleeping in Pop
+        EventCount m_NotFull;   ///< Producers sleeping in Push
+    };
+
+    //=====================================================================================================================
+    /// \ingroup Simpleton
+    /// \brief Fixed-capacity, single-producer single-consumer FIFO queue
+    ///
+    ///   Exactly one thread may push, and exactly one (other) thread may pop.  In exchange, there are no
+    ///     read-modify-write operations at all.  Each side keeps a private copy of the other side's index,
+    ///     and only re-reads the shared one when its copy says the queue is full (or empty).
+    ///
+    //=====================================================================================================================
+    template< class T >
+    class SPSCQueue
+    {
+    public:
+
+        SPSCQueue( size_t nCapacity )
+        {
+            nCapacity = _INTERNAL::RoundUpPow2( nCapacity );
+            m_nMask = nCapacity-1;
+            m_pItems = new T[nCapacity];
+
+            m_nHead.store( 0, std::memory_order_relaxed );
+            m_nTail.store( 0, std::memory_order_relaxed );
+            m_nCachedHead = 0;
+            m_nCachedTail = 0;
+        }
+
+        ~SPSCQueue()
+        {
+            delete[] m_pItems;
+        }
+
+        size_t GetCapacity() const { return m_nMask+1; }
+
+        //=====================================================================================================================
+        /// May only be called by the producer.
+        /// \return False if the queue is full
+        //=====================================================================================================================
+        bool TryPush( const T& item )
+        {
+            if( !TryPushNoNotify(item) )
+                return false;
+            m_NotEmpty.NotifyOne();
+            return true;
+        }
+
+        //=====================================================================================================================
+        /// May only be called by the consumer.
+        /// \return False if the queue is empty
+        //=====================================================================================================================
+        bool TryPop( T& item )
+        {
+            if( !TryPopNoNotify(item) )
+                return false;
+            m_NotFull.NotifyOne();
+            return true;
+        }
+
+        //=====================================================================================================================
+        /// May only be called by the producer.  Waits for room in the queue
+        //=====================================================================================================================
+        void Push( const T& item )
+        {
+            _INTERNAL::BlockUntil( m_NotFull, [&]() { return this->TryPushNoNotify(item); } );
+            m_NotEmpty.NotifyOne();
+        }
+
+        //=====================================================================================================================
+        /// May only be called by the consumer.  Waits for an item to arrive
+        //=====================================================================================================================
+        void Pop( T& item )
+        {
+            _INTERNAL::BlockUntil( m_NotEmpty, [&]() { return this->TryPopNoNotify(item); } );
+            m_NotFull.NotifyOne();
+        }
+
+    private:
+
+        SPSCQueue( const SPSCQueue& );
+        SPSCQueue& operator=( const SPSCQueue& );
+
+        bool TryPushNoNotify( const T& item )
+        {
+            size_t nTail = m_nTail.load( std::memory_order_relaxed );
+            if( nTail - m_nCachedHead > m_nMask )
+            {
+                m_nCachedHead = m_nHead.load( std::memory_order_acquire );
+                if( nTail - m_nCachedHead > m_nMask )
+                    return false;
+            }
+
+            m_pItems[nTail & m_nMask] = item;
+            m_nTail.store( nTail+1, std::memory_order_release );
+            return true;
+        }
+
+        bool TryPopNoNotify( T& item )
+        {
+            size_t nHead = m_nHead.load( std::memory_order_relaxed );
+            if( nHead == m_nCachedTail )
+            {
+                m_nCachedTail = m_nTail.load( std::memory_order_acquire );
+                if( nHead == m_nCachedTail )
+                    return false;
+            }
+
+            item = m_pItems[nHead & m_nMask];
+            m_nHead.store( nHead+1, std::memory_order_release );
+            return true;
+        }
+
+        char m_Pad0[_INTERNAL::QUEUE_CACHE_LINE];
+        T* m_pItems;
+        size_t m_nMask;
+        char m_Pad1[_INTERNAL::QUEUE_CACHE_LINE];
+        std::atomic<size_t> m_nTail;    ///< Written by producer
+        size_t m_nCachedHead;           ///< Producer's copy of m_nHead
+        char m_Pad2[_INTERNAL::QUEUE_CACHE_LINE];
+        std::atomic<size_t> m_nHead;    ///< Written by consumer
+        size_t m_nCachedTail;           ///< Consumer's copy of m_nTail
+        char m_Pad3[_INTERNAL::QUEUE_CACHE_LINE];
+
+        EventCount m_NotEmpty;
+        EventCount m_NotFull;
+    };
+
+}
+
+#endif // _BOUNDED_QUEUE_H_
@@ -0,0 +1,120 @@
+//=====================================================================================================================
+//
+//   ChunkSource.h
+//
+//   Definition of class: Simpleton::ChunkSource
+//
+//   The lazy man's utility library
+//   Joshua Barczak
+//   Copyright 2016 Joshua Barczak
+//
+//   LICENSE:  See Doc\License.txt for terms and conditions
+//
+//=====================================================================================================================
+
+#ifndef _CHUNK_SOURCE_H_
+#define _CHUNK_SOURCE_H_
+
+#include <stddef.h>
+#include <atomic>
+
+namespace Simpleton
+{
+
+    //=====================================================================================================================
+    /// \ingroup Simpleton
+    /// \brief Where allocators get their big blocks of memory from
+    ///
+    ///   Chunk sources must be thread-safe.  Returned chunks must be aligned to at least 16 bytes.
+    ///
+    //=====================================================================================================================
+    class ChunkSource
+    {
+    public:
+
+        virtual ~ChunkSource() {}
+
+        /// \return A chunk of at least nBytes, or null if the source is exhausted
+        virtual void* AllocChunk( size_t nBytes ) = 0;
+
+        /// \param nBytes  The size that was passed to AllocChunk
+        virtual void FreeChunk( void* pChunk, size_t nBytes ) = 0;
+
+        /// Chunk sizes should be a multiple of this, or memory is wasted
+        virtual size_t GetGranularity() const { return 1; }
+
+        /// Source which calls malloc.  Used by allocators that aren't given one
+        static ChunkSource* GetDefault();
+    };
+
+    //=====================================================================================================================
+    /// \ingroup Simpleton
+    /// \brief Plain malloc/free
+    //=====================================================================================================================
+    class MallocChunkSource : public ChunkSource
+    {
+    public:
+        virtual void* AllocChunk( size_t nBytes );
+        virtual void FreeChunk( void* pChunk, size_t nBytes );
+    };
+
+    //=====================================================================================================================
+    /// \ingroup Simpleton
+    /// \brief Chunks backed by large (2MB) pages, to cut down on TLB misses
+    ///
+    ///   On Linux, explicit huge pages (MAP_HUGETLB) are tried first.  If none are reserved, we fall back to
+    ///    regular pages with an madvise(MADV_HUGEPAGE) hint, which lets transparent huge pages kick in.
+    ///
+    ///   On Windows, MEM_LARGE_PAGES is tried first.  This requires the 'Lock pages in memory' privilege.
+    ///    Without it, we fall back to regular VirtualAlloc.
+    ///
+    ///   Chunk sizes are rounded up to the large page size.
+    ///
+    //=====================================================================================================================
+    class LargePageChunkSource : public ChunkSource
+    {
+    public:
+
+        LargePageChunkSource();
+
+        virtual void* AllocChunk( size_t nBytes );
+        virtual void FreeChunk( void* pChunk, size_t nBytes );
+        virtual size_t GetGranularity() const { return m_nPageSize; }
+
+    private:
+
+        size_t RoundUp( size_t nBytes ) const { return (nBytes + m_nPageSize-1) & ~(m_nPageSize-1); }
+
+        size_t m_nPageSize;
+        std::atomic<bool> m_bUseLargePages;  ///< Cleared after the first time a large page allocation fails
+    };
+
+    //=====================================================================================================================
+    /// \ingroup Simpleton
+    /// \brief Hands out pieces of a caller-supplied memory region
+    ///
+    ///   Chunks are bump-allocated from the region and are never re-used.  Freeing chunks does nothing.
+    ///   Once the region is used up, chunks come from the fallback source (if any), or allocation fails.
+    ///
+    //=====================================================================================================================
+    class RegionChunkSource : public ChunkSource
+    {
+    public:
+
+        RegionChunkSource( void* pRegion, size_t nBytes, ChunkSource* pFallback=0 );
+
+        virtual void* AllocChunk( size_t nBytes );
+        virtual void FreeChunk( void* pChunk, size_t nBytes );
+
+    private:
+
+        bool IsInRegion( void* p ) const { return (char*)p >= m_pRegion && (char*)p < m_pRegion + m_nSize; }
+
+        char* m_pRegion;
+        size_t m_nSize;
+        std::atomic<size_t> m_nOffset;
+        ChunkSource* m_pFallback;
+    };
+}
+
+#endif // _CHUNK_SOURCE_H_
@@ -0,0 +1,99 @@
+//=====================================================================================================================
+//
+//   ConcurrentPoolAllocator.h
+//
+//   Thread-safe pooled memory allocator for batching small mallocs
+//
+//   The lazy man's utility library
+//   Joshua Barczak
+//   Copyright 2016 Joshua Barczak
+//
+//   LICENSE:  See Doc\License.txt for terms and conditions
+//
+//=====================================================================================================================
+
+#ifndef _CONCURRENT_POOL_ALLOCATOR_H_
+#define _CONCURRENT_POOL_ALLOCATOR_H_
+
+#include <stddef.h>
+#include <atomic>
+#include "Types.h"
+#include "LockFreeStack.h"
+
+namespace Simpleton
+{
+    /// Thread-safe counterpart to PoolAllocator.
+    ///
+    ///  Each thread bump-allocates out of a chunk of its own, so the common case touches no shared state.
+    ///   Threads remember their chunks for the 16 allocators they used most recently.
+    ///  When a thread's chunk runs dry, it pops a fresh one off a shared lock-free free list, or mallocs one if the list is empty.
+    ///
+    ///  Recycle and FreeAll release everything at once, and may not be called while other threads are allocating.
+    ///   Recycle puts every chunk back on the free list (the same trick DX11BufferPool uses for buffers).
+    ///   Oversized allocs get a dedicated malloc, which is released by either call.
+    ///   Both of them invalidate every thread's current chunk, by giving the allocator a new identity.
+    ///
+    class ConcurrentPoolAllocator
+    {
+    public:
+
+        class ScopedFree
+        {
+        public:
+            ScopedFree( ConcurrentPoolAllocator& alloc ) : m_rAlloc(alloc){}
+            ~ScopedFree() { m_rAlloc.FreeAll(); };
+        private:
+            ConcurrentPoolAllocator& m_rAlloc;
+        };
+
+        class ScopedRecycler
+        {
+        public:
+            ScopedRecycler( ConcurrentPoolAllocator& alloc ) : m_rAlloc(alloc){}
+            ~ScopedRecycler() { m_rAlloc.Recycle(); };
+        private:
+            ConcurrentPoolAllocator& m_rAlloc;
+        };
+
+        ConcurrentPoolAllocator();
+        ~ConcurrentPoolAllocator() { FreeAll(); }
+
+        template< class T > T* GetA() { return reinterpret_cast<T*>( GetMore( sizeof(T) ) ); }
+        template< class T > T* GetSome( size_t n ) { return reinterpret_cast<T*>( GetMore( sizeof(T)*n ) ); };
+
+        /// Returns NULL if out of memory
+        void* GetMore( size_t nSize );
+
+        void FreeAll( );
+
+        void Recycle( );
+
+    private:
+
+        ConcurrentPoolAllocator( const ConcurrentPoolAllocator& );
+        ConcurrentPoolAllocator& operator=( const ConcurrentPoolAllocator& );
+
+        struct Chunk : public LockFreeStack::Node
+        {
+            size_t nCapacity;       ///< Total Size of block (including header)
+            size_t nOffset;         ///< Offset of next free byte.  Only touched by the thread that owns the chunk
+        };
+
+        enum
+        {
+            ALIGN       = 16,       ///< Align all 'GetMore' calls to this size
+            CHUNKSIZE   = 64*1024,  ///< Size of per-thread chunks.  Larger allocs get a chunk of their own
+            HEADER_SIZE = (sizeof(Chunk) + ALIGN-1) & ~(ALIGN-1)
+        };
+
+        void* GetMoreSlow( size_t nSize );
+        Chunk* NewChunk( size_t nBytes );  ///< Returns NULL if out of memory
+
+        std::atomic<uint64> m_nID;          ///< Unique identity.  Changes whenever memory is recycled
+        LockFreeStack m_AllChunks;          ///< Every standard-sized chunk ever allocated
+        LockFreeStack m_AvailableChunks;    ///< Chunks that no thread has claimed since the last recycle
+        LockFreeStack m_LargeChunks;        ///< Dedicated chunks for oversized allocs.  Freed on recycle
+    };
+}
+
+#endif
@@ -0,0 +1,109 @@
+//=====================================================================================================================
+//
+//   EventCount.h
+//
+//   Definition of class: Simpleton::EventCount
+//
+//   The lazy man's utility library
+//   Joshua Barczak
+//   Copyright 2016 Joshua Barczak
+//
+//   LICENSE:  See Doc\License.txt for terms and conditions
+//
+//=====================================================================================================================
+
+#ifndef _EVENT_COUNT_H_
+#define _EVENT_COUNT_H_
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include "Types.h"
+
+namespace Simpleton
+{
+
+    //=====================================================================================================================
+    /// \ingroup Simpleton
+    /// \brief Lets threads sleep until some lock-free condition changes
+    ///
+    ///  Waiting is a two-step process, so that a notification can't slip in between checking a condition and sleeping:
+    ///
+    ///     uint32 key = ec.PrepareWait();
+    ///     if( condition is satisfied )
+    ///         ec.CancelWait();
+    ///     else
+    ///         ec.Wait(key);
+    ///
+    ///  The notifier changes the condition and then calls Notify.  If nobody is waiting, Notify costs a fence and a load.
+    ///
+    //=====================================================================================================================
+    class EventCount
+    {
+    public:
+
+        EventCount() : m_nEpoch(0), m_nWaiters(0) {}
+
+        uint32 PrepareWait()
+        {
+            m_nWaiters.fetch_add( 1, std::memory_order_seq_cst );
+            std::atomic_thread_fence( std::memory_order_seq_cst );
+            return m_nEpoch.load( std::memory_order_acquire );
+        }
+
+        void CancelWait()
+        {
+            m_nWaiters.fetch_sub( 1, std::memory_order_relaxed );
+        }
+
+        /// Sleeps until a notification is issued after the matching PrepareWait
+        void Wait( uint32 nKey )
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                while( m_nEpoch.load( std::memory_order_relaxed ) == nKey )
+                    m_CV.wait(lock);
+            }
+            m_nWaiters.fetch_sub( 1, std::memory_order_relaxed );
+        }
+
+        /// Wakes up one waiting thread, if there are any
+        void NotifyOne()
+        {
+            std::atomic_thread_fence( std::memory_order_seq_cst );
+            if( m_nWaiters.load( std::memory_order_relaxed ) == 0 )
+                return;
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                m_nEpoch.fetch_add( 1, std::memory_order_release );
+            }
+            m_CV.notify_one();
+        }
+
+        /// Wakes up all waiting threads
+        void NotifyAll()
+        {
+            std::atomic_thread_fence( std::memory_order_seq_cst );
+            if( m_nWaiters.load( std::memory_order_relaxed ) == 0 )
+                return;
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                m_nEpoch.fetch_add( 1, std::memory_order_release );
+            }
+            m_CV.notify_all();
+        }
+
+    private:
+
+        EventCount( const EventCount& );
+        EventCount& operator=( const EventCount& );
+
+        std::atomic<uint32> m_nEpoch;
+        std::atomic<uint32> m_nWaiters;
+        std::mutex m_Mutex;
+        std::condition_variable m_CV;
+    };
+
+}
+
+#endif // _EVENT_COUNT_H_
@@ -16,6 +16,20 @@
 #define _LOCKFREESTACK_H_
 
 #include <atomic>
+#include <assert.h>
+#include <stdint.h>
+
+// 64-bit x86 has a 16-byte CAS, which swaps a full pointer and a 64-bit modification counter at once.
+//   Elsewhere, the pointer and counter are packed into 64 bits
+#if defined(_M_X64) || defined(__x86_64__)
+    #define LOCKFREESTACK_DWCAS
+    #ifdef _MSC_VER
+        #include <intrin.h>
+        #define LOCKFREESTACK_ALIGN16 __declspec(align(16))
+    #else
+        #define LOCKFREESTACK_ALIGN16 __attribute__((aligned(16)))
+    #endif
+#endif
 
 namespace Simpleton
 {
@@ -23,15 +37,24 @@ namespace Simpleton
     //=====================================================================================================================
     /// \ingroup Simpleton
     /// \brief Lockfree stack data structure
-    ///  
+    ///
     ///   Memory management for stack nodes is the responsibility of the user
     ///     This class is simply a wrapper around a head pointer, which abstracts away the atomic operations
     ///
+    ///   The head pointer is paired with a modification counter, and both are swapped with a single CAS.
+    ///     This prevents the ABA problem, where a pop succeeds even though the head node was popped and re-pushed
+    ///     out from under it.  On x64, a 16-byte CAS is used, and the counter is 64 bits wide.  On 32-bit targets the
+    ///     pointer and a 32-bit counter share 64 bits.  Other 64-bit targets assume that pointers fit in 48 bits,
+    ///     leaving 16 bits of counter, and assert if they do not.
+    ///
+    ///   A popping thread may read the 'next' link of a node which some other thread just popped.
+    ///    Nodes must therefore stay readable while the stack is in use.  Recycling nodes is fine, freeing them is not.
+    ///
     //=====================================================================================================================
     class LockFreeStack
     {
     public:
-    
+
         class Node
         {
         private:
@@ -39,42 +62,65 @@ namespace Simpleton
             Node* m_pNext_LFS;
         };
 
-          
+        /// Returns the node following 'pNode' in a chain returned by 'pop_all'
+        static Node* Next( const Node* pNode ) { return pNode->m_pNext_LFS; }
+
+        /// Links two nodes together, for building up chains to pass to 'push_chain'
+        static void Link( Node* pNode, Node* pNext ) { pNode->m_pNext_LFS = pNext; }
+
         //=====================================================================================================================
         //=====================================================================================================================
-        LockFreeStack() : m_pHead(0)
+        LockFreeStack()
         {
+            Head head = { 0, 0 };
+            StoreHead( head );
         }
 
         //=====================================================================================================================
         //=====================================================================================================================
         void push_front( Node* pNode )
         {
-            Node* pHead = m_pHead.load( std::memory_order_relaxed );
+            push_chain( pNode, pNode );
+        }
+
+        //=====================================================================================================================
+        /// Pushes a pre-linked chain of nodes in one atomic operation.
+        ///   'pLast' must be reachable from 'pFirst' by following 'Next'.  Its 'next' link is overwritten
+        //=====================================================================================================================
+        void push_chain( Node* pFirst, Node* pLast )
+        {
+            Head head = LoadHead();
             do
             {
-                pNode->m_pNext_LFS = pHead;
-            } while( !m_pHead.compare_exchange_weak( pHead, pNode,
-                                                     std::memory_order_release,
-                                                     std::memory_order_relaxed) );
+                pLast->m_pNext_LFS = head.pNode;
+            } while( !ReplaceHead( head, pFirst ) );
         }
 
         //=====================================================================================================================
         //=====================================================================================================================
         Node* pop_front( )
         {
-            Node* pPop;
+            Head head = LoadHead();
             do
             {
-                pPop = m_pHead.load( std::memory_order_relaxed );
-                if( pPop == 0 )
-                    return pPop;
+                if( head.pNode == 0 )
+                    return 0;
 
-            } while( !m_pHead.compare_exchange_weak( pPop, pPop->m_pNext_LFS,
-                                                     std::memory_order_release,
-                                                     std::memory_order_relaxed) );
+            } while( !ReplaceHead( head, head.pNode->m_pNext_LFS ) );
 
-            return pPop;
+            return head.pNode;
+        }
+
+        //=====================================================================================================================
+        /// Atomically removes every node from the stack.
+        /// \return The former top of the stack.  Use 'Next' to walk the remainder of the chain
+        //=====================================================================================================================
+        Node* pop_all()
+        {
+            Head head = LoadHead();
+            while( !ReplaceHead( head, 0 ) )
+                ;
+            return head.pNode;
         }
 
         //=====================================================================================================================
@@ -82,8 +128,11 @@ namespace Simpleton
         //=====================================================================================================================
         void push_front_serial( Node* pNode )
         {
-            pNode->m_pNext_LFS = m_pHead.load( std::memory_order_relaxed );
-            m_pHead.store( pNode, std::memory_order_relaxed );
+            Head head = LoadHead();
+            pNode->m_pNext_LFS = head.pNode;
+            head.pNode = pNode;
+            head.nTag++;
+            StoreHead( head );
         }
 
         //=====================================================================================================================
@@ -91,9 +140,14 @@ namespace Simpleton
         //=====================================================================================================================
         Node* pop_front_serial()
         {
-            Node* pN = m_pHead.load( std::memory_order_relaxed );
+            Head head = LoadHead();
+            Node* pN = head.pNode;
             if( pN )
-                m_pHead.store( pN->m_pNext_LFS, std::memory_order_relaxed );
+            {
+                head.pNode = pN->m_pNext_LFS;
+                head.nTag++;
+                StoreHead( head );
+            }
             return pN;
         }
 
@@ -102,7 +156,10 @@ namespace Simpleton
         //=====================================================================================================================
         void clear()
         {
-            m_pHead = 0;
+            Head head = LoadHead();
+            head.pNode = 0;
+            head.nTag++;
+            StoreHead( head );
         }
 
         //=====================================================================================================================
@@ -110,13 +167,118 @@ namespace Simpleton
         //=====================================================================================================================
         void CopyFrom( const LockFreeStack& src )
         {
-            m_pHead.store( src.m_pHead );
+            Head head = LoadHead();
+            head.pNode = src.LoadHead().pNode;
+            head.nTag++;
+            StoreHead( head );
+        }
+
+        //=====================================================================================================================
+        /// Racy emptiness check
+        //=====================================================================================================================
+        bool empty() const
+        {
+            return LoadHead().pNode == 0;
         }
 
     private:
-        std::atomic<Node*> m_pHead;
+
+        struct Head
+        {
+            Node* pNode;
+            uint64_t nTag;
+        };
+
+#ifdef LOCKFREESTACK_DWCAS
+
+        /// The two halves are read separately.  A torn read only causes the next CAS to fail, and retry
+        Head LoadHead() const
+        {
+            Head head;
+            head.nTag  = (uint64_t) m_Head.nTag;
+            head.pNode = (Node*) m_Head.nNode;
+            return head;
+        }
+
+        /// Not atomic.  Only for use in single-threaded code
+        void StoreHead( const Head& head )
+        {
+            m_Head.nNode = (int64_t) head.pNode;
+            m_Head.nTag  = (int64_t) head.nTag;
+        }
+
+        /// Swaps in 'pNode' with the next tag, if the head still equals 'rExpected'.
+        ///   Otherwise, loads the current head into 'rExpected'.  Full barrier either way
+        bool ReplaceHead( Head& rExpected, Node* pNode )
+        {
+            int64_t nExpected[2] = { (int64_t) rExpected.pNode, (int64_t) rExpected.nTag };
+            int64_t nNewNode = (int64_t) pNode;
+            int64_t nNewTag  = (int64_t)( rExpected.nTag + 1 );
+#ifdef _MSC_VER
+            bool bSwapped = _InterlockedCompareExchange128( &m_Head.nNode, nNewTag, nNewNode, nExpected ) != 0;
+#else
+            bool bSwapped;
+            __asm__ __volatile__( "lock cmpxchg16b %1\n\tsetz %0"
+                                  : "=q"(bSwapped), "+m"(m_Head.nNode), "+a"(nExpected[0]), "+d"(nExpected[1])
+                                  : "b"(nNewNode), "c"(nNewTag)
+                                  : "cc", "memory" );
+#endif
+            rExpected.pNode = (Node*) nExpected[0];
+            rExpected.nTag  = (uint64_t) nExpected[1];
+            return bSwapped;
+        }
+
+        struct LOCKFREESTACK_ALIGN16 AlignedHead
+        {
+            volatile int64_t nNode;
+            volatile int64_t nTag;
+        };
+
+        AlignedHead m_Head;
+
+#else
+
+        // pointer lives in the low bits, modification count in the high bits
+        static const int TAG_SHIFT = (sizeof(void*) == 8) ? 48 : 32;
+        static const uint64_t PTR_MASK = (((uint64_t)1) << TAG_SHIFT) - 1;
+
+        static Head Unpack( uint64_t nHead )
+        {
+            Head head = { (Node*)(uintptr_t)( nHead & PTR_MASK ), nHead >> TAG_SHIFT };
+            return head;
+        }
+
+        static uint64_t Pack( Node* pNode, uint64_t nTag )
+        {
+            assert( ((uint64_t)(uintptr_t)pNode & ~PTR_MASK) == 0 );
+            return (nTag << TAG_SHIFT) | (uint64_t)(uintptr_t)pNode;
+        }
+
+        Head LoadHead() const
+        {
+            return Unpack( m_Head.load( std::memory_order_acquire ) );
+        }
+
+        void StoreHead( const Head& head )
+        {
+            m_Head.store( Pack( head.pNode, head.nTag ), std::memory_order_relaxed );
+        }
+
+        bool ReplaceHead( Head& rExpected, Node* pNode )
+        {
+            uint64_t nExpected = Pack( rExpected.pNode, rExpected.nTag );
+            bool bSwapped = m_Head.compare_exchange_weak( nExpected, Pack( pNode, rExpected.nTag + 1 ),
+                                                          std::memory_order_acq_rel,
+                                                          std::memory_order_acquire );
+            rExpected = Unpack( nExpected );
+            return bSwapped;
+        }
+
+        std::atomic<uint64_t> m_Head;
+
+#endif
     };
-    
+
 }
 
 #endif // _LOCKFREESTACK_H_
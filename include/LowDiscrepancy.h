@@ -0,0 +1,159 @@
+//=====================================================================================================================
+//
+//   LowDiscrepancy.h
+//
+//   Low-discrepancy (quasi-random) sequences, for feeding the sampling functions in VectorMath.h
+//
+//   The lazy man's utility library
+//   Joshua Barczak
+//   Copyright 2016 Joshua Barczak
+//
+//   LICENSE:  See Doc\License.txt for terms and conditions
+//
+//=====================================================================================================================
+
+#ifndef _LOW_DISCREPANCY_H_
+#define _LOW_DISCREPANCY_H_
+
+#include "Types.h"
+#include "VectorMath.h"
+
+namespace Simpleton
+{
+    namespace _INTERNAL
+    {
+        inline uint32 ReverseBits( uint32 x )
+        {
+            x = ((x >> 1) & 0x55555555) | ((x & 0x55555555) << 1);
+            x = ((x >> 2) & 0x33333333) | ((x & 0x33333333) << 2);
+            x = ((x >> 4) & 0x0f0f0f0f) | ((x & 0x0f0f0f0f) << 4);
+            x = ((x >> 8) & 0x00ff00ff) | ((x & 0x00ff00ff) << 8);
+            return (x >> 16) | (x << 16);
+        }
+
+        /// Maps a 32-bit fixed-point fraction to a float in [0,1).  Rounds down, so 1 is never returned
+        inline float FixedToUnitFloat( uint32 x ) { return (x >> 8) * (1.0f/16777216.0f); }
+
+        /// Laine and Karras' hash-based approximation of an Owen scramble, applied to bit-reversed values
+        inline uint32 LaineKarrasPermutation( uint32 x, uint32 nSeed )
+        {
+            x += nSeed;
+            x ^= x * 0x6c50b47cu;
+            x ^= x * 0xb82f1e52u;
+            x ^= x * 0xc7afe638u;
+            x ^= x * 0x8d22f6e6u;
+            return x;
+        }
+
+        inline uint32 HashSeed( uint32 x )
+        {
+            x ^= x >> 16;
+            x *= 0x7feb352du;
+            x ^= x >> 15;
+            x *= 0x846ca68bu;
+            x ^= x >> 16;
+            return x;
+        }
+
+        /// Radical inverse as a 32-bit fixed-point fraction.  'nBase' must be at least 2
+        uint32 RadicalInverseFixed( uint32 n, uint32 nBase );
+    }
+
+    /// Nested uniform (Owen) scramble of a 32-bit fixed-point fraction.  Each seed gives an independent randomization
+    ///  that keeps the sequence's stratification
+    inline uint32 OwenScramble( uint32 x, uint32 nSeed )
+    {
+        using namespace _INTERNAL;
+        return ReverseBits( LaineKarrasPermutation( ReverseBits(x), nSeed ) );
+    }
+
+    /// Radical inverse of 'n' in an arbitrary base, in [0,1).  This is dimension 'k' of the Halton sequence when
+    ///  'nBase' is the k'th prime
+    inline float RadicalInverse( uint32 n, uint32 nBase )
+    {
+        return _INTERNAL::FixedToUnitFloat( _INTERNAL::RadicalInverseFixed( n, nBase ) );
+    }
+
+    //=====================================================================================================================
+    /// First two dimensions of the Sobol sequence, Owen-scrambled.  Seed 0 is NOT the unscrambled sequence,
+    ///  but every seed is equally good.  Successive power-of-two sized blocks of indices are well stratified.
+    ///
+    ///  The index is also shuffled (with the same seed), so that different seeds do not produce correlated prefixes
+    //=====================================================================================================================
+    inline Vec2f Sobol2D( uint32 n, uint32 nSeed )
+    {
+        using namespace _INTERNAL;
+        uint32 nIndex = OwenScramble( n, HashSeed(nSeed) );
+
+        // dimension 0 is van der Corput.  Dimension 1 is generated by the (1,1) Pascal-like matrix
+        uint32 s = ReverseBits( nIndex );
+        uint32 t = 0;
+        for( uint32 v=0x80000000u; nIndex; nIndex >>= 1, v ^= v >> 1 )
+        {
+            if( nIndex & 1 )
+                t ^= v;
+        }
+
+        s = OwenScramble( s, HashSeed(nSeed ^ 0x5bd1e995u) );
+        t = OwenScramble( t, HashSeed(nSeed ^ 0x68e31da4u) );
+        return Vec2f( FixedToUnitFloat(s), FixedToUnitFloat(t) );
+    }
+
+    //=====================================================================================================================
+    /// Halton sequence in bases 2 and 3.  Non-zero seeds apply a random toroidal shift (Cranley-Patterson rotation)
+    //=====================================================================================================================
+    inline Vec2f Halton2D( uint32 n, uint32 nSeed=0 )
+    {
+        using namespace _INTERNAL;
+        uint32 s = ReverseBits(n);
+        uint32 t = RadicalInverseFixed(n,3);
+        if( nSeed )
+        {
+            s += HashSeed( nSeed );
+            t += HashSeed( nSeed ^ 0x5bd1e995u );
+        }
+        return Vec2f( FixedToUnitFloat(s), FixedToUnitFloat(t) );
+    }
+
+    //=====================================================================================================================
+    /// Roberts' R2 sequence:  n*(1/g, 1/g^2) mod 1, where g is the plastic number.  Evaluated in 32-bit fixed point,
+    ///  so it does not lose precision at large n.  Non-zero seeds apply a random toroidal shift
+    //=====================================================================================================================
+    inline Vec2f R2( uint32 n, uint32 nSeed=0 )
+    {
+        using namespace _INTERNAL;
+        const uint32 ALPHA0 = 3242174889u;   // round( 2^32 / g   )
+        const uint32 ALPHA1 = 2447445414u;   // round( 2^32 / g^2 )
+        uint32 s = 0x80000000u + n*ALPHA0;
+        uint32 t = 0x80000000u + n*ALPHA1;
+        if( nSeed )
+        {
+            s += HashSeed( nSeed );
+            t += HashSeed( nSeed ^ 0x5bd1e995u );
+        }
+        return Vec2f( FixedToUnitFloat(s), FixedToUnitFloat(t) );
+    }
+
+    enum SampleSequence
+    {
+        SEQUENCE_SOBOL,     ///< Owen-scrambled Sobol.  Best convergence, at power-of-two sample counts
+        SEQUENCE_HALTON,    ///< Halton (2,3).  Good at any sample count
+        SEQUENCE_R2,        ///< R2.  Cheapest, good at any sample count
+    };
+
+    /// Writes samples [nFirst,nFirst+nCount) of a 2D sequence into SoA arrays
+    void GenerateSamples2D( SampleSequence eSeq, uint32 nFirst, uint32 nCount, uint32 nSeed, float* pS, float* pT );
+
+    /// Maps (s,t) pairs to directions, as the corresponding functions in VectorMath.h do, and writes them to SoA arrays.
+    ///  Output arrays may not alias the inputs
+    void CosineWeightedDirections( const float* pS, const float* pT, size_t n, float* pX, float* pY, float* pZ );
+    void UniformSampleSphere( const float* pS, const float* pT, size_t n, float* pX, float* pY, float* pZ );
+    void UniformSampleHemisphere( const float* pS, const float* pT, size_t n, float* pX, float* pY, float* pZ );
+
+    /// Generates directions straight from a sequence, in tangent space, with Y up
+    void CosineWeightedDirections( SampleSequence eSeq, uint32 nFirst, uint32 nCount, uint32 nSeed, float* pX, float* pY, float* pZ );
+    void UniformSampleSphere( SampleSequence eSeq, uint32 nFirst, uint32 nCount, uint32 nSeed, float* pX, float* pY, float* pZ );
+    void UniformSampleHemisphere( SampleSequence eSeq, uint32 nFirst, uint32 nCount, uint32 nSeed, float* pX, float* pY, float* pZ );
+}
+
+#endif // _LOW_DISCREPANCY_H_
@@ -21,6 +21,12 @@
 
 namespace Simpleton
 {
+    namespace _INTERNAL
+    {
+        /// SSE kernels for 4x4 float matrices.  Output may alias either input
+        void MatrixMultiply4f( float* pOut, const float* pA, const float* pB );
+        void MatrixTranspose4f( float* pOut, const float* pIn );
+    }
 
     //=====================================================================================================================
     /// \ingroup Simpleton
@@ -37,125 +43,146 @@ namespace Simpleton
         {
         };
 
-        Matrix( const T values[(SIZE*SIZE)] )
-        {
-            memcpy(m_values, values, (SIZE*SIZE)*sizeof(T));
-        };
-
-        Matrix( const Matrix<T,SIZE>& rhs )
+        SIMPLETON_CONSTEXPR Matrix( const T values[(SIZE*SIZE)] ) : m_values()
         {
-            *this = rhs;
-        };
-
-        const Matrix<T,SIZE>& operator=( const Matrix<T,SIZE>& rhs )
-        {
-            memcpy(m_values, rhs.m_values, (SIZE*SIZE)*sizeof(T));
-            return *this;
+            for( int i=0; i<SIZE*SIZE; i++ )
+                m_values[i] = values[i];
         };
 
         /// Returns pointer to matrix data in COLUMN-major order
-        const T* GetColumnMajor() const { return m_values; };
-        T* GetColumnMajor()  { return m_values; };
+        SIMPLETON_CONSTEXPR const T* GetColumnMajor() const { return m_values; };
+        SIMPLETON_CONSTEXPR T* GetColumnMajor()  { return m_values; };
 
         operator const T*() const { return (const T*) this; };
 
         operator T*() { return (T*) this; };
 
-        Matrix<T,SIZE>& operator *= ( const Matrix<T,SIZE>& rhs )
+        SIMPLETON_CONSTEXPR Matrix<T,SIZE>& operator *= ( const Matrix<T,SIZE>& rhs )
         {
-            T newdata[(SIZE*SIZE)];
-            for( int c=0; c<SIZE; c++ )
-	        {
-		        for( int r=0; r<SIZE; r++ )
-		        {
-			        /** loop across rth row and down cth column **/
-			        newdata[(SIZE*c)+r] = 0.0;
-			        for( int x=0; x<SIZE; x++)
-			        {
-				        newdata[(SIZE*c)+r] += m_values[(SIZE*x)+r] * rhs.m_values[(SIZE*c)+x];
-			        }
-		        }
-	        }
-	        memcpy(m_values,newdata,16*sizeof(T));
+            *this = *this * rhs;
             return *this;
         };
         
-        Matrix<T,SIZE> operator* ( const Matrix<T,SIZE>& rhs ) const
+        SIMPLETON_CONSTEXPR Matrix<T,SIZE> operator* ( const Matrix<T,SIZE>& rhs ) const
         {
-            T newdata[(SIZE*SIZE)];
-	        for( int c=0; c<SIZE; c++ )
-	        {
-		        for( int r=0; r<SIZE; r++ )
-		        {
-			        /** loop across rth row and down cth column **/
-			        newdata[(SIZE*c)+r] = 0.0;
-			        for( int x=0; x<SIZE; x++)
-			        {
-				        newdata[(SIZE*c)+r] += m_values[(SIZE*x)+r] * rhs.m_values[(SIZE*c)+x];
-			        }
-		        }
-	        }
-
-            return Matrix<T,SIZE>(newdata);
+            return MatrixMultiply( *this, rhs );
         }
 
-        Matrix<T,SIZE> Transpose() const
+        SIMPLETON_CONSTEXPR Matrix<T,SIZE> Transpose() const
         {
-            T newdata[(SIZE*SIZE)];
-
-            int i,j;
-            for( i=0; i<SIZE; i++)
-	        {
-		        for( j=0; j<SIZE; j++)
-		        {
-			        /** loop across ith row and down jth column **/
-			        newdata[(SIZE*j)+i] = m_values[(SIZE*i)+j];
-		        }
-	        }
-
-            return Matrix<T,SIZE>(newdata);
+            return MatrixTranspose( *this );
         };
 
-        void Set( unsigned int row, unsigned int col, T val )
+        SIMPLETON_CONSTEXPR void Set( unsigned int row, unsigned int col, T val )
         {
             m_values[ (col*SIZE) + row ] = val;
         };
 
-        T Get( unsigned int row, unsigned int col ) const
+        SIMPLETON_CONSTEXPR T Get( unsigned int row, unsigned int col ) const
         {
             return m_values[ (col*SIZE) + row ];
         };
 
-        static Matrix<T,SIZE> Identity()
+        static SIMPLETON_CONSTEXPR Matrix<T,SIZE> Identity()
         {
-            Matrix<T,SIZE> r;
+            Matrix<T,SIZE> r = Zero();
             for( int i=0; i<SIZE; i++ )
-            {
-                for( int j=0; j<i; j++ )
-                    r.Set( i,j,0 );
-                
-                r.Set(i,i,1);
-
-                for( int j=i+1; j<SIZE; j++ )
-                    r.Set(i,j,0);
-            }
+                r.m_values[(SIZE*i)+i] = 1;
             return r;
         }
 
-        static Matrix<T,SIZE> Zero()
+        static SIMPLETON_CONSTEXPR Matrix<T,SIZE> Zero()
         {
-            Matrix<T,SIZE> r;
-            for( unsigned int i=0; i<SIZE*SIZE; i++ )
-                r.m_values[i] = 0;
-            return r;
+            return Matrix<T,SIZE>( ZERO_INIT );
         }
 
     private:
 
+        enum ZeroInit { ZERO_INIT };
+        SIMPLETON_CONSTEXPR explicit Matrix( ZeroInit ) : m_values() {}
+
         T m_values[(SIZE*SIZE)];
 
     };
 
+    /// Scalar matrix product.  Always works in constant expressions.  Matrix4f's operator* is SSE code, and only does so
+    ///  where SIMPLETON_IS_CONSTANT_EVALUATED is available
+    template< class T, int SIZE >
+    inline SIMPLETON_CONSTEXPR Matrix<T,SIZE> MatrixMultiply( const Matrix<T,SIZE>& a, const Matrix<T,SIZE>& b )
+    {
+        Matrix<T,SIZE> r = Matrix<T,SIZE>::Zero();
+        for( int c=0; c<SIZE; c++ )
+            for( int i=0; i<SIZE; i++ )
+                for( int x=0; x<SIZE; x++ )
+                    r.Set( i, c, r.Get(i,c) + a.Get(i,x)*b.Get(x,c) );
+        return r;
+    }
+
+    /// Scalar transpose.  Always works in constant expressions, like MatrixMultiply
+    template< class T, int SIZE >
+    inline SIMPLETON_CONSTEXPR Matrix<T,SIZE> MatrixTranspose( const Matrix<T,SIZE>& m )
+    {
+        Matrix<T,SIZE> r = Matrix<T,SIZE>::Zero();
+        for( int i=0; i<SIZE; i++ )
+            for( int j=0; j<SIZE; j++ )
+                r.Set( j, i, m.Get(i,j) );
+        return r;
+    }
+
+
+    //=====================================================================================================================
+    //  Matrix4f specializations
+    //
+    //   These call SSE kernels, which can't run at compile time.  Where the compiler can tell us that it is evaluating a
+    //    constant expression, they fall back to the scalar code and remain constexpr.  Elsewhere they are not constexpr,
+    //    and constant expressions must call MatrixMultiply and MatrixTranspose directly
+    //=====================================================================================================================
+#ifdef SIMPLETON_IS_CONSTANT_EVALUATED
+    #define MATRIX4F_CONSTEXPR SIMPLETON_CONSTEXPR
+#else
+    #define MATRIX4F_CONSTEXPR
+#endif
+
+    template<>
+    inline MATRIX4F_CONSTEXPR Matrix<float,4>& Matrix<float,4>::operator*=( const Matrix<float,4>& rhs )
+    {
+    #ifdef SIMPLETON_IS_CONSTANT_EVALUATED
+        if( SIMPLETON_IS_CONSTANT_EVALUATED() )
+        {
+            *this = MatrixMultiply( *this, rhs );
+            return *this;
+        }
+    #endif
+        _INTERNAL::MatrixMultiply4f( m_values, m_values, rhs.m_values );
+        return *this;
+    }
+
+    template<>
+    inline MATRIX4F_CONSTEXPR Matrix<float,4> Matrix<float,4>::operator*( const Matrix<float,4>& rhs ) const
+    {
+    #ifdef SIMPLETON_IS_CONSTANT_EVALUATED
+        if( SIMPLETON_IS_CONSTANT_EVALUATED() )
+            return MatrixMultiply( *this, rhs );
+    #endif
+        Matrix<float,4> r;
+        _INTERNAL::MatrixMultiply4f( r.m_values, m_values, rhs.m_values );
+        return r;
+    }
+
+    template<>
+    inline MATRIX4F_CONSTEXPR Matrix<float,4> Matrix<float,4>::Transpose() const
+    {
+    #ifdef SIMPLETON_IS_CONSTANT_EVALUATED
+        if( SIMPLETON_IS_CONSTANT_EVALUATED() )
+            return MatrixTranspose( *this );
+    #endif
+        Matrix<float,4> r;
+        _INTERNAL::MatrixTranspose4f( r.m_values, m_values );
+        return r;
+    }
+
+#undef MATRIX4F_CONSTEXPR
+
 
     typedef Matrix<float,2> Matrix2f;
     typedef Matrix<float,3> Matrix3f;
@@ -167,10 +194,28 @@ namespace Simpleton
 
     
     /// Returns a scaling matrix
-    Matrix4f MatrixScale( float x, float y, float z );
+    inline SIMPLETON_CONSTEXPR Matrix4f MatrixScale( float x, float y, float z )
+    {
+        const float values[] = {
+            x,0,0,0,
+            0,y,0,0,
+            0,0,z,0,
+            0,0,0,1
+        };
+        return Matrix4f(values);
+    }
    
     /// Returns a translation matrix
-    Matrix4f MatrixTranslate( float x, float y, float z );
+    inline SIMPLETON_CONSTEXPR Matrix4f MatrixTranslate( float x, float y, float z )
+    {
+        const float values[] = { // NOTE: column major!
+            1,0,0,0,
+            0,1,0,0,
+            0,0,1,0,
+            x,y,z,1
+        };
+        return Matrix4f(values);
+    }
 
     /// Returns a rotation matrix about the given axis.  Rotation is clockwise
     Matrix4f MatrixRotate( float x, float y, float z, float fAngleInRads );
@@ -183,8 +228,28 @@ namespace Simpleton
     ///  Near/Far are distances
     Matrix4f MatrixPerspectiveFovLH( float fAspect, float fFOV, float fNear, float fFar );
     Matrix4f MatrixPerspectiveFovRH( float fAspect, float fFOV, float fNear, float fFar );
-    Matrix4f MatrixOrthoRH( float w, float h, float fNear, float fFar );
-    Matrix4f MatrixOrthoLH( float w, float h, float fNear, float fFar );
+
+    inline SIMPLETON_CONSTEXPR Matrix4f MatrixOrthoRH( float w, float h, float fNear, float fFar )
+    {
+        const float values[] = { // NOTE: column major!
+            2/w, 0,   0,                      0,
+            0,   2/h, 0,                      0,
+            0,   0,   1/(fNear-fFar),         0,
+            0,   0,   fNear/(fNear-fFar),     1
+        };
+        return Matrix4f(values);
+    }
+
+    inline SIMPLETON_CONSTEXPR Matrix4f MatrixOrthoLH( float w, float h, float fNear, float fFar )
+    {
+        const float values[] = { // NOTE: column major!
+            2/w, 0,   0,                      0,
+            0,   2/h, 0,                      0,
+            0,   0,   1/(fFar-fNear),         0,
+            0,   0,   -fNear/(fFar-fNear),    1
+        };
+        return Matrix4f(values);
+    }
    
     /// Returns a rotation matrix which aligns the given vector along the positive Z axis
     Matrix4f MatrixAlignZToVector( const Vec3f& rVec );
@@ -193,14 +258,27 @@ namespace Simpleton
     Matrix4f MatrixAlignYToVector( const Vec3f& rVec );
 
     /// Transforms into a coordinate system defined by three basis vectors
-    Matrix4f MatrixCoordinateFrame( const Vec3f& rXAxis, const Vec3f& rYAxis, const Vec3f& rZAxis );
+    inline SIMPLETON_CONSTEXPR Matrix4f MatrixCoordinateFrame( const Vec3f& x, const Vec3f& y, const Vec3f& z )
+    {
+        const float values[] = { // NOTE: column major!  Basis vectors are the rows
+            x.x, y.x, z.x, 0,
+            x.y, y.y, z.y, 0,
+            x.z, y.z, z.z, 0,
+            0,   0,   0,   1
+        };
+        return Matrix4f(values);
+    }
 
     /// Generate an identity matrix
-    Matrix4f MatrixIdentity();
+    inline SIMPLETON_CONSTEXPR Matrix4f MatrixIdentity() { return Matrix4f::Identity(); }
 
     /// If matrix is non-invertible, returns a zero matrix
     Matrix4f Inverse( const Matrix4f& rM );
 
+    /// Inverse of a matrix whose bottom row is (0,0,0,1).  Much cheaper than the general one.
+    ///  If matrix is non-invertible, returns a zero matrix
+    Matrix4f AffineInverse( const Matrix4f& rM );
+
     /// Transforms a point (w=1) by a matrix, multiplying from the right
     Vec3f AffineTransformPoint( const Matrix4f& rM, const Vec3f& P );
     
@@ -213,6 +291,27 @@ namespace Simpleton
 
     /// Transforms a direction (w=0) by the TRANSPOSE of a matrix, multiplying from the left
     Vec3f AffineTransformNormal( const Matrix4f& rM, const Vec3f& P );
+
+    //=====================================================================================================================
+    //  Batch transforms.
+    //
+    //   The strided forms take byte strides, so that they can pick vectors out of larger vertex structs.
+    //   The SoA forms take separate x,y,z arrays.  Either way, input and output may be the same arrays.
+    //   Normals transform by the transpose, as above.  Pass the inverse matrix, as you would to AffineTransformNormal.
+    //=====================================================================================================================
+
+    void AffineTransformPoints( const Matrix4f& rM, Vec3f* pOut, size_t nOutStride, const Vec3f* pIn, size_t nInStride, size_t nCount );
+    void AffineTransformDirections( const Matrix4f& rM, Vec3f* pOut, size_t nOutStride, const Vec3f* pIn, size_t nInStride, size_t nCount );
+    void AffineTransformNormals( const Matrix4f& rM, Vec3f* pOut, size_t nOutStride, const Vec3f* pIn, size_t nInStride, size_t nCount,
+                                 bool bNormalize=false );
+    void TransformPoints( const Matrix4f& rM, Vec3f* pOut, size_t nOutStride, const Vec3f* pIn, size_t nInStride, size_t nCount );
+
+    void AffineTransformPointsSoA( const Matrix4f& rM, float* pOutX, float* pOutY, float* pOutZ,
+                                   const float* pX, const float* pY, const float* pZ, size_t nCount );
+    void AffineTransformDirectionsSoA( const Matrix4f& rM, float* pOutX, float* pOutY, float* pOutZ,
+                                       const float* pX, const float* pY, const float* pZ, size_t nCount );
+    void AffineTransformNormalsSoA( const Matrix4f& rM, float* pOutX, float* pOutY, float* pOutZ,
+                                    const float* pX, const float* pY, const float* pZ, size_t nCount, bool bNormalize=false );
  
     
 }
@@ -16,9 +16,15 @@
 #define _SIMPLETON_MESH_H_
 
 #include <math.h>
+#include <stddef.h>
+#include <vector>
+
+#include "Types.h"
 
 namespace Simpleton
 {
+    class ThreadPool;
+
     template< class PositionAccessor_T, class Index_T, class NormalWriter_T >
     void ComputeFaceNormals( const Index_T* pIndices, unsigned int nTriangles, PositionAccessor_T GetPosition, NormalWriter_T WriteNormal )
     {
@@ -53,6 +59,8 @@ namespace Simpleton
         }
     }
 
+    /// Scatter-based vertex normals, through arbitrary accessors.  For large meshes with float positions,
+    ///  prefer the overloads which take strided arrays, below
     template< class Index_T, class PositionAccessor_T, class NormalReader_T, class NormalWriter_T >
     void ComputeVertexNormals( const Index_T* pIndices, unsigned int nTriangles, unsigned int nVertices,
                                PositionAccessor_T GetPosition, NormalReader_T ReadNormal, NormalWriter_T WriteNormal )
@@ -119,6 +127,105 @@ namespace Simpleton
     }
 
 
+    //=====================================================================================================================
+    /// \ingroup Simpleton
+    /// \brief Vertex-to-face adjacency, in compressed sparse row form
+    ///
+    ///   Stores, for each vertex, the triangle corners which reference it.  Corner c is vertex (c%3) of triangle c/3.
+    ///    Each vertex's corners are sorted, so the adjacency is the same no matter how it was built.
+    ///
+    //=====================================================================================================================
+    class VertexFaceAdjacency
+    {
+    public:
+
+        void Build( const uint32* pIndices, uint32 nTriangles, uint32 nVertices );
+
+        /// Multi-threaded version of 'Build'.  Produces identical output
+        void Build( ThreadPool& pool, const uint32* pIndices, uint32 nTriangles, uint32 nVertices );
+
+        uint32 GetVertexCount() const { return m_Offsets.empty() ? 0 : (uint32)(m_Offsets.size()-1); }
+
+        /// Number of triangle corners which reference vertex 'v'
+        uint32 GetCornerCount( uint32 v ) const { return m_Offsets[v+1] - m_Offsets[v]; }
+
+        const uint32* GetCorners( uint32 v ) const { return m_Corners.data() + m_Offsets[v]; }
+
+    private:
+
+        std::vector<uint32> m_Offsets;  ///< Vertex v's corners are [m_Offsets[v], m_Offsets[v+1])
+        std::vector<uint32> m_Corners;
+    };
+
+
+    enum NormalWeighting
+    {
+        NORMAL_WEIGHT_AREA,     ///< Face normals are weighted by triangle area.  Same result as the accessor-based version
+        NORMAL_WEIGHT_ANGLE,    ///< Face normals are weighted by the angle at the vertex.  Insensitive to how a surface is triangulated
+    };
+
+    /// Computes normalized vertex normals from strided float3 positions.  Strides are in bytes.
+    ///   Each vertex's normal is gathered from its adjacent faces, in a fixed order, so results are deterministic.
+    ///   Vertices not referenced by any non-degenerate triangle get a zero normal.
+    void ComputeVertexNormals( float* pNormals, size_t nNormalStride,
+                               const float* pPositions, size_t nPositionStride,
+                               const uint32* pIndices, uint32 nTriangles, uint32 nVertices,
+                               NormalWeighting eWeighting=NORMAL_WEIGHT_AREA );
+
+    /// Multi-threaded version of 'ComputeVertexNormals'.  Produces identical output
+    void ComputeVertexNormals( ThreadPool& pool,
+                               float* pNormals, size_t nNormalStride,
+                               const float* pPositions, size_t nPositionStride,
+                               const uint32* pIndices, uint32 nTriangles, uint32 nVertices,
+                               NormalWeighting eWeighting=NORMAL_WEIGHT_AREA );
+
+
+    //=====================================================================================================================
+    /// \ingroup Simpleton
+    /// \brief Describes which parts of a vertex are compared by WeldVertices
+    ///
+    ///   Offsets and stride are in bytes.  Positions and normals are float3, UVs are float2.
+    ///
+    ///   Each attribute is snapped to a grid whose spacing is its tolerance, and vertices weld if all of their
+    ///    attributes land in the same cells.  This is transitive, which keeps the result independent of vertex order,
+    ///    but two values closer than the tolerance can still fall on either side of a cell boundary.
+    ///    A tolerance of zero requires exact equality (-0 and +0 are considered equal)
+    ///
+    //=====================================================================================================================
+    struct WeldFormat
+    {
+        enum
+        {
+            NO_ATTRIBUTE = 0xffffffff
+        };
+
+        WeldFormat( size_t stride, size_t positionOffset=0 )
+            : nStride(stride), nPositionOffset(positionOffset), nNormalOffset(NO_ATTRIBUTE), nUVOffset(NO_ATTRIBUTE),
+              fPositionTolerance(0), fNormalTolerance(0), fUVTolerance(0)
+        {
+        }
+
+        size_t nStride;
+        size_t nPositionOffset;
+        size_t nNormalOffset;   ///< Set to NO_ATTRIBUTE to weld vertices regardless of normal
+        size_t nUVOffset;       ///< Set to NO_ATTRIBUTE to weld vertices regardless of UV
+
+        float fPositionTolerance;
+        float fNormalTolerance;
+        float fUVTolerance;
+    };
+
+    /// Merges equivalent vertices.  Writes a table which maps each input vertex to its output vertex, and a compacted
+    ///   copy of the vertices, in which each group is represented by its first member.  Group order follows
+    ///   input order.  'pVerticesOut' may be NULL if only the table is wanted.  It may not alias the input.
+    ///   Returns the number of output vertices.  Use RemapIndices (MeshOptimize.h) to rewrite index buffers.
+    ///   Vertex count must be below 2^31.
+    uint32 WeldVertices( uint32* pRemap, void* pVerticesOut, const void* pVertices, uint32 nVertices, const WeldFormat& format );
+
+    /// Multi-threaded version of 'WeldVertices'.  Produces identical output
+    uint32 WeldVertices( ThreadPool& pool, uint32* pRemap, void* pVerticesOut, const void* pVertices, uint32 nVertices, const WeldFormat& format );
+
+
     inline void ExpandTriangleStrip( uint* pList, const uint* pStrip, uint nTriangles )
     {
         pList[0] = pStrip[0];
@@ -0,0 +1,75 @@
+//=====================================================================================================================
+//
+//   MeshOptimize.h
+//
+//   Index and vertex buffer reordering, for GPU vertex cache and overdraw efficiency
+//
+//   The lazy man's utility library
+//   Joshua Barczak
+//   Copyright 2016 Joshua Barczak
+//
+//   LICENSE:  See Doc\License.txt for terms and conditions
+//
+//   The usual order of operations is:
+//       OptimizeVertexCache  -> OptimizeOverdraw (optional) -> OptimizeVertexFetch
+//
+//   Each step preserves triangle winding.  Unless noted otherwise, outputs may be the same array as inputs.
+//
+//=====================================================================================================================
+
+#ifndef _MESH_OPTIMIZE_H_
+#define _MESH_OPTIMIZE_H_
+
+#include "Types.h"
+#include <stddef.h>
+
+namespace Simpleton
+{
+    enum
+    {
+        UNUSED_VERTEX = 0xffffffff  ///< Remap table entry for a vertex which is not referenced by any triangle
+    };
+
+    /// Reorders triangles for post-transform cache locality, using Forsyth's "linear speed vertex cache optimisation".
+    ///   Results are good for any LRU or FIFO cache of 16-32 entries.  The index buffer must not contain indices >= nVertices
+    void OptimizeVertexCache( uint32* pIndicesOut, const uint32* pIndices, uint32 nTriangles, uint32 nVertices );
+
+    /// Reorders clusters of triangles so that outward-facing ones tend to be drawn first, as described by
+    ///  Sander, Nehab and Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw".
+    ///
+    ///   Input should already be cache-optimized.  Clusters are split where the cache would be flushed anyway,
+    ///    and at other points as long as the ACMR stays within 'fThreshold' times the original.  Position stride is in bytes.
+    ///    Output may not alias the input.
+    void OptimizeOverdraw( uint32* pIndicesOut, const uint32* pIndices, uint32 nTriangles,
+                           const float* pPositions, size_t nPositionStride, uint32 nVertices,
+                           float fThreshold=1.05f );
+
+    /// Builds a table which renumbers vertices in order of first use by the index buffer.  Unused vertices are
+    ///  mapped to UNUSED_VERTEX.  Returns the number of used vertices
+    uint32 BuildVertexFetchRemap( uint32* pRemap, const uint32* pIndices, uint32 nTriangles, uint32 nVertices );
+
+    /// pIndicesOut[i] = pRemap[ pIndices[i] ]
+    void RemapIndices( uint32* pIndicesOut, const uint32* pIndices, size_t nIndices, const uint32* pRemap );
+
+    /// Moves each vertex 'i' to slot pRemap[i], dropping vertices which map to UNUSED_VERTEX.  If several vertices map
+    ///  to the same slot, the last one wins.  Call once per vertex stream.  Output may not alias the input
+    void RemapVertices( void* pVerticesOut, const void* pVertices, uint32 nVertices, size_t nVertexSize, const uint32* pRemap );
+
+    /// Reorders a vertex buffer by first use, and rewrites the index buffer to match.  Unused vertices are dropped.
+    ///   Returns the new vertex count.  The vertex output may not alias the input
+    uint32 OptimizeVertexFetch( void* pVerticesOut, uint32* pIndices, uint32 nTriangles,
+                                const void* pVertices, uint32 nVertices, size_t nVertexSize );
+
+
+    struct VertexCacheStatistics
+    {
+        uint32 nVerticesTransformed;    ///< Number of cache misses
+        float fACMR;    ///< Average cache miss ratio:  transforms per triangle.  3 is worst, ~0.5 is best for regular grids
+        float fATVR;    ///< Average transform to vertex ratio:  transforms per referenced vertex.  1 is best
+    };
+
+    /// Simulates a FIFO post-transform cache, to measure the effect of reordering without a GPU
+    VertexCacheStatistics AnalyzeVertexCache( const uint32* pIndices, uint32 nTriangles, uint32 nVertices, uint32 nCacheSize=16 );
+}
+
+#endif // _MESH_OPTIMIZE_H_
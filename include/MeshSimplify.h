@@ -0,0 +1,89 @@
+//=====================================================================================================================
+//
+//   MeshSimplify.h
+//
+//   Quadric error metric mesh simplification
+//
+//   The lazy man's utility library
+//   Joshua Barczak
+//   Copyright 2016 Joshua Barczak
+//
+//   LICENSE:  See Doc\License.txt for terms and conditions
+//
+//   The simplifier uses half-edge collapses (a vertex is merged into one of its neighbors), scored by Garland and
+//    Heckbert's quadric error metric.  No new vertices are created, so every attribute of the surviving vertices
+//    stays valid, and the output index buffer can be used with the original vertex buffer.
+//
+//   Vertices which share a position and match in every attribute are merged, so unwelded meshes simplify normally.
+//    Vertices which share a position but have different attributes (normal, UV and color seams) only move in
+//    pairs, one from each side, along the seam.  Where seams meet, they are never moved.  Vertices on open borders
+//    only slide along the border.  Vertices on non-manifold geometry are never moved.
+//
+//   The versions which take plain positions can't see any other attributes, and merge every pair of vertices
+//    with equal positions.  Meshes with attribute seams should use the versions which take a WeldFormat.
+//
+//   Errors are expressed relative to the size of the mesh:  0.01 means 1% of the largest bounding box dimension.
+//
+//=====================================================================================================================
+
+#ifndef _MESH_SIMPLIFY_H_
+#define _MESH_SIMPLIFY_H_
+
+#include "Types.h"
+#include <stddef.h>
+
+namespace Simpleton
+{
+    class ThreadPool;
+    struct PlyMesh;
+    struct WeldFormat;
+
+    /// Simplifies an indexed triangle list until it reaches 'nTargetTriangles', or until the next collapse would cause
+    ///  more than 'fTargetError' of error.  Position stride is in bytes.
+    ///
+    ///  Returns the number of triangles written to 'pIndicesOut', which must have room for the input triangle count.
+    ///   'pIndicesOut' may be the same array as 'pIndices'.
+    ///
+    ///  \param pResultError       If not NULL, receives the largest error of any collapse that was made
+    ///  \param pSourceTriangles   If not NULL, receives the input triangle that each output triangle came from.
+    ///                              Useful for carrying per-face data along
+    uint32 SimplifyMesh( uint32* pIndicesOut, const uint32* pIndices, uint32 nTriangles,
+                         const float* pPositions, size_t nPositionStride, uint32 nVertices,
+                         uint32 nTargetTriangles, float fTargetError,
+                         float* pResultError=0, uint32* pSourceTriangles=0 );
+
+    /// Cluster-parallel version of 'SimplifyMesh', for meshes which are too large to collapse serially.
+    ///
+    ///  The mesh is split into spatial clusters, which are simplified independently, with the vertices between them
+    ///   locked.  A final serial pass then simplifies the whole mesh, which removes the extra detail left along the
+    ///   cluster boundaries.  Quadrics carry over from the clusters to the final pass, so errors are still measured
+    ///   against the input mesh.  The result is deterministic, but it is not the same as the serial version's.
+    uint32 SimplifyMesh( ThreadPool& pool,
+                         uint32* pIndicesOut, const uint32* pIndices, uint32 nTriangles,
+                         const float* pPositions, size_t nPositionStride, uint32 nVertices,
+                         uint32 nTargetTriangles, float fTargetError,
+                         float* pResultError=0, uint32* pSourceTriangles=0 );
+
+    /// Version of 'SimplifyMesh' which finds seams by comparing the attributes in 'format', as WeldVertices does.
+    ///  Tolerances apply as they do there.  Output indices refer to the first of each set of merged vertices
+    uint32 SimplifyMesh( uint32* pIndicesOut, const uint32* pIndices, uint32 nTriangles,
+                         const void* pVertices, uint32 nVertices, const WeldFormat& format,
+                         uint32 nTargetTriangles, float fTargetError,
+                         float* pResultError=0, uint32* pSourceTriangles=0 );
+
+    /// Cluster-parallel version of the WeldFormat 'SimplifyMesh'
+    uint32 SimplifyMesh( ThreadPool& pool,
+                         uint32* pIndicesOut, const uint32* pIndices, uint32 nTriangles,
+                         const void* pVertices, uint32 nVertices, const WeldFormat& format,
+                         uint32 nTargetTriangles, float fTargetError,
+                         float* pResultError=0, uint32* pSourceTriangles=0 );
+
+    /// Simplifies a mesh from LoadPly in place.  Normals, UVs and vertex colors are compared exactly to find seams.
+    ///  Face colors are carried along, and unused vertices are removed.  Returns the error of the simplified mesh
+    float SimplifyPlyMesh( PlyMesh& rMesh, uint32 nTargetTriangles, float fTargetError );
+
+    /// Cluster-parallel version of 'SimplifyPlyMesh'
+    float SimplifyPlyMesh( ThreadPool& pool, PlyMesh& rMesh, uint32 nTargetTriangles, float fTargetError );
+}
+
+#endif // _MESH_SIMPLIFY_H_
@@ -0,0 +1,101 @@
+//=====================================================================================================================
+//
+//   Meshlet.h
+//
+//   Splits triangle meshes into small clusters, with bounds for coarse culling
+//
+//   The lazy man's utility library
+//   Joshua Barczak
+//   Copyright 2016 Joshua Barczak
+//
+//   LICENSE:  See Doc\License.txt for terms and conditions
+//
+//   A meshlet is a small piece of a mesh, with a limited number of unique vertices and triangles.  Its triangles
+//    index into a local vertex list, which in turn indexes the original vertex buffer, so each meshlet can be
+//    processed independently, with all of its vertices in a small cache.  This is the layout used by mesh shaders.
+//
+//   Positions are strided float3.  For a PlyMesh, pass 'pPositions[0]' and 'sizeof(PlyMesh::Float3)'.
+//    For a TessVertex array, pass '&vb[0].vPos.x' and 'sizeof(TessVertex)'.
+//
+//=====================================================================================================================
+
+#ifndef _MESHLET_H_
+#define _MESHLET_H_
+
+#include "Types.h"
+#include "VectorMath.h"
+#include <stddef.h>
+#include <vector>
+
+namespace Simpleton
+{
+    class ThreadPool;
+
+    enum
+    {
+        MESHLET_MAX_VERTICES  = 256,    ///< Local indices are 8 bits
+        MESHLET_MAX_TRIANGLES = 512,
+    };
+
+    struct Meshlet
+    {
+        uint32 nVertexOffset;       ///< First entry in 'MeshletMesh::Vertices'
+        uint32 nTriangleOffset;     ///< First entry in 'MeshletMesh::Triangles'.  Counted in bytes, three per triangle
+        uint32 nVertexCount;
+        uint32 nTriangleCount;
+
+        Vec3f vCenter;              ///< Bounding sphere
+        float fRadius;
+
+        /// Normal cone.  Every triangle faces away from any eye point inside the cone with apex 'vConeApex', axis
+        ///  'vConeAxis' and a half-angle whose cosine is 'fConeCutoff'.  A cutoff of 1 means the meshlet can't be culled
+        Vec3f vConeApex;
+        Vec3f vConeAxis;
+        float fConeCutoff;
+    };
+
+    struct MeshletMesh
+    {
+        std::vector<Meshlet> Meshlets;
+        std::vector<uint32>  Vertices;   ///< Indices into the original vertex buffer
+        std::vector<uint8>   Triangles;  ///< Indices into each meshlet's vertex list
+    };
+
+    /// Splits an indexed triangle list into meshlets.  Position stride is in bytes.  Triangle winding is preserved.
+    ///
+    ///  Triangles are ordered along a Morton curve, and meshlets are grown from that order by adding the neighboring
+    ///   triangle which needs the fewest new vertices.  Limits may not exceed MESHLET_MAX_VERTICES and MESHLET_MAX_TRIANGLES.
+    ///   The defaults suit common mesh shader hardware
+    void BuildMeshlets( MeshletMesh& rMeshlets, const uint32* pIndices, uint32 nTriangles,
+                        const float* pPositions, size_t nPositionStride, uint32 nVertices,
+                        uint32 nMaxVertices=64, uint32 nMaxTriangles=124 );
+
+    /// Multi-threaded version of 'BuildMeshlets'.  Produces identical output
+    void BuildMeshlets( ThreadPool& pool,
+                        MeshletMesh& rMeshlets, const uint32* pIndices, uint32 nTriangles,
+                        const float* pPositions, size_t nPositionStride, uint32 nVertices,
+                        uint32 nMaxVertices=64, uint32 nMaxTriangles=124 );
+
+    /// True if every triangle of the meshlet faces away from an eye at 'vEye'.  Front faces are counter-clockwise,
+    ///  when seen from the side their normal points to, with normal = (P1-P0)x(P2-P0)
+    inline bool IsMeshletBackfacing( const Meshlet& m, const Vec3f& vEye )
+    {
+        Vec3f D = m.vConeApex - vEye;
+        return Dot3( D, m.vConeAxis ) > m.fConeCutoff * Length3( D );
+    }
+
+    /// True if the meshlet's bounding sphere is entirely outside any of the given planes.
+    ///  Planes are packed float4s (a,b,c,d), with inside being a*x+b*y+c*z+d >= 0, as from a frustum
+    inline bool IsMeshletOutside( const Meshlet& m, const float* pPlanes, uint nPlanes )
+    {
+        for( uint i=0; i<nPlanes; i++ )
+        {
+            const float* P = pPlanes + 4*i;
+            if( P[0]*m.vCenter.x + P[1]*m.vCenter.y + P[2]*m.vCenter.z + P[3] < -m.fRadius )
+                return true;
+        }
+        return false;
+    }
+}
+
+#endif // _MESHLET_H_
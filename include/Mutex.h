@@ -15,6 +15,9 @@
 #ifndef _MUTEX_H_
 #define _MUTEX_H_
 
+#ifndef WIN32
+    #include <pthread.h>
+#endif
 
 namespace Simpleton
 {
@@ -42,10 +45,21 @@ namespace Simpleton
     
     private:
 
+        Mutex( const Mutex& );
+        Mutex& operator=( const Mutex& );
+
+    #ifdef WIN32
         // so we don't have to #include <windows.h>, with all its namespace pollution, in the header
         // This is a tad ugly, but should be stable
+    #ifdef _WIN64
+        static const int SIZEOF_CRITICAL_SECTION = 40;
+    #else
         static const int SIZEOF_CRITICAL_SECTION = 24;
+    #endif
         unsigned char m_criticalSection[SIZEOF_CRITICAL_SECTION];
+    #else
+        pthread_mutex_t m_mutex;
+    #endif
     };
     
     
@@ -0,0 +1,292 @@
+//=====================================================================================================================
+//
+//   ObjectPool.h
+//
+//   Definition of class: Simpleton::ObjectPool
+//
+//   The lazy man's utility library
+//   Joshua Barczak
+//   Copyright 2016 Joshua Barczak
+//
+//   LICENSE:  See Doc\License.txt for terms and conditions
+//
+//=====================================================================================================================
+
+#ifndef _OBJECT_POOL_H_
+#define _OBJECT_POOL_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+#include <new>
+#include <utility>
+#include <type_traits>
+#include "SpinLock.h"
+#include "LockFreeStack.h"
+
+namespace Simpleton
+{
+
+    //=====================================================================================================================
+    /// \ingroup Simpleton
+    /// \brief Thread-safe fixed-size allocator for objects of one type
+    ///
+    ///   Storage is carved out of large slabs.  Free slots are kept on a LockFreeStack, threaded through the
+    ///    slots themselves, so allocation and release are a single CAS each.  Slabs are only returned to the system
+    ///    when the pool is destroyed.
+    ///
+    ///   Threads that allocate heavily can go through a ThreadCache, which keeps a small private free list and only
+    ///    touches the shared one when that runs dry or overflows.
+    ///
+    ///   The pool does not keep track of which slots are in use.  Destroying the pool does not destroy live objects.
+    ///
+    //=====================================================================================================================
+    template< class T >
+    class ObjectPool
+    {
+    public:
+
+        class ThreadCache;
+
+        ObjectPool( size_t nSlotsPerSlab=256 ) :
+            m_nSlotsPerSlab( nSlotsPerSlab ? nSlotsPerSlab : 1 ),
+            m_nLive(0),
+            m_nHighWater(0),
+            m_nCapacity(0)
+        {
+        }
+
+        ~ObjectPool()
+        {
+            for( size_t i=0; i<m_Slabs.size(); i++ )
+                free( m_Slabs[i] );
+        }
+
+        /// Returns uninitialized storage for one T, or NULL if a new slab could not be allocated
+        void* Allocate()
+        {
+            LockFreeStack::Node* pNode = m_FreeSlots.pop_front();
+            if( !pNode )
+            {
+                pNode = Grow();
+                if( !pNode )
+                    return 0;
+            }
+
+            AddLive( 1 );
+            return pNode;
+        }
+
+        /// Returns storage to the pool.  Any thread may free slots allocated by any other
+        void Free( void* p )
+        {
+            m_FreeSlots.push_front( static_cast<LockFreeStack::Node*>(p) );
+            m_nLive.fetch_sub( 1, std::memory_order_relaxed );
+        }
+
+        template< class... Args_T >
+        T* New( Args_T&&... args )
+        {
+            void* pStorage = Allocate();
+            return pStorage ? new( pStorage ) T( std::forward<Args_T>(args)... ) : 0;
+        }
+
+        void Delete( T* p )
+        {
+            p->~T();
+            Free(p);
+        }
+
+        /// Number of slots which are allocated.  Slots sitting in thread caches count as allocated
+        size_t GetLiveCount() const { return m_nLive.load( std::memory_order_relaxed ); }
+
+        /// Largest value that the live count has ever had
+        size_t GetHighWaterMark() const { return m_nHighWater.load( std::memory_order_relaxed ); }
+
+        /// Total number of slots in all slabs
+        size_t GetCapacity() const { return m_nCapacity.load( std::memory_order_relaxed ); }
+
+    private:
+
+        ObjectPool( const ObjectPool& );
+        ObjectPool& operator=( const ObjectPool& );
+
+        enum
+        {
+            SLOT_ALIGN = std::alignment_of<T>::value > sizeof(void*) ? std::alignment_of<T>::value : sizeof(void*),
+            SLOT_SIZE  = ( ( sizeof(T) > sizeof(LockFreeStack::Node) ? sizeof(T) : sizeof(LockFreeStack::Node) )
+                            + SLOT_ALIGN-1 ) & ~(SLOT_ALIGN-1)
+        };
+
+        /// Allocates a new slab.  The first slot goes to the caller, the rest go on the free list
+        /// \return NULL if the slab could not be allocated
+        LockFreeStack::Node* Grow()
+        {
+            char* pSlab = (char*) malloc( m_nSlotsPerSlab*SLOT_SIZE + SLOT_ALIGN );
+            if( !pSlab )
+                return 0;
+
+            char* pSlots = (char*)( ((uintptr_t)pSlab + SLOT_ALIGN-1) & ~(uintptr_t)(SLOT_ALIGN-1) );
+
+            m_SlabLock.Take();
+            m_Slabs.push_back( pSlab );
+            m_SlabLock.Release();
+
+            m_nCapacity.fetch_add( m_nSlotsPerSlab, std::memory_order_relaxed );
+
+            if( m_nSlotsPerSlab > 1 )
+            {
+                for( size_t i=1; i<m_nSlotsPerSlab-1; i++ )
+                    LockFreeStack::Link( Slot(pSlots,i), Slot(pSlots,i+1) );
+                m_FreeSlots.push_chain( Slot(pSlots,1), Slot(pSlots,m_nSlotsPerSlab-1) );
+            }
+
+            return Slot(pSlots,0);
+        }
+
+        static LockFreeStack::Node* Slot( char* pSlots, size_t i )
+        {
+            return reinterpret_cast<LockFreeStack::Node*>( pSlots + i*SLOT_SIZE );
+        }
+
+        void AddLive( size_t n )
+        {
+            size_t nLive = m_nLive.fetch_add( n, std::memory_order_relaxed ) + n;
+            size_t nHigh = m_nHighWater.load( std::memory_order_relaxed );
+            while( nLive > nHigh && !m_nHighWater.compare_exchange_weak( nHigh, nLive, std::memory_order_relaxed ) )
+                ;
+        }
+
+        size_t m_nSlotsPerSlab;
+        LockFreeStack m_FreeSlots;
+
+        SpinLock m_SlabLock;
+        std::vector<char*> m_Slabs;
+
+        std::atomic<size_t> m_nLive;
+        std::atomic<size_t> m_nHighWater;
+        std::atomic<size_t> m_nCapacity;
+    };
+
+
+    //=====================================================================================================================
+    /// \ingroup Simpleton
+    /// \brief Per-thread front end to an ObjectPool
+    ///
+    ///   Keeps up to 2*BATCH_SIZE free slots privately.  Refills take up to BATCH_SIZE slots from the pool,
+    ///    and overflows hand BATCH_SIZE slots back in a single push.
+    ///
+    ///   A ThreadCache may only be used by one thread at a time.  Slots allocated through one cache may be freed through
+    ///    another cache, or directly to the pool.  Remaining slots are returned to the pool when the cache is destroyed.
+    ///
+    //=====================================================================================================================
+    template< class T >
+    class ObjectPool<T>::ThreadCache
+    {
+    public:
+
+        enum
+        {
+            BATCH_SIZE = 32
+        };
+
+        ThreadCache( ObjectPool<T>& pool ) : m_rPool(pool), m_nCount(0)
+        {
+        }
+
+        ~ThreadCache()
+        {
+            Flush( m_nCount );
+        }
+
+        /// Returns NULL if the cache and the pool are both empty, and a new slab could not be allocated
+        void* Allocate()
+        {
+            if( !m_nCount && !Refill() )
+                return 0;
+
+            m_nCount--;
+            return m_Slots.pop_front_serial();
+        }
+
+        void Free( void* p )
+        {
+            m_Slots.push_front_serial( static_cast<LockFreeStack::Node*>(p) );
+            if( ++m_nCount >= 2*BATCH_SIZE )
+                Flush( BATCH_SIZE );
+        }
+
+        template< class... Args_T >
+        T* New( Args_T&&... args )
+        {
+            void* pStorage = Allocate();
+            return pStorage ? new( pStorage ) T( std::forward<Args_T>(args)... ) : 0;
+        }
+
+        void Delete( T* p )
+        {
+            p->~T();
+            Free(p);
+        }
+
+    private:
+
+        ThreadCache( const ThreadCache& );
+        ThreadCache& operator=( const ThreadCache& );
+
+        /// \return False if no slots could be had
+        bool Refill()
+        {
+            // slots in the cache count as live, so that the pool's stats stay consistent without going through the cache
+            size_t n=0;
+            while( n < BATCH_SIZE )
+            {
+                LockFreeStack::Node* pNode = m_rPool.m_FreeSlots.pop_front();
+                if( !pNode )
+                    break;
+                m_Slots.push_front_serial(pNode);
+                n++;
+            }
+
+            if( !n )
+            {
+                LockFreeStack::Node* pNode = m_rPool.Grow();
+                if( !pNode )
+                    return false;
+                m_Slots.push_front_serial( pNode );
+                n++;
+            }
+
+            m_rPool.AddLive(n);
+            m_nCount += n;
+            return true;
+        }
+
+        void Flush( size_t n )
+        {
+            if( !n )
+                return;
+
+            LockFreeStack::Node* pFirst = m_Slots.pop_front_serial();
+            LockFreeStack::Node* pLast = pFirst;
+            for( size_t i=1; i<n; i++ )
+            {
+                LockFreeStack::Node* pNode = m_Slots.pop_front_serial();
+                LockFreeStack::Link( pLast, pNode );
+                pLast = pNode;
+            }
+
+            m_rPool.m_FreeSlots.push_chain( pFirst, pLast );
+            m_rPool.m_nLive.fetch_sub( n, std::memory_order_relaxed );
+            m_nCount -= n;
+        }
+
+        ObjectPool<T>& m_rPool;
+        LockFreeStack m_Slots;
+        size_t m_nCount;
+    };
+
+}
+
+#endif // _OBJECT_POOL_H_
@@ -0,0 +1,374 @@
+//=====================================================================================================================
+//
+//   Parallel.h
+//
+//   Parallel loops and task graphs, layered on Simpleton::ThreadPool
+//
+//   The lazy man's utility library
+//   Joshua Barczak
+//   Copyright 2016 Joshua Barczak
+//
+//   LICENSE:  See Doc\License.txt for terms and conditions
+//
+//=====================================================================================================================
+
+#ifndef _PARALLEL_H_
+#define _PARALLEL_H_
+
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include "Types.h"
+#include "ThreadPool.h"
+
+namespace Simpleton
+{
+    //=====================================================================================================================
+    /// \brief Adapts a functor into a WorkItem.
+    ///
+    ///  The work item is a value type, so it can live on the stack (or in an array) without a heap allocation per task
+    ///   Use 'MakeWorkItem' to deduce the functor type from a lambda.
+    //=====================================================================================================================
+    template< class Func_T >
+    class LambdaWorkItem : public WorkItem
+    {
+    public:
+        LambdaWorkItem( const Func_T& fn ) : m_Func(fn) {}
+        virtual void Do() { m_Func(); }
+    private:
+        Func_T m_Func;
+    };
+
+    template< class Func_T >
+    inline LambdaWorkItem<Func_T> MakeWorkItem( const Func_T& fn ) { return LambdaWorkItem<Func_T>(fn); }
+
+
+    namespace _INTERNAL
+    {
+        //=====================================================================================================================
+        /// Shared state for a single parallel loop.  Lives on the calling thread's stack.
+        ///   Chunks of 'grain' iterations are handed out dynamically through an atomic counter.
+        ///   A fixed number of helper items is pushed into the pool, each of which pulls chunks until they run out
+        //=====================================================================================================================
+        template< class Func_T >
+        class ParallelForJob
+        {
+        public:
+
+            enum
+            {
+                MAX_HELPERS = 64
+            };
+
+            ParallelForJob( size_t nBegin, size_t nEnd, size_t nGrain, const Func_T& fn )
+                : m_nBegin(nBegin), m_nEnd(nEnd), m_nGrain(nGrain),
+                  m_nChunks( (nEnd-nBegin+nGrain-1)/nGrain ),
+                  m_nNextChunk(0), m_nHelpers(0), m_nHelpersDone(0), m_pPool(0), m_rFunc(fn)
+            {
+                for( size_t i=0; i<MAX_HELPERS; i++ )
+                    m_Helpers[i].pJob = this;
+            }
+
+            void Run( ThreadPool& pool )
+            {
+                // one helper per worker is enough.  The calling thread makes one more
+                size_t nHelpers = pool.GetWorkerCount();
+                if( nHelpers > MAX_HELPERS )
+                    nHelpers = MAX_HELPERS;
+                if( nHelpers > m_nChunks-1 )
+                    nHelpers = m_nChunks-1;
+
+                m_pPool = &pool;
+                m_nHelpers = nHelpers;
+                for( size_t i=0; i<nHelpers; i++ )
+                    pool.PushWork( &m_Helpers[i] );
+
+                DoChunks();
+
+                // the helpers live on our stack, so we cannot leave until all of them have run, even the ones that found nothing to do
+                pool.WorkUntil( [this,nHelpers]() { return m_nHelpersDone.load( std::memory_order_acquire ) == nHelpers; } );
+            }
+
+        private:
+
+            class Helper : public WorkItem
+            {
+            public:
+                virtual void Do()
+                {
+                    pJob->DoChunks();
+
+                    // the job may be gone as soon as the count is bumped, so read what we need first
+                    ThreadPool* pPool = pJob->m_pPool;
+                    size_t nHelpers = pJob->m_nHelpers;
+                    if( pJob->m_nHelpersDone.fetch_add( 1, std::memory_order_release ) + 1 == nHelpers )
+                        pPool->NotifyWaiters();
+                }
+                ParallelForJob* pJob;
+            };
+
+            void DoChunks()
+            {
+                for(;;)
+                {
+                    size_t nChunk = m_nNextChunk.fetch_add( 1, std::memory_order_relaxed );
+                    if( nChunk >= m_nChunks )
+                        return;
+
+                    size_t i0 = m_nBegin + nChunk*m_nGrain;
+                    size_t i1 = (m_nEnd - i0 > m_nGrain) ? i0 + m_nGrain : m_nEnd;
+                    m_rFunc( i0, i1 );
+                }
+            }
+
+            ParallelForJob( const ParallelForJob& );
+            ParallelForJob& operator=( const ParallelForJob& );
+
+            size_t m_nBegin;
+            size_t m_nEnd;
+            size_t m_nGrain;
+            size_t m_nChunks;
+            std::atomic<size_t> m_nNextChunk;
+            size_t m_nHelpers;
+            std::atomic<size_t> m_nHelpersDone;
+            ThreadPool* m_pPool;
+            const Func_T& m_rFunc;
+            Helper m_Helpers[MAX_HELPERS];
+        };
+    }
+
+    //=====================================================================================================================
+    /// Runs fn(i0,i1) over consecutive sub-ranges of [nBegin,nEnd), each at most 'nGrain' iterations long
+    ///
+    ///  The calling thread takes part in the loop, and does not return until every chunk is finished.
+    ///   It is safe to call this from inside a work item running on the same pool.
+    ///   No heap allocations are made.
+    //=====================================================================================================================
+    template< class Func_T >
+    void ParallelForChunked( ThreadPool& pool, size_t nBegin, size_t nEnd, size_t nGrain, const Func_T& fn )
+    {
+        if( nEnd <= nBegin )
+            return;
+        if( nGrain == 0 )
+            nGrain = 1;
+
+        if( pool.GetWorkerCount() == 0 || nEnd - nBegin <= nGrain )
+        {
+            fn( nBegin, nEnd );
+            return;
+        }
+
+        _INTERNAL::ParallelForJob<Func_T> job( nBegin, nEnd, nGrain, fn );
+        job.Run( pool );
+    }
+
+    //=====================================================================================================================
+    /// Runs fn(i) for every i in [nBegin,nEnd).  Iterations are handed out to threads 'nGrain' at a time
+    //=====================================================================================================================
+    template< class Func_T >
+    void ParallelFor( ThreadPool& pool, size_t nBegin, size_t nEnd, size_t nGrain, const Func_T& fn )
+    {
+        ParallelForChunked( pool, nBegin, nEnd, nGrain,
+                            [&fn]( size_t i0, size_t i1 )
+                            {
+                                for( size_t i=i0; i<i1; i++ )
+                                    fn(i);
+                            } );
+    }
+
+    //=====================================================================================================================
+    /// Parallel map-reduce over [nBegin,nEnd)
+    ///
+    ///  Map(i0,i1) is called on each chunk and returns a partial result.  Partials are combined with Reduce(a,b),
+    ///    in chunk order, so the result is deterministic even if Reduce is not associative (e.g., float addition)
+    ///
+    ///  This allocates storage for one partial result per chunk
+    //=====================================================================================================================
+    template< class T, class Map_T, class Reduce_T >
+    T ParallelReduce( ThreadPool& pool, size_t nBegin, size_t nEnd, size_t nGrain, const T& identity, const Map_T& Map, const Reduce_T& Reduce )
+    {
+        if( nEnd <= nBegin )
+            return identity;
+        if( nGrain == 0 )
+            nGrain = 1;
+
+        size_t nChunks = (nEnd-nBegin+nGrain-1)/nGrain;
+        std::vector<T> partials( nChunks, identity );
+        ParallelForChunked( pool, nBegin, nEnd, nGrain,
+                            [&]( size_t i0, size_t i1 )
+                            {
+                                partials[ (i0-nBegin)/nGrain ] = Map(i0,i1);
+                            } );
+
+        T result = identity;
+        for( size_t i=0; i<nChunks; i++ )
+            result = Reduce( result, partials[i] );
+        return result;
+    }
+
+
+    //=====================================================================================================================
+    /// \ingroup Simpleton
+    /// \brief A set of work items with dependencies between them
+    ///
+    ///   A task is dispatched to the pool once all of its predecessors have completed.  The graph must be acyclic.
+    ///    The work items are owned by the caller.  Graph storage is allocated up front, not per task,
+    ///     and a graph may be run any number of times.
+    ///
+    //=====================================================================================================================
+    class TaskGraph
+    {
+    public:
+
+        typedef uint TaskID;
+
+        TaskGraph() : m_pPool(0), m_nCompleted(0), m_bCompiled(false) {}
+
+        void Reserve( size_t nTasks, size_t nDependencies )
+        {
+            m_Tasks.reserve(nTasks);
+            m_Edges.reserve(nDependencies);
+        }
+
+        /// Adds a task to the graph.  The item must remain valid until the last call to 'Run' returns
+        TaskID AddTask( WorkItem* pWork )
+        {
+            Task t;
+            t.pWork = pWork;
+            t.pGraph = this;
+            t.nPredecessors = 0;
+            t.nFirstSuccessor = 0;
+            t.nSuccessors = 0;
+            m_Tasks.push_back(t);
+            m_bCompiled = false;
+            return (TaskID)( m_Tasks.size()-1 );
+        }
+
+        /// Declares that 'after' may not start until 'before' has completed
+        void AddDependency( TaskID before, TaskID after )
+        {
+            Edge e;
+            e.nFrom = before;
+            e.nTo   = after;
+            m_Edges.push_back(e);
+            m_Tasks[after].nPredecessors++;
+            m_bCompiled = false;
+        }
+
+        /// Executes the graph, using the calling thread as an additional worker.  Returns once every task has completed
+        void Run( ThreadPool& pool )
+        {
+            if( m_Tasks.empty() )
+                return;
+
+            if( !m_bCompiled )
+                Compile();
+
+            m_pPool = &pool;
+            m_nCompleted.store( 0, std::memory_order_relaxed );
+            for( size_t i=0; i<m_Tasks.size(); i++ )
+                m_pPending[i].store( m_Tasks[i].nPredecessors, std::memory_order_relaxed );
+
+            // everything above must be visible to whichever thread picks up a task
+            std::atomic_thread_fence( std::memory_order_release );
+
+            for( size_t i=0; i<m_Tasks.size(); i++ )
+            {
+                if( m_Tasks[i].nPredecessors == 0 )
+                    pool.PushWork( &m_Tasks[i] );
+            }
+
+            size_t nTasks = m_Tasks.size();
+            pool.WorkUntil( [this,nTasks]() { return m_nCompleted.load( std::memory_order_acquire ) == nTasks; } );
+            m_pPool = 0;
+        }
+
+        void Clear()
+        {
+            m_Tasks.clear();
+            m_Edges.clear();
+            m_bCompiled = false;
+        }
+
+    private:
+
+        class Task : public WorkItem
+        {
+        public:
+            virtual void Do()
+            {
+                pWork->Do();
+                pGraph->OnTaskComplete( this );
+            }
+
+            WorkItem* pWork;
+            TaskGraph* pGraph;
+            uint nPredecessors;
+            uint nFirstSuccessor;   ///< Offset into successor list
+            uint nSuccessors;
+        };
+
+        struct Edge
+        {
+            TaskID nFrom;
+            TaskID nTo;
+        };
+
+        /// Bucket the edges by source task, so each task can find its successors
+        void Compile()
+        {
+            for( size_t i=0; i<m_Tasks.size(); i++ )
+                m_Tasks[i].nSuccessors = 0;
+            for( size_t i=0; i<m_Edges.size(); i++ )
+                m_Tasks[m_Edges[i].nFrom].nSuccessors++;
+
+            uint nOffset=0;
+            for( size_t i=0; i<m_Tasks.size(); i++ )
+            {
+                m_Tasks[i].nFirstSuccessor = nOffset;
+                nOffset += m_Tasks[i].nSuccessors;
+                m_Tasks[i].nSuccessors = 0;
+            }
+
+            m_Successors.resize( m_Edges.size() );
+            for( size_t i=0; i<m_Edges.size(); i++ )
+            {
+                Task& t = m_Tasks[m_Edges[i].nFrom];
+                m_Successors[ t.nFirstSuccessor + t.nSuccessors++ ] = m_Edges[i].nTo;
+            }
+
+            m_pPending.reset( new std::atomic<uint>[ m_Tasks.size() ] );
+            m_bCompiled = true;
+        }
+
+        void OnTaskComplete( Task* pTask )
+        {
+            ThreadPool* pPool = m_pPool;
+            for( uint i=0; i<pTask->nSuccessors; i++ )
+            {
+                TaskID nNext = m_Successors[ pTask->nFirstSuccessor + i ];
+                if( m_pPending[nNext].fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+                    pPool->PushWork( &m_Tasks[nNext] );
+            }
+
+            // the last task to finish wakes up the thread in 'Run'
+            size_t nTasks = m_Tasks.size();
+            if( m_nCompleted.fetch_add( 1, std::memory_order_release ) + 1 == nTasks )
+                pPool->NotifyWaiters();
+        }
+
+        TaskGraph( const TaskGraph& );
+        TaskGraph& operator=( const TaskGraph& );
+
+        std::vector<Task> m_Tasks;
+        std::vector<Edge> m_Edges;
+        std::vector<TaskID> m_Successors;
+        std::unique_ptr< std::atomic<uint>[] > m_pPending;
+        ThreadPool* m_pPool;
+        std::atomic<size_t> m_nCompleted;
+        bool m_bCompiled;
+    };
+}
+
+#endif // _PARALLEL_H_
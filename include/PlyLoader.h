@@ -18,6 +18,8 @@
 
 namespace Simpleton
 {
+    class ThreadPool;
+
     enum PlyFlags
     {
         /// Rescale the mesh to fit in a unit box, and recenter so that lower bound is at y=0, and x/z are centered
@@ -72,6 +74,9 @@ namespace Simpleton
 
     bool LoadPly( const char* pFileName, PlyMesh& rMesh, unsigned int Flags );
 
+    /// Multi-threaded version of 'LoadPly'.  Parsing is serial, but post-processing (normal generation) uses the pool
+    bool LoadPly( ThreadPool& pool, const char* pFileName, PlyMesh& rMesh, unsigned int Flags );
+
     bool WritePly( const char* pFileName, PlyMesh& rMesh );
    
     void FreePly( PlyMesh& rMesh );
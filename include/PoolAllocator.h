@@ -16,13 +16,31 @@
 #ifndef _POOL_ALLOCATOR_H_
 #define _POOL_ALLOCATOR_H_
 
+#include <stddef.h>
+#include <new>
+#include <utility>
+#include <type_traits>
+#include "ChunkSource.h"
+
 namespace Simpleton
 {
     /// Simple block allocator which allocates storage in chunks and never releases any of it
     /// This is intended for aggregating large numbers of temporary allocs which are all released at once
     /// It is by no means a general purpose allocator.
+    ///
+    /// Allocations are made stack-wise.  'GetMarker' records the top of the stack, and 'RewindTo' pops
+    ///  everything allocated since then.  Blocks that are popped are kept around for re-use.
+    ///
+    /// Objects created with 'New' have their destructors run, in reverse order, when they are rewound,
+    ///   recycled, or freed.  Memory from 'GetA'/'GetSome'/'GetMore' is raw storage, and is simply dropped.
+    ///
+    /// Chunks come from a ChunkSource.  Big scratch arenas can use a large chunk size and a LargePageChunkSource.
     class PoolAllocator
     {
+    private:
+        struct AllocHeader;
+        struct DtorRecord;
+
     public:
 
         class ScopedFree
@@ -30,8 +48,8 @@ namespace Simpleton
         public:
             ScopedFree( PoolAllocator& alloc ) : m_rAlloc(alloc){}
             ~ScopedFree() { m_rAlloc.FreeAll(); };
-        private:        
-            PoolAllocator& m_rAlloc;        
+        private:
+            PoolAllocator& m_rAlloc;
         };
 
         class ScopedRecycler
@@ -39,42 +57,138 @@ namespace Simpleton
         public:
             ScopedRecycler( PoolAllocator& alloc ) : m_rAlloc(alloc){}
             ~ScopedRecycler() { m_rAlloc.Recycle(); };
-        private:        
-            PoolAllocator& m_rAlloc;        
+        private:
+            PoolAllocator& m_rAlloc;
         };
 
-        PoolAllocator() : m_pHead(0) {}
+        /// Position in the allocation stack
+        class Marker
+        {
+        private:
+            friend class PoolAllocator;
+            AllocHeader* pBlock;
+            size_t nOffset;
+            DtorRecord* pDtors;
+        };
+
+        /// Rewinds the allocator to wherever it was when the scope was entered
+        class ScopedRewind
+        {
+        public:
+            ScopedRewind( PoolAllocator& alloc ) : m_rAlloc(alloc), m_Marker(alloc.GetMarker()) {}
+            ~ScopedRewind() { m_rAlloc.RewindTo(m_Marker); };
+        private:
+            PoolAllocator& m_rAlloc;
+            Marker m_Marker;
+        };
+
+        /// \param nChunkSize  Minimum size of the blocks requested from the chunk source.
+        ///                      Rounded up to a multiple of the source's granularity
+        /// \param pSource     Where chunks come from.  Defaults to malloc.  The source must outlive the allocator
+        PoolAllocator( size_t nChunkSize=CHUNKSIZE, ChunkSource* pSource=0 );
         ~PoolAllocator() { FreeAll(); }
 
-        template< class T > T* GetA() { return reinterpret_cast<T*>( GetMore( sizeof(T) ) ); }
-        template< class T > T* GetSome( uint n ) { return reinterpret_cast<T*>( GetMore( sizeof(T)*n ) ); };
-        void* GetMore( uint nSize );
+        template< class T > T* GetA() { return reinterpret_cast<T*>( GetMore( sizeof(T), AlignOf<T>() ) ); }
+        template< class T > T* GetSome( size_t n ) { return reinterpret_cast<T*>( GetMore( sizeof(T)*n, AlignOf<T>() ) ); };
+
+        /// \param nAlign  Alignment of the returned pointer.  Must be a power of two.  Alignments below 16 are rounded up
+        /// \return Null if the chunk source is exhausted
+        void* GetMore( size_t nSize, size_t nAlign=ALIGN );
+
+        /// Allocates and constructs an object.  Its destructor is run when the allocator is rewound past it, recycled, or freed
+        template< class T, class... Args_T >
+        T* New( Args_T&&... args );
+
+        /// Allocates and constructs an object whose destructor will never be run
+        template< class T, class... Args_T >
+        T* NewUntracked( Args_T&&... args )
+        {
+            void* pStorage = GetA<T>();
+            return pStorage ? new( pStorage ) T( std::forward<Args_T>(args)... ) : 0;
+        }
+
+        Marker GetMarker() const
+        {
+            Marker m;
+            m.pBlock  = m_pHead;
+            m.nOffset = m_pHead ? m_pHead->nOffset : 0;
+            m.pDtors  = m_pDtors;
+            return m;
+        }
+
+        /// Releases everything allocated since 'marker' was taken.  Markers taken after 'marker' become invalid
+        void RewindTo( const Marker& marker );
 
+        /// Releases all memory back to the system
         void FreeAll( );
 
+        /// Releases all allocations, but keeps the memory for re-use
         void Recycle( );
 
     private:
 
+        PoolAllocator( const PoolAllocator& );
+        PoolAllocator& operator=( const PoolAllocator& );
+
         struct AllocHeader
         {
             AllocHeader* pNext;     ///< Next block in linked list
-            uint nCapacity;         ///< Total Size of block (including header)
-            uint nOffset;           ///< Offset of next free byte     
+            size_t nCapacity;       ///< Total Size of block (including header)
+            size_t nOffset;         ///< Offset of next free byte
         };
 
+        struct DtorRecord
+        {
+            DtorRecord* pNext;              ///< Next older record
+            void (*pfnDestroy)( void* );
+            void* pObject;
+        };
 
         enum
         {
             ALIGN       = 16,       ///< Align all 'GetMore' calls to this size
-            CHUNKSIZE   = 16*1024,  ///< Align all mallocs to this size
+            CHUNKSIZE   = 16*1024,  ///< Default chunk size
             HEADER_SIZE = (sizeof(AllocHeader) + ALIGN-1) & ~(ALIGN-1)
         };
 
-        AllocHeader* m_pHead;
+        template< class T > static size_t AlignOf() { return std::alignment_of<T>::value; }
+        template< class T > static void Destroy( void* p ) { static_cast<T*>(p)->~T(); }
+
+        void RunDtors( DtorRecord* pStop );
+        static void* TryAlloc( AllocHeader* pBlock, size_t nSize, size_t nAlign );
+
+        size_t m_nChunkSize;        ///< Size of all chunk requests is a multiple of this
+        ChunkSource* m_pSource;
+
+        AllocHeader* m_pHead;       ///< Blocks in use.  The head is the one being allocated from
+        AllocHeader* m_pSpare;      ///< Blocks which were released by a rewind or recycle
+        DtorRecord* m_pDtors;       ///< Objects to destroy, newest first
     };
+
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    template< class T, class... Args_T >
+    T* PoolAllocator::New( Args_T&&... args )
+    {
+        if( std::is_trivially_destructible<T>::value )
+            return NewUntracked<T>( std::forward<Args_T>(args)... );
+
+        // record goes in first, so that rewinding to a marker taken in between drops both
+        DtorRecord* pRecord = GetA<DtorRecord>();
+        void* pStorage = GetA<T>();
+        if( !pRecord || !pStorage )
+            return 0;
+
+        T* pObject = new( pStorage ) T( std::forward<Args_T>(args)... );
+        pRecord->pNext = m_pDtors;
+        pRecord->pfnDestroy = &Destroy<T>;
+        pRecord->pObject = pObject;
+        m_pDtors = pRecord;
+        return pObject;
+    }
 }
 
 
 
-#endif
\ No newline at end of file
+#endif
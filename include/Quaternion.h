@@ -0,0 +1,145 @@
+//=====================================================================================================================
+//
+//   Quaternion.h
+//
+//   Definition of classes: Simpleton::Quatf, Simpleton::DualQuatf
+//
+//   The lazy man's utility library
+//   Joshua Barczak
+//   Copyright 2016 Joshua Barczak
+//
+//   LICENSE:  See Doc\License.txt for terms and conditions
+//
+//=====================================================================================================================
+
+#ifndef _QUATERNION_H_
+#define _QUATERNION_H_
+
+#include "VectorMath.h"
+#include "Matrix.h"
+
+namespace Simpleton
+{
+
+    //=====================================================================================================================
+    /// \ingroup Simpleton
+    /// \brief Rotation quaternion.  (x,y,z) is the vector part, w the scalar part
+    ///
+    ///   Conventions match MatrixRotate:  FromAxisAngle(axis,theta).ToMatrix() == MatrixRotate(axis,theta)
+    ///   Products compose like matrices:  (a*b) rotates by b, then by a
+    ///
+    //=====================================================================================================================
+    class Quatf
+    {
+    public:
+
+        float x;
+        float y;
+        float z;
+        float w;
+
+        Quatf() {}
+        Quatf( float qx, float qy, float qz, float qw ) : x(qx), y(qy), z(qz), w(qw) {}
+        Quatf( const Vec3f& v, float qw ) : x(v.x), y(v.y), z(v.z), w(qw) {}
+
+        static Quatf Identity() { return Quatf(0,0,0,1); }
+
+        /// Axis need not be normalized
+        static Quatf FromAxisAngle( const Vec3f& rAxis, float fAngleInRads )
+        {
+            Vec3f a = Normalize3(rAxis);
+            float s = sinf( 0.5f*fAngleInRads );
+            return Quatf( a*s, cosf( 0.5f*fAngleInRads ) );
+        }
+
+        Vec3f GetVector() const { return Vec3f(x,y,z); }
+
+        Quatf operator*( const Quatf& b ) const
+        {
+            return Quatf( w*b.x + x*b.w + y*b.z - z*b.y,
+                          w*b.y + y*b.w + z*b.x - x*b.z,
+                          w*b.z + z*b.w + x*b.y - y*b.x,
+                          w*b.w - x*b.x - y*b.y - z*b.z );
+        }
+
+        Quatf operator*( float f ) const { return Quatf( x*f, y*f, z*f, w*f ); }
+        Quatf operator+( const Quatf& b ) const { return Quatf( x+b.x, y+b.y, z+b.z, w+b.w ); }
+        Quatf operator-() const { return Quatf( -x, -y, -z, -w ); }
+
+        /// Inverse, for unit quaternions
+        Quatf Conjugate() const { return Quatf( -x, -y, -z, w ); }
+
+        /// Rotates a vector
+        Vec3f Rotate( const Vec3f& v ) const
+        {
+            Vec3f u(x,y,z);
+            Vec3f t = Cross3(u,v) * 2.0f;
+            return v + t*w + Cross3(u,t);
+        }
+
+        /// Rotation matrix (column major, like everything else)
+        Matrix4f ToMatrix() const;
+    };
+
+    inline float Dot4( const Quatf& a, const Quatf& b ) { return a.x*b.x + a.y*b.y + a.z*b.z + a.w*b.w; }
+
+    inline Quatf Normalize( const Quatf& q ) { return q * (1.0f / sqrtf( Dot4(q,q) )); }
+
+    /// Normalized linear interpolation along the shorter arc.  Cheap, but not constant-velocity
+    Quatf Nlerp( const Quatf& a, const Quatf& b, float t );
+
+    /// Spherical linear interpolation along the shorter arc
+    Quatf Slerp( const Quatf& a, const Quatf& b, float t );
+
+
+    //=====================================================================================================================
+    /// \ingroup Simpleton
+    /// \brief Dual quaternion, for rigid (rotation+translation) transforms
+    ///
+    ///   The real part is the rotation q, and the dual part is 0.5*(t,0)*q.  These blend without the candy-wrapper
+    ///    artifacts of linearly blended matrices, which is why skinning likes them.
+    ///
+    //=====================================================================================================================
+    class DualQuatf
+    {
+    public:
+
+        Quatf Real;
+        Quatf Dual;
+
+        DualQuatf() {}
+        DualQuatf( const Quatf& r, const Quatf& d ) : Real(r), Dual(d) {}
+
+        static DualQuatf Identity() { return DualQuatf( Quatf::Identity(), Quatf(0,0,0,0) ); }
+
+        /// Rotates by q, then translates by t
+        static DualQuatf FromRigid( const Quatf& q, const Vec3f& t )
+        {
+            return DualQuatf( q, (Quatf(t,0) * q) * 0.5f );
+        }
+
+        /// (a*b) applies b, then a
+        DualQuatf operator*( const DualQuatf& b ) const
+        {
+            return DualQuatf( Real*b.Real, Real*b.Dual + Dual*b.Real );
+        }
+
+        DualQuatf Conjugate() const { return DualQuatf( Real.Conjugate(), Dual.Conjugate() ); }
+
+        const Quatf& GetRotation() const { return Real; }
+        Vec3f GetTranslation() const { return ( (Dual*2.0f) * Real.Conjugate() ).GetVector(); }
+
+        Vec3f TransformPoint( const Vec3f& p ) const { return Real.Rotate(p) + GetTranslation(); }
+        Vec3f TransformDirection( const Vec3f& v ) const { return Real.Rotate(v); }
+
+        Matrix4f ToMatrix() const;
+    };
+
+    /// Scales both parts so that the real part has unit length
+    DualQuatf Normalize( const DualQuatf& dq );
+
+    /// Dual quaternion linear blending (Kavan et al.).  Weights need not sum to one
+    DualQuatf Blend( const DualQuatf* pDQs, const float* pWeights, size_t nCount );
+}
+
+#endif // _QUATERNION_H_
@@ -16,18 +16,224 @@
 #ifndef _RAND_H_
 #define _RAND_H_
 
+#include "Types.h"
+#include <stddef.h>
 #include <stdlib.h>
+#include <assert.h>
 
 namespace Simpleton
 {
-    inline float Rand(  ) { return rand() / (float)RAND_MAX; }
+    namespace _INTERNAL
+    {
+        /// Top 24 bits of x, as a float in [0,1)
+        inline float UIntToUnitFloat( uint32 x ) { return (x >> 8) * (1.0f/16777216.0f); }
+    }
+
+    //=====================================================================================================================
+    /// \ingroup Simpleton
+    /// \brief Vigna's SplitMix64.  Used to turn arbitrary seeds into well-mixed generator state
+    //=====================================================================================================================
+    class SplitMix64
+    {
+    public:
+        explicit SplitMix64( uint64 nSeed ) : m_nState(nSeed) {}
+
+        uint64 Next()
+        {
+            uint64 z = (m_nState += 0x9e3779b97f4a7c15ull);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            return z ^ (z >> 31);
+        }
+
+    private:
+        uint64 m_nState;
+    };
+
+    /// Hashes a base seed and an item index into a seed.  Gives each work item a reproducible, decorrelated seed,
+    ///  no matter which thread happens to run it
+    inline uint64 MixSeed( uint64 nSeed, uint64 nItem )
+    {
+        SplitMix64 sm( nSeed ^ (nItem * 0xd1342543de82ef95ull) );
+        return sm.Next();
+    }
+
+
+    //=====================================================================================================================
+    /// \ingroup Simpleton
+    /// \brief O'Neill's PCG32 (XSH-RR variant).  64 bits of state, 32 bits of output.
+    ///
+    ///  Each (seed,stream) pair is an independent sequence.  For parallel work, give each work item its own stream,
+    ///   or Advance() a copy of one generator by the number of values each item consumes
+    ///
+    //=====================================================================================================================
+    class PCG32
+    {
+    public:
+
+        explicit PCG32( uint64 nSeed=0x853c49e6748fea9bull, uint64 nStream=0xda3e39cb94b95bdbull )
+        {
+            Seed(nSeed,nStream);
+        }
+
+        void Seed( uint64 nSeed, uint64 nStream=0xda3e39cb94b95bdbull ) { Seed( m_nState, m_nInc, nSeed, nStream ); }
+
+        uint32 NextUInt() { return Step( m_nState, m_nInc ); }
+
+        /// Uniform in [0,nBound), without modulo bias.  'nBound' must be non-zero
+        uint32 NextUInt( uint32 nBound )
+        {
+            assert( nBound != 0 );
+            uint32 nThreshold = (0u-nBound) % nBound;
+            for(;;)
+            {
+                uint32 r = NextUInt();
+                if( r >= nThreshold )
+                    return r % nBound;
+            }
+        }
+
+        /// Uniform in [0,1)
+        float NextFloat() { return _INTERNAL::UIntToUnitFloat( NextUInt() ); }
+
+        /// Uniform in [a,b)
+        float NextFloat( float a, float b ) { return a + (b-a)*NextFloat(); }
+
+        /// Skips ahead (or back, if negative) by 'nDelta' outputs, in O(log(nDelta)) time
+        void Advance( uint64 nDelta );
+
+        void FillUInts( uint32* pOut, size_t n );
+        void FillFloats( float* pOut, size_t n );
+
+        /// The generator, on bare state.  For places that cannot hold a PCG32 (e.g. thread-local storage on VC++)
+        static void Seed( uint64& nState, uint64& nInc, uint64 nSeed, uint64 nStream )
+        {
+            nState = 0;
+            nInc   = (nStream << 1) | 1;
+            Step( nState, nInc );
+            nState += nSeed;
+            Step( nState, nInc );
+        }
+
+        static uint32 Step( uint64& nState, uint64 nInc )
+        {
+            uint64 nOld = nState;
+            nState = nOld * MULTIPLIER + nInc;
+            uint32 nXorShifted = (uint32)( ((nOld >> 18) ^ nOld) >> 27 );
+            uint32 nRot = (uint32)( nOld >> 59 );
+            return (nXorShifted >> nRot) | (nXorShifted << ((0u-nRot) & 31));
+        }
+
+    private:
+
+        static const uint64 MULTIPLIER = 6364136223846793005ull;
+
+        uint64 m_nState;
+        uint64 m_nInc;
+    };
+
+
+    //=====================================================================================================================
+    /// \ingroup Simpleton
+    /// \brief Blackman and Vigna's xoshiro256+.  The fastest good generator for floating-point output.
+    ///
+    ///  The low bits are weak, so the float conversions use the high ones.  Jump() advances by 2^128 outputs,
+    ///   which carves the period into non-overlapping sub-sequences for parallel use
+    ///
+    //=====================================================================================================================
+    class Xoshiro256Plus
+    {
+    public:
+
+        explicit Xoshiro256Plus( uint64 nSeed=0 ) { Seed(nSeed); }
+
+        void Seed( uint64 nSeed )
+        {
+            SplitMix64 sm(nSeed);
+            for( size_t i=0; i<4; i++ )
+                m_s[i] = sm.Next();
+        }
+
+        uint64 Next()
+        {
+            uint64 nResult = m_s[0] + m_s[3];
+            uint64 t = m_s[1] << 17;
+            m_s[2] ^= m_s[0];
+            m_s[3] ^= m_s[1];
+            m_s[1] ^= m_s[2];
+            m_s[0] ^= m_s[3];
+            m_s[2] ^= t;
+            m_s[3] = (m_s[3] << 45) | (m_s[3] >> 19);
+            return nResult;
+        }
+
+        uint32 NextUInt() { return (uint32)( Next() >> 32 ); }
+
+        /// Uniform in [0,1)
+        float NextFloat() { return (Next() >> 40) * (1.0f/16777216.0f); }
+
+        /// Uniform in [a,b)
+        float NextFloat( float a, float b ) { return a + (b-a)*NextFloat(); }
+
+        /// Uniform in [0,1)
+        double NextDouble() { return (Next() >> 11) * (1.0/9007199254740992.0); }
+
+        /// Equivalent to 2^128 calls to Next()
+        void Jump();
+
+        /// Equivalent to 2^192 calls to Next()
+        void LongJump();
+
+        void FillUInts( uint32* pOut, size_t n );
+        void FillFloats( float* pOut, size_t n );
+
+    private:
+
+        void Jump( const uint64 pPoly[4] );
+
+        uint64 m_s[4];
+    };
+
+
+    //=====================================================================================================================
+    /// \ingroup Simpleton
+    /// \brief Four interleaved xoshiro128+ streams, for filling big buffers with SSE2
+    ///
+    ///  The lanes are one sequence, jumped 2^64 apart, so they never overlap.  Output is interleaved lane by lane.
+    ///  Falls back to scalar code on targets without SSE2.  Output is the same either way.
+    ///
+    //=====================================================================================================================
+    class Xoshiro128PlusX4
+    {
+    public:
+
+        explicit Xoshiro128PlusX4( uint64 nSeed=0 ) { Seed(nSeed); }
+
+        void Seed( uint64 nSeed );
+
+        /// 'n' need not be a multiple of 4.  Leftovers from the last group of four are discarded
+        void FillUInts( uint32* pOut, size_t n );
+        void FillFloats( float* pOut, size_t n );
+
+    private:
+
+        uint32 m_s[4][4];   ///< [word][lane]
+    };
+
+
+    /// Uniform in [0,1).  Draws from a per-thread PCG32, so threads do not contend with each other.
+    ///  Each thread is seeded differently when it first calls this
+    float Rand();
+
+    /// Re-seeds the calling thread's generator, for reproducible results
+    void SeedRand( uint64 nSeed );
 
     inline float Rand( float a, float b )
     {
         float t = Rand();
         return t*b + (1-t)*a;
     }
-    
+
 }
 
 #endif // _RAND_H_
@@ -12,8 +12,12 @@
 //
 //=====================================================================================================================
 
+#ifndef _SPIN_LOCK_H_
+#define _SPIN_LOCK_H_
+
 #include <xmmintrin.h>
 #include <atomic>
+#include <thread>
 
 namespace Simpleton
 {
@@ -27,8 +31,16 @@ namespace Simpleton
 
         void Take()
         {
-            while( !m_Flag.test_and_set(std::memory_order_acquire) )
-                _mm_pause();
+            // test_and_set returns the previous value.  We own the lock once we're the one who set it
+            //  If the holder got preempted, spinning just burns its timeslice, so back off to a yield after a while
+            unsigned int nSpins=0;
+            while( m_Flag.test_and_set(std::memory_order_acquire) )
+            {
+                if( ++nSpins < SPIN_COUNT )
+                    _mm_pause();
+                else
+                    std::this_thread::yield();
+            }
         }
 
 
@@ -38,7 +50,15 @@ namespace Simpleton
         }
 
     private:
+
+        enum
+        {
+            SPIN_COUNT = 128
+        };
+
         std::atomic_flag m_Flag;
     };
 
-}
\ No newline at end of file
+}
+
+#endif // _SPIN_LOCK_H_
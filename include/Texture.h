@@ -15,10 +15,13 @@
 #ifndef _TEXTURE_H_
 #define _TEXTURE_H_
 
+#include <stddef.h>
+
     typedef unsigned int uint;
 typedef char int8;
 namespace Simpleton
 {
+    class ThreadPool;
 
     uint CountTextureMips( uint nTextureWidth, uint nTextureHeight, uint nTextureDepth );
 
@@ -30,6 +33,9 @@ namespace Simpleton
     /// Given a full mip chain generate from top down in place
     void GenerateMips_RGBA_InPlace( void* pInOut, uint nTopWidth, uint nTopHeight, uint nMipsToGenerate );
 
+    /// Multi-threaded version of 'GenerateMips_RGBA_InPlace'.  Rows of each mip are split across the pool
+    void GenerateMips_RGBA_InPlace( ThreadPool& pool, void* pInOut, uint nTopWidth, uint nTopHeight, uint nMipsToGenerate );
+
     /// Generate a random rotation texture.  Output is a two channel 8-bit SNORM map containing cos(t),sin(t) in each pixel
     void CreateRandomRotations( int8* pOut, uint nWidth, uint nHeight );
 
@@ -46,6 +46,16 @@ namespace Simpleton
         /// Waits for the thread to complete
         void WaitForCompletion();
 
+        /// Sets the name reported to debuggers and profilers.  Must be called before Start()
+        ///   Names are truncated to 15 characters, which is the limit on Linux
+        void SetName( const char* pName );
+
+        /// Pins the thread to the given logical core.  Must be called before Start()
+        void SetAffinity( unsigned int nCore );
+
+        /// Returns the number of logical cores in the machine
+        static unsigned int GetHardwareThreadCount();
+
     protected:
 
         // Protected interface for use by thread sub-classes
@@ -57,10 +67,22 @@ namespace Simpleton
     private:
 
         /// Thread execution procedure, its a friend so that it can call OnExecuteThread
+    #ifdef WIN32
         friend unsigned int __stdcall  SimpletonThreadProc( void* pThreadData );
+    #else
+        friend void* SimpletonThreadProc( void* pThreadData );
+    #endif
+
+        /// Applies name and affinity from inside the new thread
+        void ApplyThreadSettings();
+
+        static const int MAX_NAME_LENGTH = 16;
 
         bool m_bDeadFlag;       ///< Set when thread terminates
-        void* m_nThreadHandle;  ///< Thread handle
+        bool m_bJoined;         ///< Set once WaitForCompletion has reaped the thread
+        void* m_nThreadHandle;  ///< Thread handle.  On POSIX this points at a heap-allocated pthread_t
+        int m_nAffinity;        ///< Core to pin to, or -1
+        char m_Name[MAX_NAME_LENGTH];
 
     };
     
@@ -17,7 +17,11 @@
 
 #include <vector>
 #include <deque>
+#include <atomic>
+#include <thread>
 #include "SpinLock.h"
+#include "EventCount.h"
+#include "WorkStealingDeque.h"
 
 namespace Simpleton
 {
@@ -29,39 +33,39 @@ namespace Simpleton
         virtual void Do() = 0;
     };
 
+    //=====================================================================================================================
+    /// \ingroup Simpleton
+    /// \brief Work-stealing thread pool
+    ///
+    ///   Each worker owns a lock-free deque.  Work pushed by a worker goes onto its own deque, and is popped LIFO
+    ///    by that worker.  Idle workers steal FIFO from randomly chosen victims.
+    ///
+    ///   Work pushed by threads outside the pool goes into a shared, spin-locked submission queue,
+    ///     which is drained by workers (and by external callers of DoWork/WaitAll)
+    ///
+    ///   Workers that run out of work spin briefly, then yield, then go to sleep until more work is pushed.
+    ///     An idle pool consumes no CPU.
+    ///
+    //=====================================================================================================================
     class ThreadPool
     {
     public:
 
-        void Start( size_t nWorkers );
+        ThreadPool();
+        ~ThreadPool();
+
+        /// Spins up worker threads.  Workers are named "Worker N" for the benefit of debuggers and profilers
+        /// \param bPinToCores  If set, worker N is pinned to logical core N (modulo the core count)
+        void Start( size_t nWorkers, bool bPinToCores=false );
 
         void Shutdown();
 
         /// Insert work into the thread pool
-        void PushWork( WorkItem* pItem )
-        {
-            m_Lock.Take();
-            m_WorkItems.push_back(pItem);
-            m_Lock.Release();
-        }
+        void PushWork( WorkItem* pItem );
 
         /// Execute at most one queued work item
         ///  Return true if work was done
-        bool DoWork()
-        {
-            m_Lock.Take();
-            if( m_WorkItems.empty() )
-            {
-                m_Lock.Release(); 
-                return false;
-            }
-            WorkItem* pWork = m_WorkItems.front();
-            m_WorkItems.pop_front();
-            m_Lock.Release();
-
-            pWork->Do();
-            return true;
-        }
+        bool DoWork();
 
         /// Block caller until thread pool drains
         void WaitAll()
@@ -70,16 +74,96 @@ namespace Simpleton
                 ;
         }
 
+        /// Executes pool work on the calling thread until bDone() returns true.
+        ///   If there is no work to be had, the caller spins for a bit, and then sleeps until 'NotifyWaiters' is called.
+        ///   Whoever makes bDone() true must call 'NotifyWaiters' afterwards
+        template< class Done_T >
+        void WorkUntil( const Done_T& bDone );
+
+        /// Wakes up any threads sleeping in 'WorkUntil' so that they can re-check their conditions
+        void NotifyWaiters() { m_Waiters.NotifyAll(); }
+
+        size_t GetWorkerCount() const { return m_Workers.size(); }
+
     private:
 
+        enum
+        {
+            SPIN_COUNT  = 64,   ///< Number of times to spin on an empty pool before yielding
+            YIELD_COUNT = 16,   ///< Number of times to yield on an empty pool before sleeping
+        };
+
+        class WorkerThread;
+        friend class WorkerThread;
+
+        struct Worker
+        {
+            WorkStealingDeque<WorkItem> Deque;
+            ThreadPool* pPool;
+            size_t nIndex;
+            uint32 nRandState;  ///< For victim selection
+        };
+
+        WorkItem* FindWork( Worker* pWorker );
+        WorkItem* PopSubmitted();
+        WorkItem* Steal( Worker* pThief );
+        Worker* GetCurrentWorker() const;
+
+        ThreadPool( const ThreadPool& );
+        ThreadPool& operator=( const ThreadPool& );
+
         std::vector<Thread*> m_WorkerThreads;
+        std::vector<Worker*> m_Workers;
+        std::atomic<bool> m_bShutdown;
 
         SpinLock m_Lock;
-        std::deque<WorkItem*> m_WorkItems;
+        std::deque<WorkItem*> m_WorkItems;      ///< Work submitted from outside the pool
+        std::atomic<size_t> m_nSubmitted;       ///< Size of m_WorkItems.  Lets us skip the lock when it's empty
+
+        EventCount m_IdleWorkers;               ///< Sleeping workers.  Signalled on push
+        EventCount m_Waiters;                   ///< Threads sleeping in WorkUntil
     };
 
 
+    //=====================================================================================================================
+    //=====================================================================================================================
+    template< class Done_T >
+    void ThreadPool::WorkUntil( const Done_T& bDone )
+    {
+        Worker* pWorker = GetCurrentWorker();
+        uint nIdle = 0;
+        while( !bDone() )
+        {
+            WorkItem* pWork = FindWork(pWorker);
+            if( pWork )
+            {
+                pWork->Do();
+                nIdle = 0;
+            }
+            else if( ++nIdle <= SPIN_COUNT )
+            {
+                _mm_pause();
+            }
+            else if( nIdle <= SPIN_COUNT+YIELD_COUNT )
+            {
+                std::this_thread::yield();
+            }
+            else
+            {
+                uint32 nKey = m_Waiters.PrepareWait();
+                if( bDone() )
+                {
+                    m_Waiters.CancelWait();
+                    break;
+                }
+                m_Waiters.Wait(nKey);
+                nIdle = 0;
+            }
+        }
+    }
+
+
 }
 
 
-#endif
\ No newline at end of file
+#endif
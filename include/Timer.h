@@ -47,6 +47,7 @@ namespace Simpleton
         {
         public:
            
+            virtual ~TimerImpl() {};
             virtual unsigned int Tick() const = 0;
             virtual unsigned long TickMicroSeconds() const = 0;
             virtual void Reset() = 0;
@@ -56,7 +57,7 @@ namespace Simpleton
     private:
 
         inline Timer( const Timer&  ) {};
-        inline const Timer& operator=( const Timer&  ) {};
+        inline const Timer& operator=( const Timer&  ) { return *this; };
        
         TimerImpl* m_pImpl;
     };
@@ -0,0 +1,107 @@
+//=====================================================================================================================
+//
+//   TransformHierarchy.h
+//
+//   Definition of class: Simpleton::TransformHierarchy
+//
+//   The lazy man's utility library
+//   Joshua Barczak
+//   Copyright 2016 Joshua Barczak
+//
+//   LICENSE:  See Doc\License.txt for terms and conditions
+//
+//=====================================================================================================================
+
+#ifndef _TRANSFORM_HIERARCHY_H_
+#define _TRANSFORM_HIERARCHY_H_
+
+#include "Types.h"
+#include "Matrix.h"
+#include <vector>
+
+namespace Simpleton
+{
+    class ThreadPool;
+
+    //=====================================================================================================================
+    /// \ingroup Simpleton
+    /// \brief A flattened tree of transforms, for scene graphs that are too big to walk with a MatrixStack every frame
+    ///
+    ///   Node data is kept in structure-of-arrays form, sorted by depth, so that every node's parent is in an earlier
+    ///    level than the node itself.  Update() walks the levels in order, and only recomputes nodes whose local
+    ///    transform changed, or whose parent's world transform changed.  Nodes within a level are independent,
+    ///    so a level can be split across a thread pool.
+    ///
+    ///   World transforms compose the same way a MatrixStack traversal does:
+    ///       World(node) = Local(node) * World(parent)
+    ///
+    ///   Nodes are referred to by the ID returned from AddNode.  A parent must be added before its children.
+    ///
+    //=====================================================================================================================
+    class TransformHierarchy
+    {
+    public:
+
+        enum
+        {
+            NO_PARENT = 0xffffffff
+        };
+
+        TransformHierarchy();
+
+        /// Adds a node and returns its ID.  World transforms are stale until the next call to Update()
+        uint32 AddNode( uint32 nParentID, const Matrix4f& rLocal );
+
+        /// Changes a node's local transform.  The node and its descendents are refreshed by the next Update()
+        void SetLocalTransform( uint32 nID, const Matrix4f& rLocal );
+
+        const Matrix4f& GetLocalTransform( uint32 nID ) const { return m_Local[ m_IDToSlot[nID] ]; }
+
+        /// Returns the node's local-to-world transform, as of the last Update()
+        const Matrix4f& GetWorldTransform( uint32 nID ) const { return m_World[ m_IDToSlot[nID] ]; }
+
+        uint32 GetParent( uint32 nID ) const { return m_ParentIDs[nID]; }
+        uint32 GetLevel( uint32 nID ) const { return m_Levels[nID]; }
+        uint32 GetNodeCount() const { return (uint32) m_ParentIDs.size(); }
+        uint32 GetLevelCount() const { return m_LevelStart.empty() ? 0 : (uint32) m_LevelStart.size()-1; }
+
+        /// Recomputes the world transform of every node that needs it
+        void Update();
+
+        /// Recomputes the world transform of every node that needs it.  Large levels are split across the pool
+        void Update( ThreadPool& rPool );
+
+        /// Removes all nodes
+        void Clear();
+
+    private:
+
+        enum
+        {
+            PARALLEL_GRAIN = 256    ///< Nodes per work item.  Levels smaller than this run on the calling thread
+        };
+
+        void Sort();
+        void UpdateRange( uint32 nFirst, uint32 nLast );
+
+        // Indexed by node ID
+        std::vector<uint32> m_ParentIDs;
+        std::vector<uint32> m_Levels;
+        std::vector<uint32> m_IDToSlot;
+
+        // Indexed by slot.  Sorted by level
+        std::vector<uint32>   m_ParentSlots;  ///< NO_PARENT for roots
+        std::vector<Matrix4f> m_Local;
+        std::vector<Matrix4f> m_World;
+        std::vector<uint8>    m_Dirty;        ///< Non-zero if the world transform must be recomputed
+
+        std::vector<uint32> m_LevelStart;     ///< Level i is slots [m_LevelStart[i], m_LevelStart[i+1])
+        bool m_bSorted;                       ///< False if nodes have been added since the last sort
+
+        TransformHierarchy( const TransformHierarchy& );
+        TransformHierarchy& operator=( const TransformHierarchy& );
+    };
+
+}
+
+#endif // _TRANSFORM_HIERARCHY_H_
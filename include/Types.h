@@ -2,14 +2,52 @@
 #ifndef _TYPES_H_
 #define _TYPES_H_
 
+#include <stdint.h>
+
 typedef unsigned char uint8;
 typedef unsigned short uint16;
 typedef unsigned int uint;
 typedef unsigned int uint32;
-typedef __int64 int64;
-typedef unsigned __int64 uint64;
+typedef int64_t int64;
+typedef uint64_t uint64;
 
+// Storage class for thread-local variables.  
+//   VC++ 2013 has no C++11 'thread_local', and the compiler-specific forms are faster besides
+#ifndef THREAD_LOCAL
+    #ifdef _MSC_VER
+        #define THREAD_LOCAL __declspec(thread)
+    #else
+        #define THREAD_LOCAL __thread
+    #endif
+#endif
 
+// Marks functions which can be evaluated at compile time.  The functions in question need C++14's relaxed rules
+//   (loops, local variables), so this expands to nothing on older compilers, including VC++ 2013 and 2015
+#ifndef SIMPLETON_CONSTEXPR
+    #if (defined(__cpp_constexpr) && __cpp_constexpr >= 201304) || (defined(_MSC_VER) && _MSC_VER >= 1910)
+        #define SIMPLETON_CONSTEXPR constexpr
+    #else
+        #define SIMPLETON_CONSTEXPR
+    #endif
+#endif
 
+// True while the compiler is evaluating a constant expression.  Lets a constexpr function take a scalar path in place
+//   of intrinsics, which can't be evaluated at compile time.  Left undefined where the compiler can't tell us
+//   (VC++ before 2019 16.5, GCC before 9, Clang before 9)
+#ifndef SIMPLETON_IS_CONSTANT_EVALUATED
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #if _MSC_VER >= 1925
+            #define SIMPLETON_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+        #endif
+    #elif defined(__GNUC__) && !defined(__clang__)
+        #if __GNUC__ >= 9
+            #define SIMPLETON_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+        #endif
+    #elif defined(__has_builtin)
+        #if __has_builtin(__builtin_is_constant_evaluated)
+            #define SIMPLETON_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+        #endif
+    #endif
+#endif
 
 #endif
@@ -16,6 +16,8 @@
 #define _VECTOR_MATH_H_
 
 #include <math.h>
+#include <utility>
+#include "Types.h"
 
 
 namespace Simpleton
@@ -49,13 +51,11 @@ namespace Simpleton
         inline Vec2 ( ) {};
 
         /// Value constructor
-        inline Vec2 ( const T& vx, const T& vy ) : x(vx), y(vy) {};
+        inline SIMPLETON_CONSTEXPR Vec2 ( const T& vx, const T& vy ) : x(vx), y(vy) {};
         
-        /// Copy constructor
-        inline Vec2 ( const Vec2<T>& val ) : x(val.x), y(val.y) {};
     
         /// Single value constructor.  Sets all components to the given value
-        inline Vec2 ( const T& v ) : x(v), y(v) {};
+        inline SIMPLETON_CONSTEXPR Vec2 ( const T& v ) : x(v), y(v) {};
 
 
         // *****************************************
@@ -68,55 +68,53 @@ namespace Simpleton
         /// cast to T*
         inline operator T*() { return (T*)this; };
 
-        /// Assignment
-        inline const Vec2<T>& operator=( const Vec2<T>& rhs )  { x = rhs.x; y = rhs.y; return *this; };
 
         // *****************************************
         //    Comparison
         // *****************************************
 
         /// Equality comparison
-        inline bool operator==( const Vec2<T>& rhs ) const { return ( x == rhs.x && y == rhs.y ); };
+        inline SIMPLETON_CONSTEXPR bool operator==( const Vec2<T>& rhs ) const { return ( x == rhs.x && y == rhs.y ); };
         
         /// Inequality comparision
-        inline bool operator!=( const Vec2<T>& rhs ) const { return ( x != rhs.x || y != rhs.y ); };
+        inline SIMPLETON_CONSTEXPR bool operator!=( const Vec2<T>& rhs ) const { return ( x != rhs.x || y != rhs.y ); };
 
         // *****************************************
         //    Arithmetic
         // *****************************************
 
         /// Addition
-        inline const Vec2<T> operator+( const Vec2<T>& rhs ) const { return Vec2<T>( x + rhs.x, y + rhs.y); };
+        inline SIMPLETON_CONSTEXPR const Vec2<T> operator+( const Vec2<T>& rhs ) const { return Vec2<T>( x + rhs.x, y + rhs.y); };
 
         /// Subtraction
-        inline const Vec2<T> operator-( const Vec2<T>& rhs ) const { return Vec2<T>( x - rhs.x, y - rhs.y );};
+        inline SIMPLETON_CONSTEXPR const Vec2<T> operator-( const Vec2<T>& rhs ) const { return Vec2<T>( x - rhs.x, y - rhs.y );};
 
         /// Divide by vector
-        inline const Vec2<T> operator/( const Vec2<T>& rhs ) const { return Vec2<T>( x / rhs.x, y / rhs.y ); };
+        inline SIMPLETON_CONSTEXPR const Vec2<T> operator/( const Vec2<T>& rhs ) const { return Vec2<T>( x / rhs.x, y / rhs.y ); };
 
         /// Multiply by scalar
-        inline const Vec2<T> operator*( const T& v ) const { return Vec2<T>( x*v, y*v ); };
+        inline SIMPLETON_CONSTEXPR const Vec2<T> operator*( const T& v ) const { return Vec2<T>( x*v, y*v ); };
 
         /// Divide by scalar
-        inline const Vec2<T> operator/( const T& v ) const { return Vec2<T>( x/v, y/v ); };
+        inline SIMPLETON_CONSTEXPR const Vec2<T> operator/( const T& v ) const { return Vec2<T>( x/v, y/v ); };
 
         /// Addition in-place
-        inline Vec2<T>& operator+= ( const Vec2<T>& rhs ) { x += rhs.x; y += rhs.y; return *this; };
+        inline SIMPLETON_CONSTEXPR Vec2<T>& operator+= ( const Vec2<T>& rhs ) { x += rhs.x; y += rhs.y; return *this; };
     
         /// Subtract in-place
-        inline Vec2<T>& operator-= ( const Vec2<T>& rhs ) { x -= rhs.x; y -= rhs.y; return *this; };
+        inline SIMPLETON_CONSTEXPR Vec2<T>& operator-= ( const Vec2<T>& rhs ) { x -= rhs.x; y -= rhs.y; return *this; };
 
         /// Scalar multiply in-place
-        inline Vec2<T>& operator*= ( const T& v ) { x *= v; y *= v; return *this; };
+        inline SIMPLETON_CONSTEXPR Vec2<T>& operator*= ( const T& v ) { x *= v; y *= v; return *this; };
 
         /// Scalar divide in-place
-        inline Vec2<T>& operator/= ( const T& v ) { x /= v; y /= v; return *this; };
+        inline SIMPLETON_CONSTEXPR Vec2<T>& operator/= ( const T& v ) { x /= v; y /= v; return *this; };
 
         /// Vector multiply in place
-        inline Vec2<T>& operator*= ( const Vec2<T>& v ) { x *= v.x; y *= v.y; return *this; };
+        inline SIMPLETON_CONSTEXPR Vec2<T>& operator*= ( const Vec2<T>& v ) { x *= v.x; y *= v.y; return *this; };
 
         /// Vector divide in-place
-        inline Vec2<T>& operator/= ( const Vec2<T>& v ) {  x /= v.x; y /= v.y; return *this; };
+        inline SIMPLETON_CONSTEXPR Vec2<T>& operator/= ( const Vec2<T>& v ) {  x /= v.x; y /= v.y; return *this; };
     };
 
 
@@ -138,16 +136,14 @@ namespace Simpleton
         inline Vec3 ( ) {};
 
         /// Value constructor
-        inline Vec3 ( const T& vx, const T& vy, const T& vz ) : x(vx), y(vy), z(vz) {};
+        inline SIMPLETON_CONSTEXPR Vec3 ( const T& vx, const T& vy, const T& vz ) : x(vx), y(vy), z(vz) {};
         
-        /// Copy constructor
-        inline Vec3 ( const Vec3<T>& val ) : x(val.x), y(val.y), z(val.z) {};
     
         /// Single value constructor.  Sets all components to the given value
-        inline Vec3 ( const T& v ) : x(v), y(v), z(v) {};
+        inline SIMPLETON_CONSTEXPR Vec3 ( const T& v ) : x(v), y(v), z(v) {};
 
         /// Array constructor.  Assumes a 3-component array
-        inline Vec3 ( const T* v ) : x(v[0]), y(v[1]), z(v[2]) {};
+        inline SIMPLETON_CONSTEXPR Vec3 ( const T* v ) : x(v[0]), y(v[1]), z(v[2]) {};
 
         // *****************************************
         //     Conversions/Assignment/Indexing
@@ -159,67 +155,65 @@ namespace Simpleton
         /// cast to T*
         inline operator T*() { return (T*)this; };
 
-        /// Assignment
-        inline const Vec3<T>& operator=( const Vec3<T>& rhs )  { x = rhs.x; y = rhs.y; z = rhs.z; return *this; };
 
         // *****************************************
         //    Comparison
         // *****************************************
 
         /// Equality comparison
-        inline bool operator==( const Vec3<T>& rhs ) const { return ( x == rhs.x && y == rhs.y && z == rhs.z); };
+        inline SIMPLETON_CONSTEXPR bool operator==( const Vec3<T>& rhs ) const { return ( x == rhs.x && y == rhs.y && z == rhs.z); };
         
         /// Inequality comparision
-        inline bool operator!=( const Vec3<T>& rhs ) const { return ( x != rhs.x || y != rhs.y || z != rhs.z ); };
+        inline SIMPLETON_CONSTEXPR bool operator!=( const Vec3<T>& rhs ) const { return ( x != rhs.x || y != rhs.y || z != rhs.z ); };
 
         // *****************************************
         //    Arithmetic
         // *****************************************
 
         /// Negation
-        inline const Vec3<T> operator-() const { return Vec3<T>( -x, -y, -z ); };
+        inline SIMPLETON_CONSTEXPR const Vec3<T> operator-() const { return Vec3<T>( -x, -y, -z ); };
 
         /// Addition
-        inline const Vec3<T> operator+( const Vec3<T>& rhs ) const { return Vec3<T>( x + rhs.x, y + rhs.y, z + rhs.z ); };
+        inline SIMPLETON_CONSTEXPR const Vec3<T> operator+( const Vec3<T>& rhs ) const { return Vec3<T>( x + rhs.x, y + rhs.y, z + rhs.z ); };
 
         /// Subtraction
-        inline const Vec3<T> operator-( const Vec3<T>& rhs ) const { return Vec3<T>( x - rhs.x, y - rhs.y, z - rhs.z );};
+        inline SIMPLETON_CONSTEXPR const Vec3<T> operator-( const Vec3<T>& rhs ) const { return Vec3<T>( x - rhs.x, y - rhs.y, z - rhs.z );};
 
         /// Multiply by scalar
-        inline const Vec3<T> operator*( const T& v ) const { return Vec3<T>( x*v, y*v, z*v ); };
+        inline SIMPLETON_CONSTEXPR const Vec3<T> operator*( const T& v ) const { return Vec3<T>( x*v, y*v, z*v ); };
 
         /// Multiply by vector
-        inline const Vec3<T> operator*( const Vec3<T>& v ) const { return Vec3<T>( v.x*x, v.y*y, v.z*z ); };
+        inline SIMPLETON_CONSTEXPR const Vec3<T> operator*( const Vec3<T>& v ) const { return Vec3<T>( v.x*x, v.y*y, v.z*z ); };
 
         /// Divide by scalar
-        inline const Vec3<T> operator/( const T& v ) const { return Vec3<T>( x/v, y/v, z/v ); };
+        inline SIMPLETON_CONSTEXPR const Vec3<T> operator/( const T& v ) const { return Vec3<T>( x/v, y/v, z/v ); };
 
         /// Divide by vector
-        const Vec3<T> operator/( const Vec3<T>& rhs ) const { return Vec3<T>( x/rhs.x, y/rhs.y, z/rhs.z ); };
+        inline SIMPLETON_CONSTEXPR const Vec3<T> operator/( const Vec3<T>& rhs ) const { return Vec3<T>( x/rhs.x, y/rhs.y, z/rhs.z ); };
 
         /// Addition in-place
-        inline Vec3<T>& operator+= ( const Vec3<T>& rhs ) { x += rhs.x; y += rhs.y; z += rhs.z; return *this; };
+        inline SIMPLETON_CONSTEXPR Vec3<T>& operator+= ( const Vec3<T>& rhs ) { x += rhs.x; y += rhs.y; z += rhs.z; return *this; };
     
         /// Subtract in-place
-        inline Vec3<T>& operator-= ( const Vec3<T>& rhs ) { x -= rhs.x; y -= rhs.y; z -= rhs.z; return *this; };
+        inline SIMPLETON_CONSTEXPR Vec3<T>& operator-= ( const Vec3<T>& rhs ) { x -= rhs.x; y -= rhs.y; z -= rhs.z; return *this; };
 
         /// Scalar multiply in-place
-        inline Vec3<T>& operator*= ( const T& v ) { x *= v; y *= v; z *= v; return *this; };
+        inline SIMPLETON_CONSTEXPR Vec3<T>& operator*= ( const T& v ) { x *= v; y *= v; z *= v; return *this; };
 
         /// Scalar divide in-place
-        inline Vec3<T>& operator/= ( const T& v ) { x /= v; y /= v; z /= v; return *this; };
+        inline SIMPLETON_CONSTEXPR Vec3<T>& operator/= ( const T& v ) { x /= v; y /= v; z /= v; return *this; };
 
         /// Vector multiply in place
-        inline Vec3<T>& operator*= ( const Vec3<T>& v ) { x *= v.x; y *= v.y; z *= v.z; return *this; };
+        inline SIMPLETON_CONSTEXPR Vec3<T>& operator*= ( const Vec3<T>& v ) { x *= v.x; y *= v.y; z *= v.z; return *this; };
 
         /// Vector divide in-place
-        inline Vec3<T>& operator/= ( const Vec3<T>& v ) {  x /= v.x; y /= v.y; z /= v.z; return *this; };
+        inline SIMPLETON_CONSTEXPR Vec3<T>& operator/= ( const Vec3<T>& v ) {  x /= v.x; y /= v.y; z /= v.z; return *this; };
 
     };
 
     /// Multiply by scalar on left
     template <class T>
-    inline Vec3<T> operator*( float f, const Vec3<T>& rVec ) { return rVec*f; };
+    inline SIMPLETON_CONSTEXPR Vec3<T> operator*( float f, const Vec3<T>& rVec ) { return rVec*f; };
 
     typedef Vec2<float>  Vec2f;
     typedef Vec3<float>  Vec3f;
@@ -275,9 +269,9 @@ namespace Simpleton
     //=====================================================================================================================
     //=====================================================================================================================
     template< class Scalar >
-    inline Scalar Dot3( const Vec3<Scalar>& a, const Vec3<Scalar>& b )
+    inline SIMPLETON_CONSTEXPR Scalar Dot3( const Vec3<Scalar>& a, const Vec3<Scalar>& b )
     {
-        return a[0]*b[0] + a[1]*b[1] + a[2]*b[2];
+        return a.x*b.x + a.y*b.y + a.z*b.z;
     };
 
     
@@ -340,7 +334,7 @@ namespace Simpleton
     //=====================================================================================================================
     //=====================================================================================================================
     template< class Vec3_T_1, class Vec3_T_2 >
-    inline Vec3_T_1 Cross3( const Vec3_T_1& v1, const Vec3_T_2& v2 )
+    inline SIMPLETON_CONSTEXPR Vec3_T_1 Cross3( const Vec3_T_1& v1, const Vec3_T_2& v2 )
     {
         return Vec3_T_1( (v1.y*v2.z) - (v1.z*v2.y),
                          (v1.z*v2.x) - (v1.x*v2.z),
@@ -363,7 +357,7 @@ namespace Simpleton
     // ---------------------------------------------------------------------------------------------------
 
     template< class Scalar1, class Scalar2, class Scalar3 >
-    inline Scalar1 Lerp( const Scalar1& a, const Scalar2& b, const Scalar3& t )
+    inline SIMPLETON_CONSTEXPR Scalar1 Lerp( const Scalar1& a, const Scalar2& b, const Scalar3& t )
     {
         return a + (b-a)*t;
     }
@@ -389,7 +383,7 @@ namespace Simpleton
     // ---------------------------------------------------------------------------------------------------
 
     template< class Scalar_T >
-    inline Scalar_T Clamp( Scalar_T x, Scalar_T xMin, Scalar_T xMax )
+    inline SIMPLETON_CONSTEXPR Scalar_T Clamp( Scalar_T x, Scalar_T xMin, Scalar_T xMax )
     {
         if( x <= xMin ) return xMin;
         if( x >= xMax ) return xMax;
@@ -397,7 +391,7 @@ namespace Simpleton
     }
 
     template< class Scalar_T >
-    inline Scalar_T Clamp_01( Scalar_T x )
+    inline SIMPLETON_CONSTEXPR Scalar_T Clamp_01( Scalar_T x )
     {
         return Clamp( x, Scalar_T(0), Scalar_T(1) );
     };
@@ -533,7 +527,7 @@ namespace Simpleton
     inline Vec3f UniformSampleSphere( float s, float t )
     {
         float fCosTheta = 1.0f - 2.0f*s;
-        float fSinTheta = 2.0f * sqrtf( s*(s-1) );
+        float fSinTheta = 2.0f * sqrtf( s*(1.0f-s) );
         float phi = t*TWOPI_F - PI_f;
         float y = fCosTheta;
         float x = cos(phi)*fSinTheta;
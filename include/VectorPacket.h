@@ -0,0 +1,435 @@
+//=====================================================================================================================
+//
+//   VectorPacket.h
+//
+//   SIMD packet types: float4, float8, and SoA vectors built from them
+//
+//   The lazy man's utility library
+//   Joshua Barczak
+//   Copyright 2016 Joshua Barczak
+//
+//   LICENSE:  See Doc\License.txt for terms and conditions
+//
+//=====================================================================================================================
+
+#ifndef _VECTOR_PACKET_H_
+#define _VECTOR_PACKET_H_
+
+#include <stddef.h>
+#include <xmmintrin.h>
+#include <emmintrin.h>
+#ifdef __AVX__
+    #include <immintrin.h>
+#endif
+
+#include "VectorMath.h"
+
+namespace Simpleton
+{
+
+    //=====================================================================================================================
+    /// \ingroup Simpleton
+    /// \brief Lane mask for float4 comparisons.  Each lane is either all ones or all zeros
+    //=====================================================================================================================
+    class mask4
+    {
+    public:
+        __m128 m;
+
+        mask4() {}
+        mask4( __m128 v ) : m(v) {}
+
+        mask4 operator&( const mask4& r ) const { return _mm_and_ps( m, r.m ); }
+        mask4 operator|( const mask4& r ) const { return _mm_or_ps( m, r.m ); }
+        mask4 operator^( const mask4& r ) const { return _mm_xor_ps( m, r.m ); }
+        mask4 operator~() const { return _mm_xor_ps( m, _mm_castsi128_ps( _mm_set1_epi32(-1) ) ); }
+
+        /// One bit per lane, lane 0 in the low bit
+        int Bits() const { return _mm_movemask_ps(m); }
+    };
+
+    //=====================================================================================================================
+    /// \ingroup Simpleton
+    /// \brief Four floats in an SSE register
+    //=====================================================================================================================
+    class float4
+    {
+    public:
+        enum { WIDTH = 4 };
+
+        __m128 m;
+
+        float4() {}
+        float4( __m128 v ) : m(v) {}
+        float4( float f ) : m( _mm_set1_ps(f) ) {}
+        float4( float a, float b, float c, float d ) : m( _mm_setr_ps(a,b,c,d) ) {}
+
+        static float4 Load( const float* p ) { return _mm_loadu_ps(p); }
+        static float4 LoadAligned( const float* p ) { return _mm_load_ps(p); }
+        void Store( float* p ) const { _mm_storeu_ps(p,m); }
+        void StoreAligned( float* p ) const { _mm_store_ps(p,m); }
+
+        float Lane( int i ) const
+        {
+            float f[4];
+            _mm_storeu_ps(f,m);
+            return f[i];
+        }
+
+        float4 operator-() const { return _mm_xor_ps( m, _mm_set1_ps(-0.0f) ); }
+        float4 operator+( const float4& r ) const { return _mm_add_ps( m, r.m ); }
+        float4 operator-( const float4& r ) const { return _mm_sub_ps( m, r.m ); }
+        float4 operator*( const float4& r ) const { return _mm_mul_ps( m, r.m ); }
+        float4 operator/( const float4& r ) const { return _mm_div_ps( m, r.m ); }
+
+        float4& operator+=( const float4& r ) { m = _mm_add_ps( m, r.m ); return *this; }
+        float4& operator-=( const float4& r ) { m = _mm_sub_ps( m, r.m ); return *this; }
+        float4& operator*=( const float4& r ) { m = _mm_mul_ps( m, r.m ); return *this; }
+        float4& operator/=( const float4& r ) { m = _mm_div_ps( m, r.m ); return *this; }
+
+        mask4 operator< ( const float4& r ) const { return _mm_cmplt_ps( m, r.m ); }
+        mask4 operator<=( const float4& r ) const { return _mm_cmple_ps( m, r.m ); }
+        mask4 operator> ( const float4& r ) const { return _mm_cmpgt_ps( m, r.m ); }
+        mask4 operator>=( const float4& r ) const { return _mm_cmpge_ps( m, r.m ); }
+        mask4 operator==( const float4& r ) const { return _mm_cmpeq_ps( m, r.m ); }
+        mask4 operator!=( const float4& r ) const { return _mm_cmpneq_ps( m, r.m ); }
+    };
+
+    inline float4 operator+( float a, const float4& b ) { return float4(a) + b; }
+    inline float4 operator-( float a, const float4& b ) { return float4(a) - b; }
+    inline float4 operator*( float a, const float4& b ) { return float4(a) * b; }
+    inline float4 operator/( float a, const float4& b ) { return float4(a) / b; }
+
+    inline bool Any ( const mask4& k ) { return k.Bits() != 0; }
+    inline bool All ( const mask4& k ) { return k.Bits() == 0xf; }
+    inline bool None( const mask4& k ) { return k.Bits() == 0; }
+
+    /// Per-lane k ? a : b
+    inline float4 Select( const mask4& k, const float4& a, const float4& b )
+    {
+        return _mm_or_ps( _mm_and_ps( k.m, a.m ), _mm_andnot_ps( k.m, b.m ) );
+    }
+
+    inline float4 Min( const float4& a, const float4& b ) { return _mm_min_ps( a.m, b.m ); }
+    inline float4 Max( const float4& a, const float4& b ) { return _mm_max_ps( a.m, b.m ); }
+    inline float4 Sqrt( const float4& a ) { return _mm_sqrt_ps( a.m ); }
+    inline float4 Abs( const float4& a ) { return _mm_andnot_ps( _mm_set1_ps(-0.0f), a.m ); }
+
+
+#ifdef __AVX__
+
+    //=====================================================================================================================
+    /// \ingroup Simpleton
+    /// \brief Lane mask for float8 comparisons
+    //=====================================================================================================================
+    class mask8
+    {
+    public:
+        __m256 m;
+
+        mask8() {}
+        mask8( __m256 v ) : m(v) {}
+
+        mask8 operator&( const mask8& r ) const { return _mm256_and_ps( m, r.m ); }
+        mask8 operator|( const mask8& r ) const { return _mm256_or_ps( m, r.m ); }
+        mask8 operator^( const mask8& r ) const { return _mm256_xor_ps( m, r.m ); }
+        mask8 operator~() const { return _mm256_xor_ps( m, _mm256_castsi256_ps( _mm256_set1_epi32(-1) ) ); }
+
+        int Bits() const { return _mm256_movemask_ps(m); }
+    };
+
+    //=====================================================================================================================
+    /// \ingroup Simpleton
+    /// \brief Eight floats in an AVX register
+    //=====================================================================================================================
+    class float8
+    {
+    public:
+        enum { WIDTH = 8 };
+
+        __m256 m;
+
+        float8() {}
+        float8( __m256 v ) : m(v) {}
+        float8( float f ) : m( _mm256_set1_ps(f) ) {}
+        float8( const float4& lo, const float4& hi ) : m( _mm256_insertf128_ps( _mm256_castps128_ps256(lo.m), hi.m, 1 ) ) {}
+
+        static float8 Load( const float* p ) { return _mm256_loadu_ps(p); }
+        static float8 LoadAligned( const float* p ) { return _mm256_load_ps(p); }
+        void Store( float* p ) const { _mm256_storeu_ps(p,m); }
+        void StoreAligned( float* p ) const { _mm256_store_ps(p,m); }
+
+        float4 Lo() const { return _mm256_castps256_ps128(m); }
+        float4 Hi() const { return _mm256_extractf128_ps(m,1); }
+
+        float Lane( int i ) const
+        {
+            float f[8];
+            _mm256_storeu_ps(f,m);
+            return f[i];
+        }
+
+        float8 operator-() const { return _mm256_xor_ps( m, _mm256_set1_ps(-0.0f) ); }
+        float8 operator+( const float8& r ) const { return _mm256_add_ps( m, r.m ); }
+        float8 operator-( const float8& r ) const { return _mm256_sub_ps( m, r.m ); }
+        float8 operator*( const float8& r ) const { return _mm256_mul_ps( m, r.m ); }
+        float8 operator/( const float8& r ) const { return _mm256_div_ps( m, r.m ); }
+
+        float8& operator+=( const float8& r ) { m = _mm256_add_ps( m, r.m ); return *this; }
+        float8& operator-=( const float8& r ) { m = _mm256_sub_ps( m, r.m ); return *this; }
+        float8& operator*=( const float8& r ) { m = _mm256_mul_ps( m, r.m ); return *this; }
+        float8& operator/=( const float8& r ) { m = _mm256_div_ps( m, r.m ); return *this; }
+
+        mask8 operator< ( const float8& r ) const { return _mm256_cmp_ps( m, r.m, _CMP_LT_OQ ); }
+        mask8 operator<=( const float8& r ) const { return _mm256_cmp_ps( m, r.m, _CMP_LE_OQ ); }
+        mask8 operator> ( const float8& r ) const { return _mm256_cmp_ps( m, r.m, _CMP_GT_OQ ); }
+        mask8 operator>=( const float8& r ) const { return _mm256_cmp_ps( m, r.m, _CMP_GE_OQ ); }
+        mask8 operator==( const float8& r ) const { return _mm256_cmp_ps( m, r.m, _CMP_EQ_OQ ); }
+        mask8 operator!=( const float8& r ) const { return _mm256_cmp_ps( m, r.m, _CMP_NEQ_UQ ); }
+    };
+
+    inline bool Any ( const mask8& k ) { return k.Bits() != 0; }
+    inline bool All ( const mask8& k ) { return k.Bits() == 0xff; }
+    inline bool None( const mask8& k ) { return k.Bits() == 0; }
+
+    inline float8 Select( const mask8& k, const float8& a, const float8& b ) { return _mm256_blendv_ps( b.m, a.m, k.m ); }
+    inline float8 Min( const float8& a, const float8& b ) { return _mm256_min_ps( a.m, b.m ); }
+    inline float8 Max( const float8& a, const float8& b ) { return _mm256_max_ps( a.m, b.m ); }
+    inline float8 Sqrt( const float8& a ) { return _mm256_sqrt_ps( a.m ); }
+    inline float8 Abs( const float8& a ) { return _mm256_andnot_ps( _mm256_set1_ps(-0.0f), a.m ); }
+
+#else
+
+    //=====================================================================================================================
+    /// \ingroup Simpleton
+    /// \brief Lane mask for float8 comparisons.  Pre-AVX version is a pair of SSE masks
+    //=====================================================================================================================
+    class mask8
+    {
+    public:
+        mask4 lo;
+        mask4 hi;
+
+        mask8() {}
+        mask8( const mask4& l, const mask4& h ) : lo(l), hi(h) {}
+
+        mask8 operator&( const mask8& r ) const { return mask8( lo & r.lo, hi & r.hi ); }
+        mask8 operator|( const mask8& r ) const { return mask8( lo | r.lo, hi | r.hi ); }
+        mask8 operator^( const mask8& r ) const { return mask8( lo ^ r.lo, hi ^ r.hi ); }
+        mask8 operator~() const { return mask8( ~lo, ~hi ); }
+
+        int Bits() const { return lo.Bits() | (hi.Bits() << 4); }
+    };
+
+    //=====================================================================================================================
+    /// \ingroup Simpleton
+    /// \brief Eight floats.  Pre-AVX version is a pair of SSE registers
+    //=====================================================================================================================
+    class float8
+    {
+    public:
+        enum { WIDTH = 8 };
+
+        float4 lo;
+        float4 hi;
+
+        float8() {}
+        float8( float f ) : lo(f), hi(f) {}
+        float8( const float4& l, const float4& h ) : lo(l), hi(h) {}
+
+        static float8 Load( const float* p ) { return float8( float4::Load(p), float4::Load(p+4) ); }
+        static float8 LoadAligned( const float* p ) { return float8( float4::LoadAligned(p), float4::LoadAligned(p+4) ); }
+        void Store( float* p ) const { lo.Store(p); hi.Store(p+4); }
+        void StoreAligned( float* p ) const { lo.StoreAligned(p); hi.StoreAligned(p+4); }
+
+        float4 Lo() const { return lo; }
+        float4 Hi() const { return hi; }
+
+        float Lane( int i ) const { return (i < 4) ? lo.Lane(i) : hi.Lane(i-4); }
+
+        float8 operator-() const { return float8( -lo, -hi ); }
+        float8 operator+( const float8& r ) const { return float8( lo+r.lo, hi+r.hi ); }
+        float8 operator-( const float8& r ) const { return float8( lo-r.lo, hi-r.hi ); }
+        float8 operator*( const float8& r ) const { return float8( lo*r.lo, hi*r.hi ); }
+        float8 operator/( const float8& r ) const { return float8( lo/r.lo, hi/r.hi ); }
+
+        float8& operator+=( const float8& r ) { lo += r.lo; hi += r.hi; return *this; }
+        float8& operator-=( const float8& r ) { lo -= r.lo; hi -= r.hi; return *this; }
+        float8& operator*=( const float8& r ) { lo *= r.lo; hi *= r.hi; return *this; }
+        float8& operator/=( const float8& r ) { lo /= r.lo; hi /= r.hi; return *this; }
+
+        mask8 operator< ( const float8& r ) const { return mask8( lo <  r.lo, hi <  r.hi ); }
+        mask8 operator<=( const float8& r ) const { return mask8( lo <= r.lo, hi <= r.hi ); }
+        mask8 operator> ( const float8& r ) const { return mask8( lo >  r.lo, hi >  r.hi ); }
+        mask8 operator>=( const float8& r ) const { return mask8( lo >= r.lo, hi >= r.hi ); }
+        mask8 operator==( const float8& r ) const { return mask8( lo == r.lo, hi == r.hi ); }
+        mask8 operator!=( const float8& r ) const { return mask8( lo != r.lo, hi != r.hi ); }
+    };
+
+    inline bool Any ( const mask8& k ) { return k.Bits() != 0; }
+    inline bool All ( const mask8& k ) { return k.Bits() == 0xff; }
+    inline bool None( const mask8& k ) { return k.Bits() == 0; }
+
+    inline float8 Select( const mask8& k, const float8& a, const float8& b ) { return float8( Select(k.lo,a.lo,b.lo), Select(k.hi,a.hi,b.hi) ); }
+    inline float8 Min( const float8& a, const float8& b ) { return float8( Min(a.lo,b.lo), Min(a.hi,b.hi) ); }
+    inline float8 Max( const float8& a, const float8& b ) { return float8( Max(a.lo,b.lo), Max(a.hi,b.hi) ); }
+    inline float8 Sqrt( const float8& a ) { return float8( Sqrt(a.lo), Sqrt(a.hi) ); }
+    inline float8 Abs( const float8& a ) { return float8( Abs(a.lo), Abs(a.hi) ); }
+
+#endif
+
+    inline float8 operator+( float a, const float8& b ) { return float8(a) + b; }
+    inline float8 operator-( float a, const float8& b ) { return float8(a) - b; }
+    inline float8 operator*( float a, const float8& b ) { return float8(a) * b; }
+    inline float8 operator/( float a, const float8& b ) { return float8(a) / b; }
+
+
+    //=====================================================================================================================
+    /// \ingroup Simpleton
+    /// \brief A packet of 3-component vectors, stored SoA.  Lane i of x,y,z holds vector i.
+    ///
+    ///   Supports the same operators as Vec3, so that VectorMath templates which only use arithmetic
+    ///     (Cross3, Lerp3, etc) work unchanged.  Dot3, Length3 and Normalize3 have packet overloads below.
+    ///
+    //=====================================================================================================================
+    template< class F >
+    class Vec3Packet
+    {
+    public:
+        enum { WIDTH = F::WIDTH };
+
+        F x;
+        F y;
+        F z;
+
+        Vec3Packet() {}
+        Vec3Packet( const F& vx, const F& vy, const F& vz ) : x(vx), y(vy), z(vz) {}
+
+        /// Broadcasts one vector to all lanes
+        explicit Vec3Packet( const Vec3f& v ) : x(v.x), y(v.y), z(v.z) {}
+
+        const F& operator[]( int i ) const { return (&x)[i]; }
+        F& operator[]( int i ) { return (&x)[i]; }
+
+        Vec3Packet operator-() const { return Vec3Packet( -x, -y, -z ); }
+        Vec3Packet operator+( const Vec3Packet& r ) const { return Vec3Packet( x+r.x, y+r.y, z+r.z ); }
+        Vec3Packet operator-( const Vec3Packet& r ) const { return Vec3Packet( x-r.x, y-r.y, z-r.z ); }
+        Vec3Packet operator*( const Vec3Packet& r ) const { return Vec3Packet( x*r.x, y*r.y, z*r.z ); }
+        Vec3Packet operator/( const Vec3Packet& r ) const { return Vec3Packet( x/r.x, y/r.y, z/r.z ); }
+        Vec3Packet operator*( const F& s ) const { return Vec3Packet( x*s, y*s, z*s ); }
+        Vec3Packet operator/( const F& s ) const { F r = F(1.0f)/s; return Vec3Packet( x*r, y*r, z*r ); }
+
+        Vec3Packet& operator+=( const Vec3Packet& r ) { x += r.x; y += r.y; z += r.z; return *this; }
+        Vec3Packet& operator-=( const Vec3Packet& r ) { x -= r.x; y -= r.y; z -= r.z; return *this; }
+        Vec3Packet& operator*=( const F& s ) { x *= s; y *= s; z *= s; return *this; }
+    };
+
+    typedef Vec3Packet<float4> Vec3x4;
+    typedef Vec3Packet<float8> Vec3x8;
+
+    template< class F >
+    inline Vec3Packet<F> operator*( const F& s, const Vec3Packet<F>& v ) { return v*s; }
+
+    template< class F >
+    inline F Dot3( const Vec3Packet<F>& a, const Vec3Packet<F>& b ) { return a.x*b.x + a.y*b.y + a.z*b.z; }
+
+    template< class F >
+    inline F Length3Sq( const Vec3Packet<F>& a ) { return Dot3(a,a); }
+
+    template< class F >
+    inline F Length3( const Vec3Packet<F>& a ) { return Sqrt( Dot3(a,a) ); }
+
+    template< class F >
+    inline Vec3Packet<F> Normalize3( const Vec3Packet<F>& a ) { return a * ( F(1.0f) / Length3(a) ); }
+
+    template< class F, class M >
+    inline Vec3Packet<F> Select( const M& k, const Vec3Packet<F>& a, const Vec3Packet<F>& b )
+    {
+        return Vec3Packet<F>( Select(k,a.x,b.x), Select(k,a.y,b.y), Select(k,a.z,b.z) );
+    }
+
+    template< class F >
+    inline Vec3Packet<F> Min( const Vec3Packet<F>& a, const Vec3Packet<F>& b )
+    {
+        return Vec3Packet<F>( Min(a.x,b.x), Min(a.y,b.y), Min(a.z,b.z) );
+    }
+
+    template< class F >
+    inline Vec3Packet<F> Max( const Vec3Packet<F>& a, const Vec3Packet<F>& b )
+    {
+        return Vec3Packet<F>( Max(a.x,b.x), Max(a.y,b.y), Max(a.z,b.z) );
+    }
+
+
+    //=====================================================================================================================
+    //  AoS conversion.  Strides are in bytes.  The 'Partial' forms handle the left-over vectors at the end of an array,
+    //    filling unused lanes with zero on load, and leaving memory past the last vector untouched on store.
+    //=====================================================================================================================
+
+    namespace _INTERNAL
+    {
+        /// Loads (x,y,z,0) without reading past the end of the vector
+        inline __m128 LoadVec3( const void* p )
+        {
+            const float* pF = (const float*) p;
+            return _mm_movelh_ps( _mm_loadl_pi( _mm_setzero_ps(), (const __m64*) pF ), _mm_load_ss(pF+2) );
+        }
+
+        inline void StoreVec3( void* p, __m128 v )
+        {
+            float* pF = (float*) p;
+            _mm_storel_pi( (__m64*) pF, v );
+            _mm_store_ss( pF+2, _mm_movehl_ps(v,v) );
+        }
+    }
+
+    inline void LoadAoSPartial( Vec3x4& v, const Vec3f* p, size_t nCount, size_t nStride=sizeof(Vec3f) )
+    {
+        const char* pBytes = (const char*) p;
+        __m128 r[4];
+        for( size_t i=0; i<4; i++ )
+            r[i] = (i < nCount) ? _INTERNAL::LoadVec3( pBytes + i*nStride ) : _mm_setzero_ps();
+
+        _MM_TRANSPOSE4_PS( r[0], r[1], r[2], r[3] );
+        v.x = r[0];
+        v.y = r[1];
+        v.z = r[2];
+    }
+
+    inline void StoreAoSPartial( Vec3f* p, const Vec3x4& v, size_t nCount, size_t nStride=sizeof(Vec3f) )
+    {
+        char* pBytes = (char*) p;
+        __m128 r[4] = { v.x.m, v.y.m, v.z.m, _mm_setzero_ps() };
+        _MM_TRANSPOSE4_PS( r[0], r[1], r[2], r[3] );
+        for( size_t i=0; i<4 && i<nCount; i++ )
+            _INTERNAL::StoreVec3( pBytes + i*nStride, r[i] );
+    }
+
+    inline void LoadAoS( Vec3x4& v, const Vec3f* p, size_t nStride=sizeof(Vec3f) ) { LoadAoSPartial( v, p, 4, nStride ); }
+    inline void StoreAoS( Vec3f* p, const Vec3x4& v, size_t nStride=sizeof(Vec3f) ) { StoreAoSPartial( p, v, 4, nStride ); }
+
+    inline void LoadAoSPartial( Vec3x8& v, const Vec3f* p, size_t nCount, size_t nStride=sizeof(Vec3f) )
+    {
+        const Vec3f* pHi = (const Vec3f*)( (const char*)p + 4*nStride );
+        Vec3x4 lo, hi;
+        LoadAoSPartial( lo, p, nCount, nStride );
+        LoadAoSPartial( hi, pHi, (nCount > 4) ? nCount-4 : 0, nStride );
+        v.x = float8( lo.x, hi.x );
+        v.y = float8( lo.y, hi.y );
+        v.z = float8( lo.z, hi.z );
+    }
+
+    inline void StoreAoSPartial( Vec3f* p, const Vec3x8& v, size_t nCount, size_t nStride=sizeof(Vec3f) )
+    {
+        Vec3f* pHi = (Vec3f*)( (char*)p + 4*nStride );
+        StoreAoSPartial( p, Vec3x4( v.x.Lo(), v.y.Lo(), v.z.Lo() ), nCount, nStride );
+        if( nCount > 4 )
+            StoreAoSPartial( pHi, Vec3x4( v.x.Hi(), v.y.Hi(), v.z.Hi() ), nCount-4, nStride );
+    }
+
+    inline void LoadAoS( Vec3x8& v, const Vec3f* p, size_t nStride=sizeof(Vec3f) ) { LoadAoSPartial( v, p, 8, nStride ); }
+    inline void StoreAoS( Vec3f* p, const Vec3x8& v, size_t nStride=sizeof(Vec3f) ) { StoreAoSPartial( p, v, 8, nStride ); }
+
+}
+
+#endif // _VECTOR_PACKET_H_
@@ -0,0 +1,178 @@
+//=====================================================================================================================
+//
+//   WorkStealingDeque.h
+//
+//   Definition of class: Simpleton::WorkStealingDeque
+//
+//   The lazy man's utility library
+//   Joshua Barczak
+//   Copyright 2016 Joshua Barczak
+//
+//   LICENSE:  See Doc\License.txt for terms and conditions
+//
+//=====================================================================================================================
+
+#ifndef _WORK_STEALING_DEQUE_H_
+#define _WORK_STEALING_DEQUE_H_
+
+#include <atomic>
+#include <vector>
+#include "Types.h"
+
+namespace Simpleton
+{
+
+    //=====================================================================================================================
+    /// \ingroup Simpleton
+    /// \brief Chase-Lev work stealing deque
+    ///
+    ///   One thread (the owner) pushes and pops at the bottom end, without taking any locks.
+    ///    Any number of other threads may steal from the top end.
+    ///
+    ///   The ring buffer grows on demand.  Retired buffers are kept alive until the deque is destroyed,
+    ///     since a thief may still be reading from them.
+    ///
+    ///   Memory ordering follows Le, Pop, Cohen, Nardelli: "Correct and Efficient Work-Stealing for Weak Memory Models"
+    ///
+    //=====================================================================================================================
+    template< class T >
+    class WorkStealingDeque
+    {
+    public:
+
+        WorkStealingDeque( int64 nInitialCapacity=256 ) : m_nTop(0), m_nBottom(0)
+        {
+            int64 nCapacity = 1;
+            while( nCapacity < nInitialCapacity )
+                nCapacity *= 2;
+
+            Array* pArray = new Array(nCapacity);
+            m_Arrays.push_back(pArray);
+            m_pArray.store( pArray, std::memory_order_relaxed );
+        }
+
+        ~WorkStealingDeque()
+        {
+            for( size_t i=0; i<m_Arrays.size(); i++ )
+                delete m_Arrays[i];
+        }
+
+        //=====================================================================================================================
+        /// Push an item onto the bottom of the deque.  May only be called by the owning thread
+        //=====================================================================================================================
+        void Push( T* pItem )
+        {
+            int64 b = m_nBottom.load( std::memory_order_relaxed );
+            int64 t = m_nTop.load( std::memory_order_acquire );
+            Array* pArray = m_pArray.load( std::memory_order_relaxed );
+            if( b - t > pArray->nCapacity-1 )
+                pArray = Grow( pArray, t, b );
+
+            pArray->Put( b, pItem );
+            std::atomic_thread_fence( std::memory_order_release );
+            m_nBottom.store( b+1, std::memory_order_relaxed );
+        }
+
+        //=====================================================================================================================
+        /// Pop an item from the bottom of the deque.  May only be called by the owning thread
+        /// \return The most recently pushed item, or null if the deque is empty
+        //=====================================================================================================================
+        T* Pop()
+        {
+            int64 b = m_nBottom.load( std::memory_order_relaxed ) - 1;
+            Array* pArray = m_pArray.load( std::memory_order_relaxed );
+            m_nBottom.store( b, std::memory_order_relaxed );
+            std::atomic_thread_fence( std::memory_order_seq_cst );
+            int64 t = m_nTop.load( std::memory_order_relaxed );
+
+            if( t > b )
+            {
+                // empty
+                m_nBottom.store( b+1, std::memory_order_relaxed );
+                return 0;
+            }
+
+            T* pItem = pArray->Get(b);
+            if( t == b )
+            {
+                // last item.  Race against thieves for it
+                if( !m_nTop.compare_exchange_strong( t, t+1, std::memory_order_seq_cst, std::memory_order_relaxed ) )
+                    pItem = 0;
+                m_nBottom.store( b+1, std::memory_order_relaxed );
+            }
+
+            return pItem;
+        }
+
+        //=====================================================================================================================
+        /// Steal an item from the top of the deque.  May be called by any thread
+        /// \return The oldest item in the deque, or null if the deque was empty or another thread won the race for the item
+        //=====================================================================================================================
+        T* Steal()
+        {
+            int64 t = m_nTop.load( std::memory_order_acquire );
+            std::atomic_thread_fence( std::memory_order_seq_cst );
+            int64 b = m_nBottom.load( std::memory_order_acquire );
+            if( t >= b )
+                return 0;
+
+            Array* pArray = m_pArray.load( std::memory_order_acquire );
+            T* pItem = pArray->Get(t);
+            if( !m_nTop.compare_exchange_strong( t, t+1, std::memory_order_seq_cst, std::memory_order_relaxed ) )
+                return 0;
+
+            return pItem;
+        }
+
+        //=====================================================================================================================
+        /// Racy emptiness check.  Used by thieves to decide whether a failed steal is worth retrying
+        //=====================================================================================================================
+        bool IsEmpty() const
+        {
+            int64 t = m_nTop.load( std::memory_order_relaxed );
+            int64 b = m_nBottom.load( std::memory_order_relaxed );
+            return t >= b;
+        }
+
+    private:
+
+        WorkStealingDeque( const WorkStealingDeque& );
+        WorkStealingDeque& operator=( const WorkStealingDeque& );
+
+        struct Array
+        {
+            Array( int64 n ) : nCapacity(n), nMask(n-1), pItems( new std::atomic<T*>[n] ) {}
+            ~Array() { delete[] pItems; }
+
+            T* Get( int64 i ) const { return pItems[i & nMask].load( std::memory_order_relaxed ); }
+            void Put( int64 i, T* p ) { pItems[i & nMask].store( p, std::memory_order_relaxed ); }
+
+            int64 nCapacity;
+            int64 nMask;
+            std::atomic<T*>* pItems;
+        };
+
+        Array* Grow( Array* pOld, int64 t, int64 b )
+        {
+            Array* pNew = new Array( 2*pOld->nCapacity );
+            for( int64 i=t; i<b; i++ )
+                pNew->Put( i, pOld->Get(i) );
+
+            m_Arrays.push_back(pNew);
+            m_pArray.store( pNew, std::memory_order_release );
+            return pNew;
+        }
+
+        // top and bottom are written by different threads.  Keep them on separate cache lines
+        std::atomic<int64> m_nTop;
+        char m_Pad0[64];
+        std::atomic<int64> m_nBottom;
+        std::atomic<Array*> m_pArray;
+        char m_Pad1[64];
+
+        std::vector<Array*> m_Arrays;   ///< Every array ever allocated, owned by the deque
+    };
+
+}
+
+#endif // _WORK_STEALING_DEQUE_H_
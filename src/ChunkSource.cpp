@@ -0,0 +1,163 @@
+//=====================================================================================================================
+//
+//   ChunkSource.cpp
+//
+//   Implementation of class: Simpleton::ChunkSource
+//
+//   The lazy man's utility library
+//   Joshua Barczak
+//   Copyright 2016 Joshua Barczak
+//
+//   LICENSE:  See Doc\License.txt for terms and conditions
+//
+//=====================================================================================================================
+
+#include "ChunkSource.h"
+#include <stdlib.h>
+
+#ifdef WIN32
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+#endif
+
+namespace Simpleton
+{
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    ChunkSource* ChunkSource::GetDefault()
+    {
+        static MallocChunkSource s_Malloc;
+        return &s_Malloc;
+    }
+
+    //=====================================================================================================================
+    //
+    //            MallocChunkSource
+    //
+    //=====================================================================================================================
+
+    void* MallocChunkSource::AllocChunk( size_t nBytes )
+    {
+        return malloc( nBytes );
+    }
+
+    void MallocChunkSource::FreeChunk( void* pChunk, size_t /*nBytes*/ )
+    {
+        free( pChunk );
+    }
+
+    //=====================================================================================================================
+    //
+    //            LargePageChunkSource
+    //
+    //=====================================================================================================================
+
+    LargePageChunkSource::LargePageChunkSource() : m_nPageSize( 2*1024*1024 ), m_bUseLargePages(true)
+    {
+#ifdef WIN32
+        size_t nLargePage = GetLargePageMinimum();
+        if( nLargePage )
+            m_nPageSize = nLargePage;
+#endif
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void* LargePageChunkSource::AllocChunk( size_t nBytes )
+    {
+        nBytes = RoundUp( nBytes );
+
+#ifdef WIN32
+        if( m_bUseLargePages.load( std::memory_order_relaxed ) )
+        {
+            void* p = VirtualAlloc( 0, nBytes, MEM_RESERVE|MEM_COMMIT|MEM_LARGE_PAGES, PAGE_READWRITE );
+            if( p )
+                return p;
+            m_bUseLargePages.store( false, std::memory_order_relaxed );
+        }
+
+        return VirtualAlloc( 0, nBytes, MEM_RESERVE|MEM_COMMIT, PAGE_READWRITE );
+#else
+    #ifdef MAP_HUGETLB
+        if( m_bUseLargePages.load( std::memory_order_relaxed ) )
+        {
+            void* p = mmap( 0, nBytes, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB, -1, 0 );
+            if( p != MAP_FAILED )
+                return p;
+            m_bUseLargePages.store( false, std::memory_order_relaxed );
+        }
+    #endif
+
+        // Over-allocate so that we can trim the mapping to a page boundary.
+        //   Transparent huge pages can only back page-aligned ranges
+        size_t nMapped = nBytes + m_nPageSize;
+        char* pMap = (char*) mmap( 0, nMapped, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0 );
+        if( pMap == MAP_FAILED )
+            return 0;
+
+        char* p = (char*)( ((size_t)pMap + m_nPageSize-1) & ~(m_nPageSize-1) );
+        size_t nHead = p - pMap;
+        size_t nTail = nMapped - nHead - nBytes;
+        if( nHead )
+            munmap( pMap, nHead );
+        if( nTail )
+            munmap( p + nBytes, nTail );
+
+    #ifdef MADV_HUGEPAGE
+        madvise( p, nBytes, MADV_HUGEPAGE );
+    #endif
+        return p;
+#endif
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void LargePageChunkSource::FreeChunk( void* pChunk, size_t nBytes )
+    {
+#ifdef WIN32
+        VirtualFree( pChunk, 0, MEM_RELEASE );
+#else
+        munmap( pChunk, RoundUp( nBytes ) );
+#endif
+    }
+
+    //=====================================================================================================================
+    //
+    //            RegionChunkSource
+    //
+    //=====================================================================================================================
+
+    RegionChunkSource::RegionChunkSource( void* pRegion, size_t nBytes, ChunkSource* pFallback )
+        : m_pRegion( (char*)pRegion ), m_nSize( nBytes ), m_nOffset(0), m_pFallback( pFallback )
+    {
+        // keep chunks 16-byte aligned
+        size_t nMisalign = (16 - ((size_t)m_pRegion & 15)) & 15;
+        m_nOffset.store( nMisalign < nBytes ? nMisalign : nBytes );
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void* RegionChunkSource::AllocChunk( size_t nBytes )
+    {
+        nBytes = (nBytes + 15) & ~(size_t)15;
+
+        size_t nOffset = m_nOffset.load( std::memory_order_relaxed );
+        while( nOffset + nBytes <= m_nSize )
+        {
+            if( m_nOffset.compare_exchange_weak( nOffset, nOffset + nBytes, std::memory_order_relaxed ) )
+                return m_pRegion + nOffset;
+        }
+
+        return m_pFallback ? m_pFallback->AllocChunk( nBytes ) : 0;
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void RegionChunkSource::FreeChunk( void* pChunk, size_t nBytes )
+    {
+        if( !IsInRegion(pChunk) && m_pFallback )
+            m_pFallback->FreeChunk( pChunk, (nBytes + 15) & ~(size_t)15 );
+    }
+}
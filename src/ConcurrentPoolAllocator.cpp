@@ -0,0 +1,180 @@
+//=====================================================================================================================
+//
+//   ConcurrentPoolAllocator.cpp
+//
+//   Thread-safe pooled memory allocator for batching small mallocs
+//
+//   The lazy man's utility library
+//   Joshua Barczak
+//   Copyright 2016 Joshua Barczak
+//
+//   LICENSE:  See Doc\License.txt for terms and conditions
+//
+//=====================================================================================================================
+
+#include "Types.h"
+#include "ConcurrentPoolAllocator.h"
+#include <stdlib.h>
+
+namespace Simpleton
+{
+    namespace
+    {
+        /// A thread's current chunk in one particular allocator
+        struct ThreadChunk
+        {
+            uint64 nAllocatorID;
+            void* pChunk;
+        };
+
+        enum
+        {
+            THREAD_CACHE_SIZE = 16  ///< Number of allocators a thread can be using at once without thrashing
+        };
+
+        /// Fully associative, most recently used first.  Entries for dead or recycled allocators age out to the end,
+        ///  and are the first to be replaced.  If a thread cycles through more live allocators than this, the evicted
+        ///  allocator abandons the rest of its chunk, and grabs a new one next time
+        THREAD_LOCAL ThreadChunk t_Chunks[THREAD_CACHE_SIZE];
+
+        /// Returns the thread's chunk for the given allocator, or NULL.  Moves its entry to the front
+        inline void* FindThreadChunk( uint64 nID )
+        {
+            if( t_Chunks[0].nAllocatorID == nID )
+                return t_Chunks[0].pChunk;
+
+            for( uint i=1; i<THREAD_CACHE_SIZE; i++ )
+            {
+                if( t_Chunks[i].nAllocatorID == nID )
+                {
+                    ThreadChunk hit = t_Chunks[i];
+                    for( uint j=i; j>0; j-- )
+                        t_Chunks[j] = t_Chunks[j-1];
+                    t_Chunks[0] = hit;
+                    return hit.pChunk;
+                }
+            }
+            return 0;
+        }
+
+        /// Makes 'pChunk' the thread's chunk for the given allocator.  Replaces the least recently used entry if need be
+        inline void SetThreadChunk( uint64 nID, void* pChunk )
+        {
+            uint i = 0;
+            while( i < THREAD_CACHE_SIZE-1 && t_Chunks[i].nAllocatorID != nID )
+                i++;
+            for( ; i>0; i-- )
+                t_Chunks[i] = t_Chunks[i-1];
+            t_Chunks[0].nAllocatorID = nID;
+            t_Chunks[0].pChunk = pChunk;
+        }
+
+        /// Source of allocator IDs.  Zero is never handed out, so that empty cache entries never match
+        std::atomic<uint64> g_nNextID(1);
+
+        void FreeChain( LockFreeStack::Node* pNode )
+        {
+            while( pNode )
+            {
+                LockFreeStack::Node* pNext = LockFreeStack::Next(pNode);
+                free(pNode);
+                pNode = pNext;
+            }
+        }
+    }
+
+    ConcurrentPoolAllocator::ConcurrentPoolAllocator() : m_nID( g_nNextID.fetch_add(1) )
+    {
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void* ConcurrentPoolAllocator::GetMore( size_t nSize )
+    {
+        // pad allocs
+        nSize = (nSize + ALIGN-1) & ~(size_t)(ALIGN-1);
+
+        Chunk* pChunk = static_cast<Chunk*>( FindThreadChunk( m_nID.load( std::memory_order_relaxed ) ) );
+        if( pChunk && pChunk->nOffset + nSize <= pChunk->nCapacity )
+        {
+            size_t nOffs = pChunk->nOffset;
+            pChunk->nOffset += nSize;
+            return ((char*)pChunk) + nOffs;
+        }
+
+        return GetMoreSlow( nSize );
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void ConcurrentPoolAllocator::FreeAll()
+    {
+        m_AvailableChunks.clear();
+        FreeChain( m_AllChunks.pop_all() );
+        FreeChain( m_LargeChunks.pop_all() );
+
+        m_nID.store( g_nNextID.fetch_add(1) );
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void ConcurrentPoolAllocator::Recycle()
+    {
+        // Chunks are handed out by popping the available list, which never modifies the links.
+        //  So the list of all chunks can be re-used wholesale as the new available list
+        m_AvailableChunks.CopyFrom( m_AllChunks );
+
+        // Big allocs are all different sizes, and can't be put back on the available list without breaking its links.
+        //   Just release them
+        FreeChain( m_LargeChunks.pop_all() );
+
+        m_nID.store( g_nNextID.fetch_add(1) );
+    }
+
+    //=====================================================================================================================
+    /// Called when the thread has no chunk, or its chunk is full
+    //=====================================================================================================================
+    void* ConcurrentPoolAllocator::GetMoreSlow( size_t nSize )
+    {
+        Chunk* pChunk;
+        if( HEADER_SIZE + nSize > CHUNKSIZE )
+        {
+            // big alloc gets its own chunk.  Keep using the current one for subsequent small allocs
+            pChunk = NewChunk( HEADER_SIZE + nSize );
+            if( !pChunk )
+                return 0;
+            m_LargeChunks.push_front( pChunk );
+        }
+        else
+        {
+            pChunk = static_cast<Chunk*>( m_AvailableChunks.pop_front() );
+            if( !pChunk )
+            {
+                pChunk = NewChunk( CHUNKSIZE );
+                if( !pChunk )
+                    return 0;
+                m_AllChunks.push_front( pChunk );
+            }
+
+            SetThreadChunk( m_nID.load( std::memory_order_relaxed ), pChunk );
+        }
+
+        pChunk->nOffset = HEADER_SIZE + nSize;
+        return ((char*)pChunk) + HEADER_SIZE;
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    ConcurrentPoolAllocator::Chunk* ConcurrentPoolAllocator::NewChunk( size_t nBytes )
+    {
+        nBytes = (nBytes + CHUNKSIZE-1) & ~(size_t)(CHUNKSIZE-1);
+
+        Chunk* pChunk = (Chunk*) malloc( nBytes );
+        if( !pChunk )
+            return 0;
+
+        pChunk->nCapacity = nBytes;
+        pChunk->nOffset = HEADER_SIZE;
+        return pChunk;
+    }
+}
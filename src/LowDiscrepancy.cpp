@@ -0,0 +1,177 @@
+//=====================================================================================================================
+//
+//   LowDiscrepancy.cpp
+//
+//   Low-discrepancy (quasi-random) sequences, for feeding the sampling functions in VectorMath.h
+//
+//   The lazy man's utility library
+//   Joshua Barczak
+//   Copyright 2016 Joshua Barczak
+//
+//   LICENSE:  See Doc\License.txt for terms and conditions
+//
+//=====================================================================================================================
+
+#include "LowDiscrepancy.h"
+#include <assert.h>
+
+namespace Simpleton
+{
+    namespace
+    {
+        enum
+        {
+            SAMPLE_BATCH = 64   ///< Samples generated at a time by the sequence-to-direction functions
+        };
+
+        /// Generates a sequence in stack-sized batches, and maps each batch to directions
+        template< class Map_T >
+        void SequenceToDirections( SampleSequence eSeq, uint32 nFirst, uint32 nCount, uint32 nSeed,
+                                   float* pX, float* pY, float* pZ, const Map_T& map )
+        {
+            float S[SAMPLE_BATCH];
+            float T[SAMPLE_BATCH];
+            for( uint32 i=0; i<nCount; i += SAMPLE_BATCH )
+            {
+                uint32 n = (nCount-i < SAMPLE_BATCH) ? nCount-i : (uint32)SAMPLE_BATCH;
+                GenerateSamples2D( eSeq, nFirst+i, n, nSeed, S, T );
+                map( S, T, n, pX+i, pY+i, pZ+i );
+            }
+        }
+    }
+
+    namespace _INTERNAL
+    {
+        //=====================================================================================================================
+        //=====================================================================================================================
+        uint32 RadicalInverseFixed( uint32 n, uint32 nBase )
+        {
+            // base 1 would never finish, and base 0 divides by zero
+            assert( nBase >= 2 );
+
+            // accumulate the digits as an integer, then scale once, so there is only one rounding
+            uint64 nReversed = 0;
+            uint64 nDenom = 1;
+            while( n )
+            {
+                nReversed = nReversed*nBase + (n % nBase);
+                nDenom *= nBase;
+                n /= nBase;
+            }
+
+            if( nDenom >= (1ull << 32) )
+            {
+                // too many digits to do exactly in 64 bits.  Double has plenty of precision for a 32-bit result
+                double f = (double)nReversed / (double)nDenom;
+                uint64 x = (uint64)( f * 4294967296.0 );
+                return (x > 0xffffffffull) ? 0xffffffffu : (uint32)x;
+            }
+
+            return (uint32)( (nReversed << 32) / nDenom );
+        }
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void GenerateSamples2D( SampleSequence eSeq, uint32 nFirst, uint32 nCount, uint32 nSeed, float* pS, float* pT )
+    {
+        switch( eSeq )
+        {
+        case SEQUENCE_SOBOL:
+            for( uint32 i=0; i<nCount; i++ )
+            {
+                Vec2f v = Sobol2D( nFirst+i, nSeed );
+                pS[i] = v.x;
+                pT[i] = v.y;
+            }
+            break;
+
+        case SEQUENCE_HALTON:
+            for( uint32 i=0; i<nCount; i++ )
+            {
+                Vec2f v = Halton2D( nFirst+i, nSeed );
+                pS[i] = v.x;
+                pT[i] = v.y;
+            }
+            break;
+
+        default:
+            for( uint32 i=0; i<nCount; i++ )
+            {
+                Vec2f v = R2( nFirst+i, nSeed );
+                pS[i] = v.x;
+                pT[i] = v.y;
+            }
+            break;
+        }
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void CosineWeightedDirections( const float* pS, const float* pT, size_t n, float* pX, float* pY, float* pZ )
+    {
+        for( size_t i=0; i<n; i++ )
+        {
+            Vec3f v = CosineWeightedDirection( pS[i], pT[i] );
+            pX[i] = v.x;
+            pY[i] = v.y;
+            pZ[i] = v.z;
+        }
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void UniformSampleSphere( const float* pS, const float* pT, size_t n, float* pX, float* pY, float* pZ )
+    {
+        for( size_t i=0; i<n; i++ )
+        {
+            Vec3f v = UniformSampleSphere( pS[i], pT[i] );
+            pX[i] = v.x;
+            pY[i] = v.y;
+            pZ[i] = v.z;
+        }
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void UniformSampleHemisphere( const float* pS, const float* pT, size_t n, float* pX, float* pY, float* pZ )
+    {
+        for( size_t i=0; i<n; i++ )
+        {
+            Vec3f v = UniformSampleHemisphere( pS[i], pT[i] );
+            pX[i] = v.x;
+            pY[i] = v.y;
+            pZ[i] = v.z;
+        }
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void CosineWeightedDirections( SampleSequence eSeq, uint32 nFirst, uint32 nCount, uint32 nSeed, float* pX, float* pY, float* pZ )
+    {
+        SequenceToDirections( eSeq, nFirst, nCount, nSeed, pX, pY, pZ,
+            []( const float* pS, const float* pT, size_t n, float* x, float* y, float* z ) {
+                CosineWeightedDirections( pS, pT, n, x, y, z );
+            });
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void UniformSampleSphere( SampleSequence eSeq, uint32 nFirst, uint32 nCount, uint32 nSeed, float* pX, float* pY, float* pZ )
+    {
+        SequenceToDirections( eSeq, nFirst, nCount, nSeed, pX, pY, pZ,
+            []( const float* pS, const float* pT, size_t n, float* x, float* y, float* z ) {
+                UniformSampleSphere( pS, pT, n, x, y, z );
+            });
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void UniformSampleHemisphere( SampleSequence eSeq, uint32 nFirst, uint32 nCount, uint32 nSeed, float* pX, float* pY, float* pZ )
+    {
+        SequenceToDirections( eSeq, nFirst, nCount, nSeed, pX, pY, pZ,
+            []( const float* pS, const float* pT, size_t n, float* x, float* y, float* z ) {
+                UniformSampleHemisphere( pS, pT, n, x, y, z );
+            });
+    }
+}
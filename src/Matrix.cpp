@@ -15,35 +15,282 @@
 #include "Matrix.h"
 #include "MiscMath.h"
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+    #define SIMPLETON_MATRIX_SSE
+    #include "VectorPacket.h"
+#endif
+
 namespace Simpleton
 {
-
-   
-    Matrix4f MatrixScale( float x, float y, float z )
+    namespace _INTERNAL
     {
-        float values[] = {
-            x,0,0,0,
-            0,y,0,0,
-            0,0,z,0,
-            0,0,0,1
-        };
-
-        return Matrix4f(values);
-    }
-
-
-    Matrix4f MatrixTranslate( float x, float y, float z )
-    {
-        float values[] = { // NOTE: column major!
-            1,0,0,0,
-            0,1,0,0,
-            0,0,1,0,
-            x,y,z,1
-        };
-
-        return Matrix4f(values);
+#ifdef SIMPLETON_MATRIX_SSE
+
+        #define MATRIX_SHUFFLE(a,b,x,y,z,w) _mm_shuffle_ps( a, b, _MM_SHUFFLE(w,z,y,x) )
+
+        //=====================================================================================================================
+        /// Column j of A*B is the sum of the columns of A, weighted by the elements of column j of B
+        //=====================================================================================================================
+        void MatrixMultiply4f( float* pOut, const float* pA, const float* pB )
+        {
+            __m128 a0 = _mm_loadu_ps( pA );
+            __m128 a1 = _mm_loadu_ps( pA+4 );
+            __m128 a2 = _mm_loadu_ps( pA+8 );
+            __m128 a3 = _mm_loadu_ps( pA+12 );
+
+            __m128 b[4];
+            for( int j=0; j<4; j++ )
+                b[j] = _mm_loadu_ps( pB + 4*j );
+
+            for( int j=0; j<4; j++ )
+            {
+                __m128 c =        _mm_mul_ps( a0, MATRIX_SHUFFLE(b[j],b[j],0,0,0,0) );
+                c = _mm_add_ps( c, _mm_mul_ps( a1, MATRIX_SHUFFLE(b[j],b[j],1,1,1,1) ) );
+                c = _mm_add_ps( c, _mm_mul_ps( a2, MATRIX_SHUFFLE(b[j],b[j],2,2,2,2) ) );
+                c = _mm_add_ps( c, _mm_mul_ps( a3, MATRIX_SHUFFLE(b[j],b[j],3,3,3,3) ) );
+                _mm_storeu_ps( pOut + 4*j, c );
+            }
+        }
+
+        //=====================================================================================================================
+        //=====================================================================================================================
+        void MatrixTranspose4f( float* pOut, const float* pIn )
+        {
+            __m128 c0 = _mm_loadu_ps( pIn );
+            __m128 c1 = _mm_loadu_ps( pIn+4 );
+            __m128 c2 = _mm_loadu_ps( pIn+8 );
+            __m128 c3 = _mm_loadu_ps( pIn+12 );
+            _MM_TRANSPOSE4_PS( c0, c1, c2, c3 );
+            _mm_storeu_ps( pOut,    c0 );
+            _mm_storeu_ps( pOut+4,  c1 );
+            _mm_storeu_ps( pOut+8,  c2 );
+            _mm_storeu_ps( pOut+12, c3 );
+        }
+
+        /// 2x2 matrix product A*B.  2x2 matrices are stored row-major in one register
+        static inline __m128 Mat2Mul( __m128 a, __m128 b )
+        {
+            return _mm_add_ps( _mm_mul_ps( a, MATRIX_SHUFFLE(b,b,0,3,0,3) ),
+                               _mm_mul_ps( MATRIX_SHUFFLE(a,a,1,0,3,2), MATRIX_SHUFFLE(b,b,2,1,2,1) ) );
+        }
+
+        /// 2x2 matrix product adj(A)*B
+        static inline __m128 Mat2AdjMul( __m128 a, __m128 b )
+        {
+            return _mm_sub_ps( _mm_mul_ps( MATRIX_SHUFFLE(a,a,3,3,0,0), b ),
+                               _mm_mul_ps( MATRIX_SHUFFLE(a,a,1,1,2,2), MATRIX_SHUFFLE(b,b,2,3,0,1) ) );
+        }
+
+        /// 2x2 matrix product A*adj(B)
+        static inline __m128 Mat2MulAdj( __m128 a, __m128 b )
+        {
+            return _mm_sub_ps( _mm_mul_ps( a, MATRIX_SHUFFLE(b,b,3,0,3,0) ),
+                               _mm_mul_ps( MATRIX_SHUFFLE(a,a,1,0,3,2), MATRIX_SHUFFLE(b,b,2,1,2,1) ) );
+        }
+
+        //=====================================================================================================================
+        /// Block-wise inverse, after Eric Zhang's "Fast 4x4 Matrix Inverse with SSE SIMD, Explained".
+        ///
+        ///  The registers hold columns of M, which are the rows of transpose(M).  The algorithm inverts the matrix whose
+        ///   rows are in the registers, producing the rows of inverse(transpose(M)).  These are the columns of inverse(M),
+        ///   so no transposes are needed on either end.
+        //=====================================================================================================================
+        static bool Inverse4f( float* pOut, const float* pIn )
+        {
+            __m128 r0 = _mm_loadu_ps( pIn );
+            __m128 r1 = _mm_loadu_ps( pIn+4 );
+            __m128 r2 = _mm_loadu_ps( pIn+8 );
+            __m128 r3 = _mm_loadu_ps( pIn+12 );
+
+            // 2x2 sub-matrices
+            __m128 A = _mm_movelh_ps( r0, r1 );
+            __m128 B = _mm_movehl_ps( r1, r0 );
+            __m128 C = _mm_movelh_ps( r2, r3 );
+            __m128 D = _mm_movehl_ps( r3, r2 );
+
+            // determinants of the sub-matrices: (|A| |B| |C| |D|)
+            __m128 detSub = _mm_sub_ps( _mm_mul_ps( MATRIX_SHUFFLE(r0,r2,0,2,0,2), MATRIX_SHUFFLE(r1,r3,1,3,1,3) ),
+                                        _mm_mul_ps( MATRIX_SHUFFLE(r0,r2,1,3,1,3), MATRIX_SHUFFLE(r1,r3,0,2,0,2) ) );
+            __m128 detA = MATRIX_SHUFFLE(detSub,detSub,0,0,0,0);
+            __m128 detB = MATRIX_SHUFFLE(detSub,detSub,1,1,1,1);
+            __m128 detC = MATRIX_SHUFFLE(detSub,detSub,2,2,2,2);
+            __m128 detD = MATRIX_SHUFFLE(detSub,detSub,3,3,3,3);
+
+            __m128 D_C = Mat2AdjMul( D, C );
+            __m128 A_B = Mat2AdjMul( A, B );
+
+            // inverse is (1/|M|) * adjugate of [X Y; Z W]
+            __m128 X_ = _mm_sub_ps( _mm_mul_ps( detD, A ), Mat2Mul( B, D_C ) );
+            __m128 W_ = _mm_sub_ps( _mm_mul_ps( detA, D ), Mat2Mul( C, A_B ) );
+            __m128 Y_ = _mm_sub_ps( _mm_mul_ps( detB, C ), Mat2MulAdj( D, A_B ) );
+            __m128 Z_ = _mm_sub_ps( _mm_mul_ps( detC, B ), Mat2MulAdj( A, D_C ) );
+
+            // |M| = |A||D| + |B||C| - tr( adj(A)B adj(D)C )
+            __m128 tr = _mm_mul_ps( A_B, MATRIX_SHUFFLE(D_C,D_C,0,2,1,3) );
+            tr = _mm_add_ps( tr, _mm_movehl_ps( tr, tr ) );
+            tr = _mm_add_ss( tr, MATRIX_SHUFFLE(tr,tr,1,1,1,1) );
+
+            __m128 detM = _mm_add_ss( _mm_mul_ss( detA, detD ), _mm_mul_ss( detB, detC ) );
+            detM = _mm_sub_ss( detM, tr );
+
+            float fDet = _mm_cvtss_f32( detM );
+            if( fDet == 0 )
+                return false;
+
+            __m128 rDetM = _mm_div_ps( _mm_setr_ps( 1.0f, -1.0f, -1.0f, 1.0f ), MATRIX_SHUFFLE(detM,detM,0,0,0,0) );
+            X_ = _mm_mul_ps( X_, rDetM );
+            Y_ = _mm_mul_ps( Y_, rDetM );
+            Z_ = _mm_mul_ps( Z_, rDetM );
+            W_ = _mm_mul_ps( W_, rDetM );
+
+            // apply the adjugate shuffle and un-block in one go
+            _mm_storeu_ps( pOut,    MATRIX_SHUFFLE(X_,Y_,3,1,3,1) );
+            _mm_storeu_ps( pOut+4,  MATRIX_SHUFFLE(X_,Y_,2,0,2,0) );
+            _mm_storeu_ps( pOut+8,  MATRIX_SHUFFLE(Z_,W_,3,1,3,1) );
+            _mm_storeu_ps( pOut+12, MATRIX_SHUFFLE(Z_,W_,2,0,2,0) );
+            return true;
+        }
+
+        /// Cross product of the xyz parts.  The w lane comes out zero
+        static inline __m128 CrossXYZ( __m128 a, __m128 b )
+        {
+            return _mm_sub_ps( _mm_mul_ps( MATRIX_SHUFFLE(a,a,1,2,0,3), MATRIX_SHUFFLE(b,b,2,0,1,3) ),
+                               _mm_mul_ps( MATRIX_SHUFFLE(a,a,2,0,1,3), MATRIX_SHUFFLE(b,b,1,2,0,3) ) );
+        }
+
+        //=====================================================================================================================
+        /// The rows of inverse(R) are cross products of the columns of R, divided by the determinant.  Transposing them
+        ///  gives the columns, which then weight the translation to produce -inverse(R)*t
+        //=====================================================================================================================
+        static bool AffineInverse4f( float* pOut, const float* pIn )
+        {
+            __m128 c0 = _mm_loadu_ps( pIn );
+            __m128 c1 = _mm_loadu_ps( pIn+4 );
+            __m128 c2 = _mm_loadu_ps( pIn+8 );
+            __m128 t  = _mm_loadu_ps( pIn+12 );
+
+            __m128 r0 = CrossXYZ( c1, c2 );
+            __m128 r1 = CrossXYZ( c2, c0 );
+            __m128 r2 = CrossXYZ( c0, c1 );
+
+            __m128 det = _mm_mul_ps( c0, r0 );
+            det = _mm_add_ps( det, _mm_movehl_ps( det, det ) );
+            det = _mm_add_ss( det, MATRIX_SHUFFLE(det,det,1,1,1,1) );
+            if( _mm_cvtss_f32( det ) == 0 )
+                return false;
+
+            __m128 rDet = _mm_div_ps( _mm_set1_ps( 1.0f ), MATRIX_SHUFFLE(det,det,0,0,0,0) );
+            r0 = _mm_mul_ps( r0, rDet );
+            r1 = _mm_mul_ps( r1, rDet );
+            r2 = _mm_mul_ps( r2, rDet );
+            __m128 r3 = _mm_setzero_ps();
+            _MM_TRANSPOSE4_PS( r0, r1, r2, r3 );
+
+            __m128 it =        _mm_mul_ps( r0, MATRIX_SHUFFLE(t,t,0,0,0,0) );
+            it = _mm_add_ps( it, _mm_mul_ps( r1, MATRIX_SHUFFLE(t,t,1,1,1,1) ) );
+            it = _mm_add_ps( it, _mm_mul_ps( r2, MATRIX_SHUFFLE(t,t,2,2,2,2) ) );
+
+            _mm_storeu_ps( pOut,    r0 );
+            _mm_storeu_ps( pOut+4,  r1 );
+            _mm_storeu_ps( pOut+8,  r2 );
+            _mm_storeu_ps( pOut+12, _mm_sub_ps( _mm_setr_ps( 0.0f, 0.0f, 0.0f, 1.0f ), it ) );
+            return true;
+        }
+
+        #undef MATRIX_SHUFFLE
+
+#else
+
+        void MatrixMultiply4f( float* pOut, const float* pA, const float* pB )
+        {
+            float newdata[16];
+            for( int c=0; c<4; c++ )
+                for( int r=0; r<4; r++ )
+                    newdata[4*c+r] = pA[r]*pB[4*c] + pA[4+r]*pB[4*c+1] + pA[8+r]*pB[4*c+2] + pA[12+r]*pB[4*c+3];
+            memcpy( pOut, newdata, sizeof(newdata) );
+        }
+
+        void MatrixTranspose4f( float* pOut, const float* pIn )
+        {
+            float newdata[16];
+            for( int i=0; i<4; i++ )
+                for( int j=0; j<4; j++ )
+                    newdata[4*j+i] = pIn[4*i+j];
+            memcpy( pOut, newdata, sizeof(newdata) );
+        }
+
+        static bool Inverse4f( float* pOut, const float* m )
+        {
+            // code borrowed from: http://rodolphe-vaillant.fr/?e=7
+            //  who in turn borrowed it from mesa
+            float inv[16], det;
+
+            inv[ 0] =  m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+            inv[ 4] = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+            inv[ 8] =  m[4] * m[ 9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[ 9];
+            inv[12] = -m[4] * m[ 9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[ 9];
+            inv[ 1] = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+            inv[ 5] =  m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+            inv[ 9] = -m[0] * m[ 9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[ 9];
+            inv[13] =  m[0] * m[ 9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[ 9];
+            inv[ 2] =  m[1] * m[ 6] * m[15] - m[1] * m[ 7] * m[14] - m[5] * m[2] * m[15] + m[5] * m[3] * m[14] + m[13] * m[2] * m[ 7] - m[13] * m[3] * m[ 6];
+            inv[ 6] = -m[0] * m[ 6] * m[15] + m[0] * m[ 7] * m[14] + m[4] * m[2] * m[15] - m[4] * m[3] * m[14] - m[12] * m[2] * m[ 7] + m[12] * m[3] * m[ 6];
+            inv[10] =  m[0] * m[ 5] * m[15] - m[0] * m[ 7] * m[13] - m[4] * m[1] * m[15] + m[4] * m[3] * m[13] + m[12] * m[1] * m[ 7] - m[12] * m[3] * m[ 5];
+            inv[14] = -m[0] * m[ 5] * m[14] + m[0] * m[ 6] * m[13] + m[4] * m[1] * m[14] - m[4] * m[2] * m[13] - m[12] * m[1] * m[ 6] + m[12] * m[2] * m[ 5];
+            inv[ 3] = -m[1] * m[ 6] * m[11] + m[1] * m[ 7] * m[10] + m[5] * m[2] * m[11] - m[5] * m[3] * m[10] - m[ 9] * m[2] * m[ 7] + m[ 9] * m[3] * m[ 6];
+            inv[ 7] =  m[0] * m[ 6] * m[11] - m[0] * m[ 7] * m[10] - m[4] * m[2] * m[11] + m[4] * m[3] * m[10] + m[ 8] * m[2] * m[ 7] - m[ 8] * m[3] * m[ 6];
+            inv[11] = -m[0] * m[ 5] * m[11] + m[0] * m[ 7] * m[ 9] + m[4] * m[1] * m[11] - m[4] * m[3] * m[ 9] - m[ 8] * m[1] * m[ 7] + m[ 8] * m[3] * m[ 5];
+            inv[15] =  m[0] * m[ 5] * m[10] - m[0] * m[ 6] * m[ 9] - m[4] * m[1] * m[10] + m[4] * m[2] * m[ 9] + m[ 8] * m[1] * m[ 6] - m[ 8] * m[2] * m[ 5];
+
+            det = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+
+            if(det == 0)
+                return false;
+
+            det = 1.f / det;
+
+            for(int i = 0; i < 16; i++)
+                pOut[i] = inv[i] * det;
+            return true;
+        }
+
+        static bool AffineInverse4f( float* pOut, const float* m )
+        {
+            // inverse of [ R t ] is [ inv(R)  -inv(R)*t ]
+            //            [ 0 1 ]    [   0          1    ]
+            //
+            //  The rows of inv(R) are cross products of the columns of R, divided by the determinant
+            Vec3f c0( m[0], m[1], m[2] );
+            Vec3f c1( m[4], m[5], m[6] );
+            Vec3f c2( m[8], m[9], m[10] );
+            Vec3f t( m[12], m[13], m[14] );
+
+            Vec3f r0 = Cross3( c1, c2 );
+            Vec3f r1 = Cross3( c2, c0 );
+            Vec3f r2 = Cross3( c0, c1 );
+            float det = Dot3( c0, r0 );
+            if( det == 0 )
+                return false;
+
+            float fInvDet = 1.0f / det;
+            r0 = r0*fInvDet;
+            r1 = r1*fInvDet;
+            r2 = r2*fInvDet;
+
+            float values[] = { // NOTE: column major!
+                r0.x, r1.x, r2.x, 0,
+                r0.y, r1.y, r2.y, 0,
+                r0.z, r1.z, r2.z, 0,
+                -Dot3(r0,t), -Dot3(r1,t), -Dot3(r2,t), 1
+            };
+            memcpy( pOut, values, sizeof(values) );
+            return true;
+        }
+
+#endif
     }
 
+   
     Matrix4f MatrixRotate( float x, float y, float z, float fAngleInRads )
     {
         Vec3f r(x,y,z);
@@ -111,40 +358,18 @@ namespace Simpleton
 
     Matrix4f Inverse( const Matrix4f& rM )
     {
-        // code borrowed from: http://rodolphe-vaillant.fr/?e=7 
-        //  who in turn borrowed it from mesa
-        const float* m = rM.GetColumnMajor();
-        float inv[16], det;
- 
-        inv[ 0] =  m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
-        inv[ 4] = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
-        inv[ 8] =  m[4] * m[ 9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[ 9];
-        inv[12] = -m[4] * m[ 9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[ 9];
-        inv[ 1] = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
-        inv[ 5] =  m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
-        inv[ 9] = -m[0] * m[ 9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[ 9];
-        inv[13] =  m[0] * m[ 9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[ 9];
-        inv[ 2] =  m[1] * m[ 6] * m[15] - m[1] * m[ 7] * m[14] - m[5] * m[2] * m[15] + m[5] * m[3] * m[14] + m[13] * m[2] * m[ 7] - m[13] * m[3] * m[ 6];
-        inv[ 6] = -m[0] * m[ 6] * m[15] + m[0] * m[ 7] * m[14] + m[4] * m[2] * m[15] - m[4] * m[3] * m[14] - m[12] * m[2] * m[ 7] + m[12] * m[3] * m[ 6];
-        inv[10] =  m[0] * m[ 5] * m[15] - m[0] * m[ 7] * m[13] - m[4] * m[1] * m[15] + m[4] * m[3] * m[13] + m[12] * m[1] * m[ 7] - m[12] * m[3] * m[ 5];
-        inv[14] = -m[0] * m[ 5] * m[14] + m[0] * m[ 6] * m[13] + m[4] * m[1] * m[14] - m[4] * m[2] * m[13] - m[12] * m[1] * m[ 6] + m[12] * m[2] * m[ 5];
-        inv[ 3] = -m[1] * m[ 6] * m[11] + m[1] * m[ 7] * m[10] + m[5] * m[2] * m[11] - m[5] * m[3] * m[10] - m[ 9] * m[2] * m[ 7] + m[ 9] * m[3] * m[ 6];
-        inv[ 7] =  m[0] * m[ 6] * m[11] - m[0] * m[ 7] * m[10] - m[4] * m[2] * m[11] + m[4] * m[3] * m[10] + m[ 8] * m[2] * m[ 7] - m[ 8] * m[3] * m[ 6];
-        inv[11] = -m[0] * m[ 5] * m[11] + m[0] * m[ 7] * m[ 9] + m[4] * m[1] * m[11] - m[4] * m[3] * m[ 9] - m[ 8] * m[1] * m[ 7] + m[ 8] * m[3] * m[ 5];
-        inv[15] =  m[0] * m[ 5] * m[10] - m[0] * m[ 6] * m[ 9] - m[4] * m[1] * m[10] + m[4] * m[2] * m[ 9] + m[ 8] * m[1] * m[ 6] - m[ 8] * m[2] * m[ 5];
- 
-        det = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
- 
-        if(det == 0)
+        Matrix4f inv;
+        if( !_INTERNAL::Inverse4f( inv.GetColumnMajor(), rM.GetColumnMajor() ) )
             return Matrix4f::Zero();
- 
-        det = 1.f / det;
- 
-        float invOut[16];
-        for(int i = 0; i < 16; i++)
-            invOut[i] = inv[i] * det;
- 
-        return Matrix4f(invOut);
+        return inv;
+    }
+
+    Matrix4f AffineInverse( const Matrix4f& rM )
+    {
+        Matrix4f inv;
+        if( !_INTERNAL::AffineInverse4f( inv.GetColumnMajor(), rM.GetColumnMajor() ) )
+            return Matrix4f::Zero();
+        return inv;
     }
 
 
@@ -236,95 +461,8 @@ namespace Simpleton
         return mat;
     }
 
-    Matrix4f MatrixOrthoRH( float w, float h, float fNear, float fFar )
-    {
-        Matrix4f mat;
-        mat.Set(0,0,2/w);
-        mat.Set(0,1,0);
-        mat.Set(0,2,0);
-        mat.Set(0,3,0);
-
-        mat.Set(1,0,0);
-        mat.Set(1,1,2/h);
-        mat.Set(1,2,0);
-        mat.Set(1,3,0);
-        
-        mat.Set(2,0,0);
-        mat.Set(2,1,0);
-        mat.Set(2,2,1/(fNear-fFar));
-        mat.Set(2,3,fNear/(fNear-fFar));
-        
-        mat.Set(3,0,0);
-        mat.Set(3,1,0);
-        mat.Set(3,2,0);
-        mat.Set(3,3,1);
-        return mat;
-    }
-
-    Matrix4f MatrixOrthoLH( float w, float h, float fNear, float fFar )
-    {
-        Matrix4f mat;
-        mat.Set(0,0,2/w);
-        mat.Set(0,1,0);
-        mat.Set(0,2,0);
-        mat.Set(0,3,0);
-
-        mat.Set(1,0,0);
-        mat.Set(1,1,2/h);
-        mat.Set(1,2,0);
-        mat.Set(1,3,0);
-        
-        mat.Set(2,0,0);
-        mat.Set(2,1,0);
-        mat.Set(2,2,1/(fFar-fNear));
-        mat.Set(2,3,-fNear/(fFar-fNear));
-        
-        mat.Set(3,0,0);
-        mat.Set(3,1,0);
-        mat.Set(3,2,0);
-        mat.Set(3,3,1);
-        return mat;
-    }
    
     
-    Matrix4f MatrixCoordinateFrame( const Vec3f& x, const Vec3f& y, const Vec3f& z )
-    {  
-        Matrix4f mat;
-        mat.Set(0, 0, x.x);
-	    mat.Set(0, 1, x.y);
-	    mat.Set(0, 2, x.z);
-	    mat.Set(0, 3, 0);
-
-	    mat.Set(1, 0, y.x);
-	    mat.Set(1, 1, y.y);
-	    mat.Set(1, 2, y.z);
-	    mat.Set(1, 3, 0);
-    	
-	    mat.Set(2, 0, z.x);
-	    mat.Set(2, 1, z.y);
-	    mat.Set(2, 2, z.z);
-	    mat.Set(2, 3, 0);
-
-        mat.Set(3,0,0);
-        mat.Set(3,1,0);
-        mat.Set(3,2,0);
-        mat.Set(3,3,1);
-
-        return mat;
-    }
-
-    Matrix4f MatrixIdentity()
-    {
-        float m[] = {
-            1,0,0,0,
-            0,1,0,0,
-            0,0,1,0,
-            0,0,0,1
-        };
-        return Matrix4f(m);
-    }
-
-
     Vec3f AffineTransformPoint( const Matrix4f& rM, const Vec3f& P )
     {
         const float* pM = rM.GetColumnMajor();
@@ -359,6 +497,270 @@ namespace Simpleton
                       pM[8]*P.x + pM[9]*P.y + pM[10]*P.z  );
     }
 
-   
-}
 
+    //=====================================================================================================================
+    //
+    //            Batch transforms
+    //
+    //=====================================================================================================================
+
+    namespace _INTERNAL
+    {
+        enum TransformKind
+        {
+            XFORM_POINT,
+            XFORM_DIRECTION,
+            XFORM_NORMAL,
+            XFORM_PROJECTIVE
+        };
+
+        /// Rearranges the matrix so that every kind of transform has the same form:
+        ///     out[i] = c[3i]*x + c[3i+1]*y + c[3i+2]*z + c[9+i]
+        ///     w      = c[12]*x + c[13]*y  + c[14]*z  + c[15]   (projective only)
+        static void GetTransformCoefficients( float c[16], const Matrix4f& rM, TransformKind eKind )
+        {
+            const float* m = rM.GetColumnMajor();
+            for( int i=0; i<3; i++ )
+            {
+                for( int j=0; j<3; j++ )
+                    c[3*i+j] = (eKind == XFORM_NORMAL) ? m[4*i+j] : m[4*j+i];
+                c[9+i]  = (eKind == XFORM_POINT || eKind == XFORM_PROJECTIVE) ? m[12+i] : 0;
+                c[12+i] = m[4*i+3];
+            }
+            c[15] = m[15];
+        }
+
+        static inline void TransformScalar( const float c[16], float& x, float& y, float& z, bool bProjective, bool bNormalize )
+        {
+            float ox = c[0]*x + c[1]*y + c[2]*z + c[9];
+            float oy = c[3]*x + c[4]*y + c[5]*z + c[10];
+            float oz = c[6]*x + c[7]*y + c[8]*z + c[11];
+            if( bProjective )
+            {
+                float rw = 1.0f / (c[12]*x + c[13]*y + c[14]*z + c[15]);
+                ox *= rw;
+                oy *= rw;
+                oz *= rw;
+            }
+            if( bNormalize )
+            {
+                float rl = 1.0f / sqrtf( ox*ox + oy*oy + oz*oz );
+                ox *= rl;
+                oy *= rl;
+                oz *= rl;
+            }
+            x = ox;
+            y = oy;
+            z = oz;
+        }
+
+#ifdef SIMPLETON_MATRIX_SSE
+
+        struct SSE4
+        {
+            typedef __m128 V;
+            enum { WIDTH = 4 };
+            static V Set1( float f ) { return _mm_set1_ps(f); }
+            static V Load( const float* p ) { return _mm_loadu_ps(p); }
+            static void Store( float* p, V v ) { _mm_storeu_ps(p,v); }
+            static V Add( V a, V b ) { return _mm_add_ps(a,b); }
+            static V Mul( V a, V b ) { return _mm_mul_ps(a,b); }
+            static V Div( V a, V b ) { return _mm_div_ps(a,b); }
+            static V Sqrt( V a ) { return _mm_sqrt_ps(a); }
+        };
+
+    #ifdef __AVX__
+        struct AVX8
+        {
+            typedef __m256 V;
+            enum { WIDTH = 8 };
+            static V Set1( float f ) { return _mm256_set1_ps(f); }
+            static V Load( const float* p ) { return _mm256_loadu_ps(p); }
+            static void Store( float* p, V v ) { _mm256_storeu_ps(p,v); }
+            static V Add( V a, V b ) { return _mm256_add_ps(a,b); }
+            static V Mul( V a, V b ) { return _mm256_mul_ps(a,b); }
+            static V Div( V a, V b ) { return _mm256_div_ps(a,b); }
+            static V Sqrt( V a ) { return _mm256_sqrt_ps(a); }
+        };
+    #endif
+
+        template< class S >
+        static inline void TransformPacket( const typename S::V c[16], typename S::V& x, typename S::V& y, typename S::V& z,
+                                            bool bProjective, bool bNormalize )
+        {
+            typedef typename S::V V;
+            V ox = S::Add( S::Add( S::Mul(c[0],x), S::Mul(c[1],y) ), S::Add( S::Mul(c[2],z), c[9] ) );
+            V oy = S::Add( S::Add( S::Mul(c[3],x), S::Mul(c[4],y) ), S::Add( S::Mul(c[5],z), c[10] ) );
+            V oz = S::Add( S::Add( S::Mul(c[6],x), S::Mul(c[7],y) ), S::Add( S::Mul(c[8],z), c[11] ) );
+            if( bProjective )
+            {
+                V w  = S::Add( S::Add( S::Mul(c[12],x), S::Mul(c[13],y) ), S::Add( S::Mul(c[14],z), c[15] ) );
+                V rw = S::Div( S::Set1(1.0f), w );
+                ox = S::Mul(ox,rw);
+                oy = S::Mul(oy,rw);
+                oz = S::Mul(oz,rw);
+            }
+            if( bNormalize )
+            {
+                V len = S::Sqrt( S::Add( S::Add( S::Mul(ox,ox), S::Mul(oy,oy) ), S::Mul(oz,oz) ) );
+                V rl  = S::Div( S::Set1(1.0f), len );
+                ox = S::Mul(ox,rl);
+                oy = S::Mul(oy,rl);
+                oz = S::Mul(oz,rl);
+            }
+            x = ox;
+            y = oy;
+            z = oz;
+        }
+
+        /// Transforms as many whole packets as will fit.  Returns the number of vectors processed
+        template< class S >
+        static size_t TransformSoA( const float coeffs[16], float* pOutX, float* pOutY, float* pOutZ,
+                                    const float* pX, const float* pY, const float* pZ, size_t nCount,
+                                    bool bProjective, bool bNormalize )
+        {
+            typename S::V c[16];
+            for( int i=0; i<16; i++ )
+                c[i] = S::Set1( coeffs[i] );
+
+            size_t nPackets = nCount / S::WIDTH;
+            for( size_t i=0; i<nPackets*S::WIDTH; i += S::WIDTH )
+            {
+                typename S::V x = S::Load( pX+i );
+                typename S::V y = S::Load( pY+i );
+                typename S::V z = S::Load( pZ+i );
+                TransformPacket<S>( c, x, y, z, bProjective, bNormalize );
+                S::Store( pOutX+i, x );
+                S::Store( pOutY+i, y );
+                S::Store( pOutZ+i, z );
+            }
+            return nPackets*S::WIDTH;
+        }
+
+        /// Gathers groups of four vectors into SoA form, transforms them, and scatters them back
+        static size_t TransformStrided( const float coeffs[16], char* pOut, size_t nOutStride, const char* pIn, size_t nInStride,
+                                        size_t nCount, bool bProjective, bool bNormalize )
+        {
+            __m128 c[16];
+            for( int i=0; i<16; i++ )
+                c[i] = _mm_set1_ps( coeffs[i] );
+
+            size_t nPackets = nCount/4;
+            for( size_t i=0; i<nPackets; i++ )
+            {
+                __m128 x = LoadVec3( pIn );
+                __m128 y = LoadVec3( pIn + nInStride );
+                __m128 z = LoadVec3( pIn + 2*nInStride );
+                __m128 w = LoadVec3( pIn + 3*nInStride );
+                _MM_TRANSPOSE4_PS( x, y, z, w );
+
+                TransformPacket<SSE4>( c, x, y, z, bProjective, bNormalize );
+
+                _MM_TRANSPOSE4_PS( x, y, z, w );
+                StoreVec3( pOut, x );
+                StoreVec3( pOut + nOutStride, y );
+                StoreVec3( pOut + 2*nOutStride, z );
+                StoreVec3( pOut + 3*nOutStride, w );
+
+                pIn  += 4*nInStride;
+                pOut += 4*nOutStride;
+            }
+            return nPackets*4;
+        }
+
+#endif
+
+        static void TransformBatch( const Matrix4f& rM, TransformKind eKind, Vec3f* pOut, size_t nOutStride,
+                                    const Vec3f* pIn, size_t nInStride, size_t nCount, bool bNormalize )
+        {
+            float c[16];
+            GetTransformCoefficients( c, rM, eKind );
+            bool bProjective = (eKind == XFORM_PROJECTIVE);
+
+            const char* pInBytes = (const char*) pIn;
+            char* pOutBytes = (char*) pOut;
+            size_t nDone = 0;
+#ifdef SIMPLETON_MATRIX_SSE
+            nDone = TransformStrided( c, pOutBytes, nOutStride, pInBytes, nInStride, nCount, bProjective, bNormalize );
+#endif
+            for( size_t i=nDone; i<nCount; i++ )
+            {
+                const float* pV = (const float*)( pInBytes + i*nInStride );
+                float x = pV[0];
+                float y = pV[1];
+                float z = pV[2];
+                TransformScalar( c, x, y, z, bProjective, bNormalize );
+
+                float* pO = (float*)( pOutBytes + i*nOutStride );
+                pO[0] = x;
+                pO[1] = y;
+                pO[2] = z;
+            }
+        }
+
+        static void TransformBatchSoA( const Matrix4f& rM, TransformKind eKind, float* pOutX, float* pOutY, float* pOutZ,
+                                       const float* pX, const float* pY, const float* pZ, size_t nCount, bool bNormalize )
+        {
+            float c[16];
+            GetTransformCoefficients( c, rM, eKind );
+
+            size_t nDone = 0;
+#ifdef SIMPLETON_MATRIX_SSE
+    #ifdef __AVX__
+            nDone += TransformSoA<AVX8>( c, pOutX, pOutY, pOutZ, pX, pY, pZ, nCount, false, bNormalize );
+    #endif
+            nDone += TransformSoA<SSE4>( c, pOutX+nDone, pOutY+nDone, pOutZ+nDone, pX+nDone, pY+nDone, pZ+nDone,
+                                         nCount-nDone, false, bNormalize );
+#endif
+            for( size_t i=nDone; i<nCount; i++ )
+            {
+                float x = pX[i];
+                float y = pY[i];
+                float z = pZ[i];
+                TransformScalar( c, x, y, z, false, bNormalize );
+                pOutX[i] = x;
+                pOutY[i] = y;
+                pOutZ[i] = z;
+            }
+        }
+    }
+
+    void AffineTransformPoints( const Matrix4f& rM, Vec3f* pOut, size_t nOutStride, const Vec3f* pIn, size_t nInStride, size_t nCount )
+    {
+        _INTERNAL::TransformBatch( rM, _INTERNAL::XFORM_POINT, pOut, nOutStride, pIn, nInStride, nCount, false );
+    }
+
+    void AffineTransformDirections( const Matrix4f& rM, Vec3f* pOut, size_t nOutStride, const Vec3f* pIn, size_t nInStride, size_t nCount )
+    {
+        _INTERNAL::TransformBatch( rM, _INTERNAL::XFORM_DIRECTION, pOut, nOutStride, pIn, nInStride, nCount, false );
+    }
+
+    void AffineTransformNormals( const Matrix4f& rM, Vec3f* pOut, size_t nOutStride, const Vec3f* pIn, size_t nInStride, size_t nCount,
+                                 bool bNormalize )
+    {
+        _INTERNAL::TransformBatch( rM, _INTERNAL::XFORM_NORMAL, pOut, nOutStride, pIn, nInStride, nCount, bNormalize );
+    }
+
+    void TransformPoints( const Matrix4f& rM, Vec3f* pOut, size_t nOutStride, const Vec3f* pIn, size_t nInStride, size_t nCount )
+    {
+        _INTERNAL::TransformBatch( rM, _INTERNAL::XFORM_PROJECTIVE, pOut, nOutStride, pIn, nInStride, nCount, false );
+    }
+
+    void AffineTransformPointsSoA( const Matrix4f& rM, float* pOutX, float* pOutY, float* pOutZ,
+                                   const float* pX, const float* pY, const float* pZ, size_t nCount )
+    {
+        _INTERNAL::TransformBatchSoA( rM, _INTERNAL::XFORM_POINT, pOutX, pOutY, pOutZ, pX, pY, pZ, nCount, false );
+    }
+
+    void AffineTransformDirectionsSoA( const Matrix4f& rM, float* pOutX, float* pOutY, float* pOutZ,
+                                       const float* pX, const float* pY, const float* pZ, size_t nCount )
+    {
+        _INTERNAL::TransformBatchSoA( rM, _INTERNAL::XFORM_DIRECTION, pOutX, pOutY, pOutZ, pX, pY, pZ, nCount, false );
+    }
+
+    void AffineTransformNormalsSoA( const Matrix4f& rM, float* pOutX, float* pOutY, float* pOutZ,
+                                    const float* pX, const float* pY, const float* pZ, size_t nCount, bool bNormalize )
+    {
+        _INTERNAL::TransformBatchSoA( rM, _INTERNAL::XFORM_NORMAL, pOutX, pOutY, pOutZ, pX, pY, pZ, nCount, bNormalize );
+    }
+}
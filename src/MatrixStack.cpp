@@ -30,8 +30,9 @@ namespace Simpleton
     //=====================================================================================================================
     MatrixStack::MatrixStack()
     {
-        m_MTWStack.push_back( Matrix4f::Identity() ); // initialize top transform to identity.  This first matrix can never be popped
-        m_WTMStack.push_back( Matrix4f::Identity() );
+        // initialize top transform to identity.  This first entry can never be popped
+        m_Stack.resize(1);
+        SetIdentity( m_Stack.back() );
     }
 
     //=====================================================================================================================
@@ -45,8 +46,7 @@ namespace Simpleton
     //=====================================================================================================================
     void MatrixStack::Push()
     {
-        m_MTWStack.push_back( m_MTWStack.back() );
-        m_WTMStack.push_back( m_WTMStack.back() );
+        m_Stack.push_back( m_Stack.back() );
     }
 
     //=====================================================================================================================
@@ -55,21 +55,38 @@ namespace Simpleton
     void MatrixStack::Pop()
     {
         // never pop the last matrix
-        if( m_MTWStack.size() == 1 )
+        if( m_Stack.size() == 1 )
             return;
 
-        m_MTWStack.pop_back();
-        m_WTMStack.pop_back();
+        m_Stack.pop_back();
+    }
+
+    //=====================================================================================================================
+    /// \param rMatrix          The transformation to apply to the top of the stack
+    //=====================================================================================================================
+    void MatrixStack::ApplyMatrix( const Matrix4f& rMatrix )
+    {
+        ApplyMatrix( rMatrix, Classify(rMatrix) );
     }
 
     //=====================================================================================================================
     /// \param rMatrix          The transformation to apply to the top of the stack
     /// \param rMatrixInverse   The inverse of this transformation
+    ///
+    /// The supplied inverse is only used if the result is projective and the cached inverse is current.  This saves a
+    ///  general 4x4 inversion later.  Otherwise, the inverse is recomputed lazily from the transform.
     //=====================================================================================================================
     void MatrixStack::ApplyMatrix( const Matrix4f& rMatrix, const Matrix4f& rMatrixInverse )
-    {    
-        m_MTWStack.back() = rMatrix * m_MTWStack.back() ;
-        m_WTMStack.back() = m_WTMStack.back() * rMatrixInverse ;
+    {
+        Entry& e = m_Stack.back();
+        bool bKeepInverse = e.bWTMValid;
+
+        ApplyMatrix( rMatrix, Classify(rMatrix) );
+        if( bKeepInverse && e.eKind == KIND_PROJECTIVE )
+        {
+            e.WTM = e.WTM * rMatrixInverse;
+            e.bWTMValid = true;
+        }
     }
 
     //=====================================================================================================================
@@ -78,9 +95,19 @@ namespace Simpleton
     //=====================================================================================================================
     void MatrixStack::ApplyRotation( float x, float y, float z, float fTheta )
     {
-        Matrix4f xform = MatrixRotate(x,y,z, DegreeToRad(fTheta) );
-        Matrix4f inv = MatrixRotate(x,y,z,DegreeToRad(-fTheta) );
-        ApplyMatrix(xform,inv);
+        Entry& e = m_Stack.back();
+        if( e.eKind != KIND_SIMILARITY )
+        {
+            ApplyMatrix( MatrixRotate(x,y,z, DegreeToRad(fTheta) ), KIND_AFFINE );
+            return;
+        }
+
+        // R*T(t)*Q*S  ==  T(R(t))*(R*Q)*S
+        Quatf r = Quatf::FromAxisAngle( Vec3f(x,y,z), DegreeToRad(fTheta) );
+        e.qRotation    = Normalize( r*e.qRotation );
+        e.vTranslation = r.Rotate( e.vTranslation );
+        e.bMTWValid = false;
+        e.bWTMValid = false;
     }
 
     //=====================================================================================================================
@@ -88,9 +115,16 @@ namespace Simpleton
     //=====================================================================================================================
     void MatrixStack::ApplyTranslation( float x, float y, float z )
     {
-        Matrix4f xform = MatrixTranslate(x,y,z);
-        Matrix4f inv = MatrixTranslate(-x,-y,-z);
-        ApplyMatrix(xform, inv);
+        Entry& e = m_Stack.back();
+        if( e.eKind != KIND_SIMILARITY )
+        {
+            ApplyMatrix( MatrixTranslate(x,y,z), KIND_AFFINE );
+            return;
+        }
+
+        e.vTranslation += Vec3f(x,y,z);
+        e.bMTWValid = false;
+        e.bWTMValid = false;
     }
 
     //=====================================================================================================================
@@ -98,26 +132,64 @@ namespace Simpleton
     //=====================================================================================================================
     void MatrixStack::ApplyScale( float x, float y, float z )
     {
-        Matrix4f xform = MatrixScale(x,y,z);
-        Matrix4f inv = MatrixScale(1.0f/x, 1.0f/y, 1.0f/z);
-        ApplyMatrix(xform, inv);
+        if( x == y && y == z )
+        {
+            ApplyScale(x);
+            return;
+        }
+
+        ApplyMatrix( MatrixScale(x,y,z), KIND_AFFINE );
+    }
+
+    //=====================================================================================================================
+    /// \param s  Uniform scale factor
+    //=====================================================================================================================
+    void MatrixStack::ApplyScale( float s )
+    {
+        Entry& e = m_Stack.back();
+        if( e.eKind != KIND_SIMILARITY )
+        {
+            ApplyMatrix( MatrixScale(s,s,s), KIND_AFFINE );
+            return;
+        }
+
+        // uniform scale commutes with rotation:  S*T(t)*Q*S'  ==  T(s*t)*Q*(S*S')
+        e.vTranslation *= s;
+        e.fScale *= s;
+        e.bMTWValid = false;
+        e.bWTMValid = false;
     }
 
     //=====================================================================================================================
     //=====================================================================================================================
     void MatrixStack::ChangeCoordinateFrame( const Vec3f& X, const Vec3f& Y, const Vec3f& Z )
     {
-        Matrix4f xform = MatrixCoordinateFrame(X,Y,Z);
-        Matrix4f xpose = Inverse(xform);
-        ApplyMatrix(xform,xpose);
+        ApplyMatrix( MatrixCoordinateFrame(X,Y,Z), KIND_AFFINE );
     }
 
     //=====================================================================================================================
     //=====================================================================================================================
     void MatrixStack::SetIdentity()
     {
-        m_WTMStack.back() = Matrix4f::Identity(); // identity
-        m_MTWStack.back() = Matrix4f::Identity();
+        SetIdentity( m_Stack.back() );
+    }
+
+    //=====================================================================================================================
+    /// The returned reference is invalidated by any non-const method call
+    //=====================================================================================================================
+    const Matrix4f& MatrixStack::GetTransform() const
+    {
+        BuildTransform( m_Stack.back() );
+        return m_Stack.back().MTW;
+    }
+
+    //=====================================================================================================================
+    /// The returned reference is invalidated by any non-const method call
+    //=====================================================================================================================
+    const Matrix4f& MatrixStack::GetInverse() const
+    {
+        BuildInverse( m_Stack.back() );
+        return m_Stack.back().WTM;
     }
 
     //=====================================================================================================================
@@ -125,10 +197,9 @@ namespace Simpleton
     //=====================================================================================================================
     void MatrixStack::Clear()
     {
-        m_WTMStack.clear();
-        m_MTWStack.clear();
-        m_WTMStack.push_back( Matrix4f::Identity() );
-        m_MTWStack.push_back( Matrix4f::Identity() );
+        m_Stack.clear();
+        m_Stack.resize(1);
+        SetIdentity( m_Stack.back() );
     }
 
 
@@ -143,5 +214,104 @@ namespace Simpleton
     //            Private Methods
     //
     //=====================================================================================================================
-}
 
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void MatrixStack::SetIdentity( Entry& e )
+    {
+        e.qRotation = Quatf::Identity();
+        e.vTranslation = Vec3f(0,0,0);
+        e.fScale = 1.0f;
+        e.eKind = KIND_SIMILARITY;
+        e.bMTWValid = true;
+        e.bWTMValid = true;
+        e.MTW = Matrix4f::Identity();
+        e.WTM = Matrix4f::Identity();
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    MatrixStack::Kind MatrixStack::Classify( const Matrix4f& rMatrix )
+    {
+        if( rMatrix.Get(3,0) == 0.0f && rMatrix.Get(3,1) == 0.0f && rMatrix.Get(3,2) == 0.0f && rMatrix.Get(3,3) == 1.0f )
+            return KIND_AFFINE;
+        return KIND_PROJECTIVE;
+    }
+
+    //=====================================================================================================================
+    /// Drops the entry out of similarity form (if need be), and invalidates the inverse
+    //=====================================================================================================================
+    void MatrixStack::ApplyMatrix( const Matrix4f& rMatrix, Kind eKind )
+    {
+        Entry& e = m_Stack.back();
+        BuildTransform(e);
+        e.MTW = rMatrix * e.MTW;
+        if( e.eKind < eKind )
+            e.eKind = eKind;
+        e.bWTMValid = false;
+    }
+
+    //=====================================================================================================================
+    /// Expands the similarity form into an explicit matrix, if it is stale
+    //=====================================================================================================================
+    void MatrixStack::BuildTransform( const Entry& e ) const
+    {
+        if( e.bMTWValid )
+            return;
+
+        // MTW = T(t)*R*S(s)
+        Matrix4f R = e.qRotation.ToMatrix();
+        for( unsigned int i=0; i<3; i++ )
+        {
+            for( unsigned int j=0; j<3; j++ )
+                e.MTW.Set( i,j, R.Get(i,j)*e.fScale );
+            e.MTW.Set( 3,i, 0.0f );
+        }
+        e.MTW.Set( 0,3, e.vTranslation.x );
+        e.MTW.Set( 1,3, e.vTranslation.y );
+        e.MTW.Set( 2,3, e.vTranslation.z );
+        e.MTW.Set( 3,3, 1.0f );
+        e.bMTWValid = true;
+    }
+
+    //=====================================================================================================================
+    /// Computes the inverse with the cheapest method that the entry's kind allows, if it is stale
+    //=====================================================================================================================
+    void MatrixStack::BuildInverse( const Entry& e ) const
+    {
+        if( e.bWTMValid )
+            return;
+
+        switch( e.eKind )
+        {
+        case KIND_SIMILARITY:
+            {
+                // WTM = S(1/s)*R'*T(-t)
+                Matrix4f R = e.qRotation.ToMatrix();
+                float fInvScale = 1.0f / e.fScale;
+                Vec3f vInvT = e.qRotation.Conjugate().Rotate( e.vTranslation ) * -fInvScale;
+                for( unsigned int i=0; i<3; i++ )
+                {
+                    for( unsigned int j=0; j<3; j++ )
+                        e.WTM.Set( i,j, R.Get(j,i)*fInvScale );
+                    e.WTM.Set( 3,i, 0.0f );
+                }
+                e.WTM.Set( 0,3, vInvT.x );
+                e.WTM.Set( 1,3, vInvT.y );
+                e.WTM.Set( 2,3, vInvT.z );
+                e.WTM.Set( 3,3, 1.0f );
+            }
+            break;
+
+        case KIND_AFFINE:
+            // about half the cost of the general inverse.  MatrixTest checks that this stays true
+            e.WTM = AffineInverse( e.MTW );
+            break;
+
+        default:
+            e.WTM = Inverse( e.MTW );
+            break;
+        }
+        e.bWTMValid = true;
+    }
+}
\ No newline at end of file
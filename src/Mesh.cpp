@@ -0,0 +1,609 @@
+//=====================================================================================================================
+//
+//   Mesh.cpp
+//
+//   Various mesh processing utilities
+//
+//   The lazy man's utility library
+//   Joshua Barczak
+//   Copyright 2016 Joshua Barczak
+//
+//   LICENSE:  See Doc\License.txt for terms and conditions
+//
+//=====================================================================================================================
+
+#include "Mesh.h"
+#include "Parallel.h"
+#include "VectorPacket.h"
+#include "FastMath.h"
+
+#include <algorithm>
+#include <atomic>
+#include <string.h>
+
+namespace Simpleton
+{
+    namespace
+    {
+        enum
+        {
+            FACE_GRAIN   = 4096,    ///< Triangles per chunk in the face pass.  Must be a multiple of the packet width
+            VERTEX_GRAIN = 4096,    ///< Vertices per chunk in the gather pass
+            CORNER_GRAIN = 16384,   ///< Corners per chunk when building adjacency
+        };
+
+        /// Per-face terms for the normal gather.  SoA, padded to a whole number of packets
+        struct FaceTerms
+        {
+            std::vector<float> Nx;
+            std::vector<float> Ny;
+            std::vector<float> Nz;
+            std::vector<float> CornerWeights;   ///< One per corner.  Only used for angle weighting
+        };
+
+        inline const float* GetStrided( const float* p, size_t nStride, size_t i )
+        {
+            return (const float*)( ((const uint8*)p) + nStride*i );
+        }
+
+        inline float* GetStrided( float* p, size_t nStride, size_t i )
+        {
+            return (float*)( ((uint8*)p) + nStride*i );
+        }
+
+        inline Vec3x8 NormalizeOrZero( const Vec3x8& v )
+        {
+            float8 fLenSq = Dot3(v,v);
+            float8 fScale = Select( fLenSq > float8(0.0f), float8(1.0f) / Sqrt(fLenSq), float8(0.0f) );
+            return v*fScale;
+        }
+
+        void AllocateFaceTerms( FaceTerms& terms, uint32 nTriangles, NormalWeighting eWeighting )
+        {
+            size_t nPadded = (nTriangles + float8::WIDTH-1) & ~(size_t)(float8::WIDTH-1);
+            terms.Nx.resize( nPadded );
+            terms.Ny.resize( nPadded );
+            terms.Nz.resize( nPadded );
+            if( eWeighting == NORMAL_WEIGHT_ANGLE )
+                terms.CornerWeights.resize( 3*(size_t)nTriangles );
+        }
+
+        //=====================================================================================================================
+        /// Computes face normals for the triangles [t,t+nLanes), and the corner angles if they're needed.  nLanes <= 8.
+        ///  Lane l of N[axis] is triangle t+l's normal, and lane l of A[k] is the angle at its k'th corner
+        //=====================================================================================================================
+        void ComputeFacePacket( float N[3][float8::WIDTH], float A[3][float8::WIDTH], size_t t, size_t nLanes,
+                                const float* pPositions, size_t nPositionStride, const uint32* pIndices,
+                                NormalWeighting eWeighting )
+        {
+            const size_t W = float8::WIDTH;
+
+            // transpose the corner positions into SoA form.  Unused lanes become degenerate triangles
+            float P[3][3][W];   // [corner][axis][lane]
+            memset( P, 0, sizeof(P) );
+            for( size_t l=0; l<nLanes; l++ )
+            {
+                for( size_t k=0; k<3; k++ )
+                {
+                    const float* p = GetStrided( pPositions, nPositionStride, pIndices[3*(t+l)+k] );
+                    P[k][0][l] = p[0];
+                    P[k][1][l] = p[1];
+                    P[k][2][l] = p[2];
+                }
+            }
+
+            Vec3x8 P0( float8::Load(P[0][0]), float8::Load(P[0][1]), float8::Load(P[0][2]) );
+            Vec3x8 P1( float8::Load(P[1][0]), float8::Load(P[1][1]), float8::Load(P[1][2]) );
+            Vec3x8 P2( float8::Load(P[2][0]), float8::Load(P[2][1]), float8::Load(P[2][2]) );
+
+            // length of the unnormalized cross product is twice the area, which gives us area weighting for free
+            Vec3x8 vN = Cross3( P1-P0, P2-P0 );
+            if( eWeighting == NORMAL_WEIGHT_ANGLE )
+            {
+                vN = NormalizeOrZero( vN );
+
+                Vec3x8 E01 = NormalizeOrZero( P1-P0 );
+                Vec3x8 E12 = NormalizeOrZero( P2-P1 );
+                Vec3x8 E20 = NormalizeOrZero( P0-P2 );
+                FastAcos( -Dot3( E01, E20 ) ).Store( A[0] );
+                FastAcos( -Dot3( E12, E01 ) ).Store( A[1] );
+                FastAcos( -Dot3( E20, E12 ) ).Store( A[2] );
+            }
+
+            vN.x.Store( N[0] );
+            vN.y.Store( N[1] );
+            vN.z.Store( N[2] );
+        }
+
+        //=====================================================================================================================
+        /// Fills in the face terms for triangles [t0,t1).  't0' must be a multiple of the packet width
+        //=====================================================================================================================
+        void ComputeFaceTerms( FaceTerms& terms, size_t t0, size_t t1,
+                               const float* pPositions, size_t nPositionStride, const uint32* pIndices,
+                               NormalWeighting eWeighting )
+        {
+            const size_t W = float8::WIDTH;
+            for( size_t t=t0; t<t1; t += W )
+            {
+                size_t nLanes = std::min( W, t1-t );
+
+                float N[3][W];
+                float A[3][W];
+                ComputeFacePacket( N, A, t, nLanes, pPositions, nPositionStride, pIndices, eWeighting );
+
+                // face arrays are padded, so whole packets can always be stored
+                memcpy( terms.Nx.data() + t, N[0], sizeof(N[0]) );
+                memcpy( terms.Ny.data() + t, N[1], sizeof(N[1]) );
+                memcpy( terms.Nz.data() + t, N[2], sizeof(N[2]) );
+
+                if( eWeighting == NORMAL_WEIGHT_ANGLE )
+                {
+                    float* pWeights = terms.CornerWeights.data() + 3*t;
+                    for( size_t l=0; l<nLanes; l++ )
+                    {
+                        pWeights[3*l+0] = A[0][l];
+                        pWeights[3*l+1] = A[1][l];
+                        pWeights[3*l+2] = A[2][l];
+                    }
+                }
+            }
+        }
+
+        inline void NormalizeOrZero( float* N )
+        {
+            float fLenSq = N[0]*N[0] + N[1]*N[1] + N[2]*N[2];
+            float fScale = (fLenSq > 0.0f) ? 1.0f / sqrtf(fLenSq) : 0.0f;
+            N[0] *= fScale;
+            N[1] *= fScale;
+            N[2] *= fScale;
+        }
+
+        //=====================================================================================================================
+        /// Sums the face terms around each vertex in [v0,v1), and normalizes
+        //=====================================================================================================================
+        void GatherVertexNormals( float* pNormals, size_t nNormalStride, size_t v0, size_t v1,
+                                  const VertexFaceAdjacency& adjacency, const FaceTerms& terms )
+        {
+            const float* pWeights = terms.CornerWeights.empty() ? 0 : terms.CornerWeights.data();
+            for( size_t v=v0; v<v1; v++ )
+            {
+                const uint32* pCorners = adjacency.GetCorners( (uint32)v );
+                uint32 nCorners = adjacency.GetCornerCount( (uint32)v );
+
+                float N[3] = {0,0,0};
+                for( uint32 i=0; i<nCorners; i++ )
+                {
+                    uint32 c = pCorners[i];
+                    uint32 f = c/3;
+                    float w = pWeights ? pWeights[c] : 1.0f;
+                    N[0] += w*terms.Nx[f];
+                    N[1] += w*terms.Ny[f];
+                    N[2] += w*terms.Nz[f];
+                }
+
+                NormalizeOrZero( N );
+
+                float* pOut = GetStrided( pNormals, nNormalStride, v );
+                pOut[0] = N[0];
+                pOut[1] = N[1];
+                pOut[2] = N[2];
+            }
+        }
+    }
+
+    //=====================================================================================================================
+    //
+    //            VertexFaceAdjacency
+    //
+    //=====================================================================================================================
+
+    //=====================================================================================================================
+    /// Counting sort of corners by vertex.  Corners are visited in order, so each vertex's list comes out sorted
+    //=====================================================================================================================
+    void VertexFaceAdjacency::Build( const uint32* pIndices, uint32 nTriangles, uint32 nVertices )
+    {
+        size_t nCorners = 3*(size_t)nTriangles;
+        m_Offsets.assign( nVertices+1, 0 );
+        m_Corners.resize( nCorners );
+
+        for( size_t c=0; c<nCorners; c++ )
+            m_Offsets[ pIndices[c]+1 ]++;
+        for( uint32 v=0; v<nVertices; v++ )
+            m_Offsets[v+1] += m_Offsets[v];
+
+        std::vector<uint32> cursors( m_Offsets.begin(), m_Offsets.end()-1 );
+        for( size_t c=0; c<nCorners; c++ )
+            m_Corners[ cursors[ pIndices[c] ]++ ] = (uint32) c;
+    }
+
+    //=====================================================================================================================
+    /// Same counting sort, with atomic counters.  The fill order is racy, so each vertex's list is sorted afterwards
+    //=====================================================================================================================
+    void VertexFaceAdjacency::Build( ThreadPool& pool, const uint32* pIndices, uint32 nTriangles, uint32 nVertices )
+    {
+        size_t nCorners = 3*(size_t)nTriangles;
+        m_Offsets.resize( nVertices+1 );
+        m_Corners.resize( nCorners );
+
+        std::atomic<uint32>* pCursors = new std::atomic<uint32>[nVertices];
+        ParallelFor( pool, 0, nVertices, VERTEX_GRAIN,
+            [pCursors]( size_t v ) { pCursors[v].store( 0, std::memory_order_relaxed ); } );
+
+        ParallelForChunked( pool, 0, nCorners, CORNER_GRAIN,
+            [pCursors,pIndices]( size_t c0, size_t c1 )
+            {
+                for( size_t c=c0; c<c1; c++ )
+                    pCursors[ pIndices[c] ].fetch_add( 1, std::memory_order_relaxed );
+            } );
+
+        m_Offsets[0] = 0;
+        for( uint32 v=0; v<nVertices; v++ )
+        {
+            m_Offsets[v+1] = m_Offsets[v] + pCursors[v].load( std::memory_order_relaxed );
+            pCursors[v].store( m_Offsets[v], std::memory_order_relaxed );
+        }
+
+        uint32* pCorners = m_Corners.data();
+        ParallelForChunked( pool, 0, nCorners, CORNER_GRAIN,
+            [pCursors,pIndices,pCorners]( size_t c0, size_t c1 )
+            {
+                for( size_t c=c0; c<c1; c++ )
+                    pCorners[ pCursors[ pIndices[c] ].fetch_add( 1, std::memory_order_relaxed ) ] = (uint32) c;
+            } );
+
+        delete[] pCursors;
+
+        const uint32* pOffsets = m_Offsets.data();
+        ParallelFor( pool, 0, nVertices, VERTEX_GRAIN,
+            [pOffsets,pCorners]( size_t v ) { std::sort( pCorners + pOffsets[v], pCorners + pOffsets[v+1] ); } );
+    }
+
+    //=====================================================================================================================
+    //
+    //            Normals
+    //
+    //=====================================================================================================================
+
+    //=====================================================================================================================
+    /// With one thread, scattering face terms into the vertices is faster than building adjacency.  Every vertex
+    ///  still sums its faces in ascending order, with the same weights, so this matches the gather bit for bit
+    //=====================================================================================================================
+    void ComputeVertexNormals( float* pNormals, size_t nNormalStride,
+                               const float* pPositions, size_t nPositionStride,
+                               const uint32* pIndices, uint32 nTriangles, uint32 nVertices,
+                               NormalWeighting eWeighting )
+    {
+        for( uint32 v=0; v<nVertices; v++ )
+        {
+            float* pOut = GetStrided( pNormals, nNormalStride, v );
+            pOut[0] = 0.0f;
+            pOut[1] = 0.0f;
+            pOut[2] = 0.0f;
+        }
+
+        const size_t W = float8::WIDTH;
+        for( size_t t=0; t<nTriangles; t += W )
+        {
+            size_t nLanes = std::min( W, nTriangles-t );
+
+            float N[3][W];
+            float A[3][W];
+            ComputeFacePacket( N, A, t, nLanes, pPositions, nPositionStride, pIndices, eWeighting );
+
+            for( size_t l=0; l<nLanes; l++ )
+            {
+                for( size_t k=0; k<3; k++ )
+                {
+                    float w = (eWeighting == NORMAL_WEIGHT_ANGLE) ? A[k][l] : 1.0f;
+                    float* pOut = GetStrided( pNormals, nNormalStride, pIndices[3*(t+l)+k] );
+                    pOut[0] += w*N[0][l];
+                    pOut[1] += w*N[1][l];
+                    pOut[2] += w*N[2][l];
+                }
+            }
+        }
+
+        for( uint32 v=0; v<nVertices; v++ )
+            NormalizeOrZero( GetStrided( pNormals, nNormalStride, v ) );
+    }
+
+    //=====================================================================================================================
+    /// Each pass writes only to its own faces or vertices, and the gather visits each vertex's faces in sorted order,
+    ///  so no atomics are needed outside of adjacency construction
+    //=====================================================================================================================
+    void ComputeVertexNormals( ThreadPool& pool,
+                               float* pNormals, size_t nNormalStride,
+                               const float* pPositions, size_t nPositionStride,
+                               const uint32* pIndices, uint32 nTriangles, uint32 nVertices,
+                               NormalWeighting eWeighting )
+    {
+        VertexFaceAdjacency adjacency;
+        adjacency.Build( pool, pIndices, nTriangles, nVertices );
+
+        FaceTerms terms;
+        AllocateFaceTerms( terms, nTriangles, eWeighting );
+        ParallelForChunked( pool, 0, nTriangles, FACE_GRAIN,
+            [&]( size_t t0, size_t t1 )
+            {
+                ComputeFaceTerms( terms, t0, t1, pPositions, nPositionStride, pIndices, eWeighting );
+            } );
+
+        ParallelForChunked( pool, 0, nVertices, VERTEX_GRAIN,
+            [&]( size_t v0, size_t v1 )
+            {
+                GatherVertexNormals( pNormals, nNormalStride, v0, v1, adjacency, terms );
+            } );
+    }
+
+    //=====================================================================================================================
+    //
+    //            Welding
+    //
+    //=====================================================================================================================
+
+    namespace
+    {
+        enum
+        {
+            WELD_GRAIN   = 16384,       ///< Vertices per chunk when welding
+            WELD_KEY_MAX = 8,           ///< Integers in a weld key:  3 for position, 3 for normal, 2 for UV
+        };
+
+        const uint64 EMPTY_SLOT = 0xffffffffffffffffull;
+
+        /// Runs fn(i0,i1) over chunks of a range, in order, on the calling thread
+        struct SerialChunks
+        {
+            template< class Func_T >
+            void operator()( size_t nBegin, size_t nEnd, size_t nGrain, const Func_T& fn ) const
+            {
+                for( size_t i=nBegin; i<nEnd; i += nGrain )
+                    fn( i, std::min( i+nGrain, nEnd ) );
+            }
+        };
+
+        /// Runs fn(i0,i1) over the same chunks as SerialChunks, on a thread pool
+        struct PoolChunks
+        {
+            explicit PoolChunks( ThreadPool& pool ) : rPool(pool) {}
+
+            template< class Func_T >
+            void operator()( size_t nBegin, size_t nEnd, size_t nGrain, const Func_T& fn ) const
+            {
+                ParallelForChunked( rPool, nBegin, nEnd, nGrain, fn );
+            }
+
+            ThreadPool& rPool;
+        };
+
+        /// Snaps a value to a grid with spacing 1/fScale.  With a scale of zero, the bits are used as they are
+        inline uint32 QuantizeWeldValue( float f, float fScale )
+        {
+            if( fScale == 0.0f )
+            {
+                if( f == 0.0f )
+                    return 0;   // -0 == +0
+
+                uint32 n;
+                memcpy( &n, &f, sizeof(n) );
+                return n;
+            }
+
+            float q = floorf( f*fScale );
+            q = std::min( std::max( q, -2147483648.0f ), 2147483520.0f );
+            return (uint32)(int)q;
+        }
+
+        /// Computes, hashes and compares the quantized attributes of vertices
+        class WeldKeys
+        {
+        public:
+
+            WeldKeys( const void* pVertices, const WeldFormat& format )
+                : m_pVertices( (const uint8*) pVertices ), m_rFormat(format)
+            {
+                m_fPositionScale = (format.fPositionTolerance > 0.0f) ? 1.0f / format.fPositionTolerance : 0.0f;
+                m_fNormalScale   = (format.fNormalTolerance > 0.0f)   ? 1.0f / format.fNormalTolerance   : 0.0f;
+                m_fUVScale       = (format.fUVTolerance > 0.0f)       ? 1.0f / format.fUVTolerance       : 0.0f;
+            }
+
+            /// Returns the number of integers written to 'pKey'
+            uint32 GetKey( uint32 pKey[WELD_KEY_MAX], uint32 v ) const
+            {
+                const uint8* pVertex = m_pVertices + m_rFormat.nStride*v;
+                uint32 n = 0;
+                n += Quantize( pKey+n, pVertex + m_rFormat.nPositionOffset, 3, m_fPositionScale );
+                if( m_rFormat.nNormalOffset != WeldFormat::NO_ATTRIBUTE )
+                    n += Quantize( pKey+n, pVertex + m_rFormat.nNormalOffset, 3, m_fNormalScale );
+                if( m_rFormat.nUVOffset != WeldFormat::NO_ATTRIBUTE )
+                    n += Quantize( pKey+n, pVertex + m_rFormat.nUVOffset, 2, m_fUVScale );
+                return n;
+            }
+
+            uint32 Hash( uint32 v ) const
+            {
+                uint32 pKey[WELD_KEY_MAX];
+                uint32 n = GetKey( pKey, v );
+                uint32 h = 0x9747b28c;
+                for( uint32 i=0; i<n; i++ )
+                {
+                    h ^= pKey[i];
+                    h *= 0x5bd1e995;
+                    h ^= h >> 15;
+                }
+                h ^= h >> 16;
+                h *= 0x85ebca6b;
+                h ^= h >> 13;
+                return h;
+            }
+
+            bool Equal( uint32 a, uint32 b ) const
+            {
+                uint32 pKeyA[WELD_KEY_MAX];
+                uint32 pKeyB[WELD_KEY_MAX];
+                uint32 n = GetKey( pKeyA, a );
+                GetKey( pKeyB, b );
+                return memcmp( pKeyA, pKeyB, n*sizeof(uint32) ) == 0;
+            }
+
+        private:
+
+            static uint32 Quantize( uint32* pKey, const uint8* pAttribute, uint32 nComponents, float fScale )
+            {
+                float f[3];
+                memcpy( f, pAttribute, nComponents*sizeof(float) );
+                for( uint32 i=0; i<nComponents; i++ )
+                    pKey[i] = QuantizeWeldValue( f[i], fScale );
+                return nComponents;
+            }
+
+            const uint8* m_pVertices;
+            const WeldFormat& m_rFormat;
+            float m_fPositionScale;
+            float m_fNormalScale;
+            float m_fUVScale;
+        };
+
+        //=====================================================================================================================
+        /// Welds vertices using an open-addressed hash table of vertex indices.
+        ///
+        ///  Each slot ends up holding the lowest-numbered vertex with its key, no matter which thread claimed it first,
+        ///   and the output is numbered by chunk, so the result does not depend on how the chunks were scheduled
+        //=====================================================================================================================
+        template< class ForEach_T >
+        uint32 WeldVerticesImpl( const ForEach_T& ForEach, uint32* pRemap, void* pVerticesOut,
+                                 const void* pVertices, uint32 nVertices, const WeldFormat& format )
+        {
+            if( !nVertices )
+                return 0;
+
+            WeldKeys keys( pVertices, format );
+            std::vector<uint32> hashes( nVertices );
+            uint32* pHashes = hashes.data();
+            ForEach( 0, nVertices, WELD_GRAIN,
+                [&]( size_t v0, size_t v1 )
+                {
+                    for( size_t v=v0; v<v1; v++ )
+                        pHashes[v] = keys.Hash( (uint32)v );
+                } );
+
+            // table is at most half full, which keeps the probe sequences short.  Slots hold the hash in the high
+            //  half and a vertex index in the low half, so that most mismatches are rejected without touching the vertex
+            size_t nTableSize = 1;
+            while( nTableSize < 2*(size_t)nVertices )
+                nTableSize *= 2;
+            size_t nMask = nTableSize-1;
+
+            std::atomic<uint64>* pTable = new std::atomic<uint64>[nTableSize];
+            ForEach( 0, nTableSize, 4*WELD_GRAIN,
+                [pTable]( size_t s0, size_t s1 )
+                {
+                    for( size_t s=s0; s<s1; s++ )
+                        pTable[s].store( EMPTY_SLOT, std::memory_order_relaxed );
+                } );
+
+            // insert.  Once a slot is claimed, it only ever holds vertices with the same key,
+            //   so an atomic min is enough to settle on the representative.  Remember each vertex's slot
+            ForEach( 0, nVertices, WELD_GRAIN,
+                [&]( size_t v0, size_t v1 )
+                {
+                    for( size_t i=v0; i<v1; i++ )
+                    {
+                        uint32 v = (uint32) i;
+                        uint64 nHash = pHashes[v];
+                        uint64 nEntry = (nHash << 32) | v;
+                        size_t s = nHash & nMask;
+                        uint64 nCurrent = pTable[s].load( std::memory_order_acquire );
+                        for(;;)
+                        {
+                            if( nCurrent == EMPTY_SLOT )
+                            {
+                                if( pTable[s].compare_exchange_weak( nCurrent, nEntry, std::memory_order_acq_rel ) )
+                                    break;
+                            }
+                            else if( (nCurrent >> 32) == nHash && keys.Equal( (uint32) nCurrent, v ) )
+                            {
+                                while( nEntry < nCurrent && !pTable[s].compare_exchange_weak( nCurrent, nEntry, std::memory_order_acq_rel ) )
+                                    ;
+                                break;
+                            }
+                            else
+                            {
+                                s = (s+1) & nMask;
+                                nCurrent = pTable[s].load( std::memory_order_acquire );
+                            }
+                        }
+                        pRemap[v] = (uint32) s;
+                    }
+                } );
+
+            // now that every slot has settled, look up each vertex's representative
+            ForEach( 0, nVertices, WELD_GRAIN,
+                [pRemap,pTable]( size_t v0, size_t v1 )
+                {
+                    for( size_t v=v0; v<v1; v++ )
+                        pRemap[v] = (uint32) pTable[ pRemap[v] ].load( std::memory_order_relaxed );
+                } );
+
+            delete[] pTable;
+
+            // number the representatives in order.  Count per chunk, then scan the counts
+            size_t nChunks = (nVertices + WELD_GRAIN-1) / WELD_GRAIN;
+            std::vector<uint32> chunkStarts( nChunks+1, 0 );
+            uint32* pChunkStarts = chunkStarts.data();
+            ForEach( 0, nVertices, WELD_GRAIN,
+                [pRemap,pChunkStarts]( size_t v0, size_t v1 )
+                {
+                    uint32 n = 0;
+                    for( size_t v=v0; v<v1; v++ )
+                        n += (pRemap[v] == v) ? 1 : 0;
+                    pChunkStarts[ v0/WELD_GRAIN + 1 ] = n;
+                } );
+            for( size_t c=0; c<nChunks; c++ )
+                chunkStarts[c+1] += chunkStarts[c];
+
+            // hashes are no longer needed.  Reuse them for the output slot of each representative
+            uint32* pSlots = pHashes;
+            const uint8* pIn = (const uint8*) pVertices;
+            uint8* pOut = (uint8*) pVerticesOut;
+            size_t nStride = format.nStride;
+            ForEach( 0, nVertices, WELD_GRAIN,
+                [=]( size_t v0, size_t v1 )
+                {
+                    uint32 n = pChunkStarts[ v0/WELD_GRAIN ];
+                    for( size_t v=v0; v<v1; v++ )
+                    {
+                        if( pRemap[v] == v )
+                        {
+                            if( pOut )
+                                memcpy( pOut + n*nStride, pIn + v*nStride, nStride );
+                            pSlots[v] = n++;
+                        }
+                    }
+                } );
+
+            ForEach( 0, nVertices, WELD_GRAIN,
+                [pRemap,pSlots]( size_t v0, size_t v1 )
+                {
+                    for( size_t v=v0; v<v1; v++ )
+                        pRemap[v] = pSlots[ pRemap[v] ];
+                } );
+
+            return chunkStarts[nChunks];
+        }
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    uint32 WeldVertices( uint32* pRemap, void* pVerticesOut, const void* pVertices, uint32 nVertices, const WeldFormat& format )
+    {
+        return WeldVerticesImpl( SerialChunks(), pRemap, pVerticesOut, pVertices, nVertices, format );
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    uint32 WeldVertices( ThreadPool& pool, uint32* pRemap, void* pVerticesOut, const void* pVertices, uint32 nVertices, const WeldFormat& format )
+    {
+        return WeldVerticesImpl( PoolChunks(pool), pRemap, pVerticesOut, pVertices, nVertices, format );
+    }
+}
@@ -0,0 +1,434 @@
+//=====================================================================================================================
+//
+//   MeshOptimize.cpp
+//
+//   Index and vertex buffer reordering, for GPU vertex cache and overdraw efficiency
+//
+//   The lazy man's utility library
+//   Joshua Barczak
+//   Copyright 2016 Joshua Barczak
+//
+//   LICENSE:  See Doc\License.txt for terms and conditions
+//
+//=====================================================================================================================
+
+#include "MeshOptimize.h"
+#include "Mesh.h"
+#include "VectorMath.h"
+
+#include <algorithm>
+#include <vector>
+#include <math.h>
+#include <string.h>
+
+namespace Simpleton
+{
+    namespace
+    {
+        //=====================================================================================================================
+        //  Forsyth's scoring function, with the constants from his paper
+        //=====================================================================================================================
+        enum
+        {
+            FORSYTH_CACHE_SIZE   = 32,  ///< Size of the LRU cache that is modelled while scoring
+            FORSYTH_VALENCE_SIZE = 32,  ///< Valence scores are tabulated up to this many remaining triangles
+        };
+
+        const float CACHE_DECAY_POWER   = 1.5f;
+        const float LAST_TRI_SCORE      = 0.75f;
+        const float VALENCE_BOOST_SCALE = 2.0f;
+        const float VALENCE_BOOST_POWER = 0.5f;
+
+        class ForsythScore
+        {
+        public:
+            ForsythScore()
+            {
+                for( int i=0; i<FORSYTH_CACHE_SIZE; i++ )
+                {
+                    // the three most recent vertices get a fixed score, so that the last triangle's own edges are not
+                    //  favored over the rest of the cache
+                    if( i < 3 )
+                        m_Cache[i] = LAST_TRI_SCORE;
+                    else
+                        m_Cache[i] = powf( 1.0f - (i-3)/(float)(FORSYTH_CACHE_SIZE-3), CACHE_DECAY_POWER );
+                }
+
+                m_Valence[0] = 0.0f;
+                for( int i=1; i<FORSYTH_VALENCE_SIZE; i++ )
+                    m_Valence[i] = VALENCE_BOOST_SCALE * powf( (float)i, -VALENCE_BOOST_POWER );
+            }
+
+            /// Score of a vertex at position 'nCachePos' (-1 if not cached) which has 'nLiveTris' triangles left to emit
+            float operator()( int nCachePos, uint32 nLiveTris ) const
+            {
+                if( nLiveTris == 0 )
+                    return -1.0f;
+
+                float fScore = (nCachePos >= 0) ? m_Cache[nCachePos] : 0.0f;
+                if( nLiveTris < FORSYTH_VALENCE_SIZE )
+                    return fScore + m_Valence[nLiveTris];
+                return fScore + VALENCE_BOOST_SCALE * powf( (float)nLiveTris, -VALENCE_BOOST_POWER );
+            }
+
+        private:
+            float m_Cache[FORSYTH_CACHE_SIZE];
+            float m_Valence[FORSYTH_VALENCE_SIZE];
+        };
+
+
+        /// FIFO cache simulation, by timestamp.  A vertex is in the cache if fewer than 'nCacheSize' misses have
+        ///  happened since it was last loaded.  Timestamps are 64-bit, so that they can't wrap on huge meshes
+        class FIFOCacheSim
+        {
+        public:
+            FIFOCacheSim( uint32 nVertices, uint32 nCacheSize )
+                : m_Timestamps( nVertices, 0 ), m_nCacheSize(nCacheSize), m_nTime(nCacheSize+1)
+            {
+            }
+
+            /// Returns the number of misses caused by a triangle
+            uint32 Triangle( const uint32* pTri )
+            {
+                uint32 nMisses = 0;
+                for( int k=0; k<3; k++ )
+                {
+                    uint32 v = pTri[k];
+                    if( m_nTime - m_Timestamps[v] > m_nCacheSize )
+                    {
+                        m_Timestamps[v] = m_nTime++;
+                        nMisses++;
+                    }
+                }
+                return nMisses;
+            }
+
+            /// Empties the cache
+            void Flush() { m_nTime += m_nCacheSize+1; }
+
+            /// True if the vertex has ever been loaded
+            bool WasLoaded( uint32 v ) const { return m_Timestamps[v] != 0; }
+
+        private:
+            std::vector<uint64> m_Timestamps;
+            uint32 m_nCacheSize;
+            uint64 m_nTime;
+        };
+
+        enum
+        {
+            OVERDRAW_CACHE_SIZE = 16,           ///< Cache size used to find cluster boundaries in OptimizeOverdraw
+            NO_TRIANGLE         = 0xffffffff,
+        };
+
+        inline const float* GetPosition( const float* p, size_t nStride, uint32 i )
+        {
+            return (const float*)( ((const uint8*)p) + nStride*i );
+        }
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void OptimizeVertexCache( uint32* pIndicesOut, const uint32* pIndices, uint32 nTriangles, uint32 nVertices )
+    {
+        if( !nTriangles )
+            return;
+
+        // the output may alias the input, so work from a copy
+        std::vector<uint32> indices( pIndices, pIndices + 3*(size_t)nTriangles );
+        const uint32* pIB = indices.data();
+
+        // per-vertex lists of triangles which have yet to be emitted.  The first nLive[v] entries are the live ones
+        VertexFaceAdjacency adjacency;
+        adjacency.Build( pIB, nTriangles, nVertices );
+
+        std::vector<uint32> offsets( nVertices );
+        std::vector<uint32> tris( 3*(size_t)nTriangles );
+        std::vector<uint32> nLive( nVertices );
+        for( uint32 v=0; v<nVertices; v++ )
+        {
+            offsets[v] = (uint32)( adjacency.GetCorners(v) - adjacency.GetCorners(0) );
+            nLive[v] = adjacency.GetCornerCount(v);
+            for( uint32 i=0; i<nLive[v]; i++ )
+                tris[offsets[v]+i] = adjacency.GetCorners(v)[i] / 3;
+        }
+
+        ForsythScore score;
+        std::vector<int>   cachePos( nVertices, -1 );
+        std::vector<float> vertexScore( nVertices );
+        for( uint32 v=0; v<nVertices; v++ )
+            vertexScore[v] = score( -1, nLive[v] );
+
+        std::vector<uint8> emitted( nTriangles, 0 );
+        uint32 nBest = 0;
+        float fBestScore = -1.0f;
+        for( uint32 t=0; t<nTriangles; t++ )
+        {
+            float f = vertexScore[pIB[3*t]] + vertexScore[pIB[3*t+1]] + vertexScore[pIB[3*t+2]];
+            if( f > fBestScore )
+            {
+                fBestScore = f;
+                nBest = t;
+            }
+        }
+
+        uint32 cache[FORSYTH_CACHE_SIZE+3];
+        uint32 nCache = 0;
+        uint32 nCursor = 0;     ///< Everything before this has been emitted.  Used to restart when the cache runs dry
+        for( uint32 n=0; n<nTriangles; n++ )
+        {
+            if( nBest == NO_TRIANGLE )
+            {
+                while( emitted[nCursor] )
+                    nCursor++;
+                nBest = nCursor;
+            }
+
+            const uint32* pTri = pIB + 3*nBest;
+            pIndicesOut[3*n+0] = pTri[0];
+            pIndicesOut[3*n+1] = pTri[1];
+            pIndicesOut[3*n+2] = pTri[2];
+            emitted[nBest] = 1;
+
+            // retire the triangle from its vertices' lists
+            for( int k=0; k<3; k++ )
+            {
+                uint32 v = pTri[k];
+                uint32* pList = tris.data() + offsets[v];
+                uint32 i = 0;
+                while( pList[i] != nBest )
+                    i++;
+                pList[i] = pList[--nLive[v]];
+                pList[nLive[v]] = nBest;
+            }
+
+            // push the triangle's vertices onto the front of the cache.  Anything pushed off the end falls out
+            uint32 newCache[FORSYTH_CACHE_SIZE+3];
+            uint32 nNewCache = 0;
+            for( int k=0; k<3; k++ )
+            {
+                if( k == 0 || (pTri[k] != pTri[0] && pTri[k] != pTri[k-1]) )
+                    newCache[nNewCache++] = pTri[k];
+            }
+            for( uint32 i=0; i<nCache; i++ )
+            {
+                uint32 v = cache[i];
+                if( v != pTri[0] && v != pTri[1] && v != pTri[2] )
+                    newCache[nNewCache++] = v;
+            }
+
+            for( uint32 i=0; i<nNewCache; i++ )
+            {
+                uint32 v = newCache[i];
+                cachePos[v] = (i < FORSYTH_CACHE_SIZE) ? (int)i : -1;
+                vertexScore[v] = score( cachePos[v], nLive[v] );
+            }
+
+            // re-score the live triangles that touch the cache, and pick the next one from among them
+            nBest = NO_TRIANGLE;
+            fBestScore = -1.0f;
+            for( uint32 i=0; i<nNewCache; i++ )
+            {
+                uint32 v = newCache[i];
+                const uint32* pList = tris.data() + offsets[v];
+                for( uint32 j=0; j<nLive[v]; j++ )
+                {
+                    uint32 t = pList[j];
+                    float f = vertexScore[pIB[3*t]] + vertexScore[pIB[3*t+1]] + vertexScore[pIB[3*t+2]];
+                    if( f > fBestScore )
+                    {
+                        fBestScore = f;
+                        nBest = t;
+                    }
+                }
+            }
+
+            nCache = std::min( nNewCache, (uint32)FORSYTH_CACHE_SIZE );
+            memcpy( cache, newCache, nCache*sizeof(uint32) );
+        }
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void OptimizeOverdraw( uint32* pIndicesOut, const uint32* pIndices, uint32 nTriangles,
+                           const float* pPositions, size_t nPositionStride, uint32 nVertices,
+                           float fThreshold )
+    {
+        if( !nTriangles )
+            return;
+
+        // hard boundaries:  triangles which miss on all three vertices.  The cache is effectively empty there already,
+        //   so splitting costs nothing
+        std::vector<uint32> clusterStarts;
+        {
+            FIFOCacheSim cache( nVertices, OVERDRAW_CACHE_SIZE );
+            std::vector<uint32> hardStarts;
+            for( uint32 t=0; t<nTriangles; t++ )
+            {
+                if( cache.Triangle( pIndices + 3*t ) == 3 || t == 0 )
+                    hardStarts.push_back(t);
+            }
+            hardStarts.push_back( nTriangles );
+
+            // soft boundaries:  split a hard cluster wherever the ACMR since the last split has fallen to within
+            //   the threshold of the whole cluster's
+            for( size_t c=0; c+1<hardStarts.size(); c++ )
+            {
+                uint32 t0 = hardStarts[c];
+                uint32 t1 = hardStarts[c+1];
+
+                cache.Flush();
+                uint32 nClusterMisses = 0;
+                for( uint32 t=t0; t<t1; t++ )
+                    nClusterMisses += cache.Triangle( pIndices + 3*t );
+                float fLimit = fThreshold * nClusterMisses / (float)(t1-t0);
+
+                cache.Flush();
+                clusterStarts.push_back( t0 );
+                uint32 nStart = t0;
+                uint32 nMisses = 0;
+                for( uint32 t=t0; t<t1; t++ )
+                {
+                    nMisses += cache.Triangle( pIndices + 3*t );
+                    if( t+1 < t1 && nMisses <= fLimit * (t+1-nStart) )
+                    {
+                        clusterStarts.push_back( t+1 );
+                        nStart  = t+1;
+                        nMisses = 0;
+                        cache.Flush();
+                    }
+                }
+            }
+            clusterStarts.push_back( nTriangles );
+        }
+
+        // area-weighted centroid and normal of each cluster, and of the whole mesh
+        size_t nClusters = clusterStarts.size()-1;
+        std::vector<Vec3f> centroids( nClusters );
+        std::vector<Vec3f> normals( nClusters );
+        Vec3f vMeshCentroid(0,0,0);
+        float fMeshArea = 0.0f;
+        for( size_t c=0; c<nClusters; c++ )
+        {
+            Vec3f vCentroid(0,0,0);
+            Vec3f vNormal(0,0,0);
+            float fArea = 0.0f;
+            for( uint32 t=clusterStarts[c]; t<clusterStarts[c+1]; t++ )
+            {
+                const float* p0 = GetPosition( pPositions, nPositionStride, pIndices[3*t] );
+                const float* p1 = GetPosition( pPositions, nPositionStride, pIndices[3*t+1] );
+                const float* p2 = GetPosition( pPositions, nPositionStride, pIndices[3*t+2] );
+                Vec3f P0( p0[0], p0[1], p0[2] );
+                Vec3f P1( p1[0], p1[1], p1[2] );
+                Vec3f P2( p2[0], p2[1], p2[2] );
+
+                Vec3f N = Cross3( P1-P0, P2-P0 );
+                float fTriArea = Length3(N);
+                vCentroid += (P0+P1+P2) * (fTriArea/3.0f);
+                vNormal   += N;
+                fArea     += fTriArea;
+            }
+
+            vMeshCentroid += vCentroid;
+            fMeshArea     += fArea;
+            centroids[c] = (fArea > 0.0f) ? vCentroid / fArea : vCentroid;
+            normals[c]   = vNormal;
+        }
+        if( fMeshArea > 0.0f )
+            vMeshCentroid = vMeshCentroid / fMeshArea;
+
+        // clusters that face away from the middle of the mesh are more likely to occlude others, so draw them first
+        std::vector<float> keys( nClusters );
+        std::vector<uint32> order( nClusters );
+        for( size_t c=0; c<nClusters; c++ )
+        {
+            float fLen = Length3( normals[c] );
+            keys[c] = (fLen > 0.0f) ? Dot3( centroids[c] - vMeshCentroid, normals[c] ) / fLen : 0.0f;
+            order[c] = (uint32) c;
+        }
+        std::stable_sort( order.begin(), order.end(),
+                          [&keys]( uint32 a, uint32 b ) { return keys[a] > keys[b]; } );
+
+        uint32* pOut = pIndicesOut;
+        for( size_t i=0; i<nClusters; i++ )
+        {
+            uint32 c = order[i];
+            size_t nIndices = 3*(size_t)( clusterStarts[c+1] - clusterStarts[c] );
+            memcpy( pOut, pIndices + 3*(size_t)clusterStarts[c], nIndices*sizeof(uint32) );
+            pOut += nIndices;
+        }
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    uint32 BuildVertexFetchRemap( uint32* pRemap, const uint32* pIndices, uint32 nTriangles, uint32 nVertices )
+    {
+        for( uint32 v=0; v<nVertices; v++ )
+            pRemap[v] = UNUSED_VERTEX;
+
+        uint32 nNext = 0;
+        for( size_t i=0; i<3*(size_t)nTriangles; i++ )
+        {
+            uint32 v = pIndices[i];
+            if( pRemap[v] == UNUSED_VERTEX )
+                pRemap[v] = nNext++;
+        }
+        return nNext;
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void RemapIndices( uint32* pIndicesOut, const uint32* pIndices, size_t nIndices, const uint32* pRemap )
+    {
+        for( size_t i=0; i<nIndices; i++ )
+            pIndicesOut[i] = pRemap[ pIndices[i] ];
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void RemapVertices( void* pVerticesOut, const void* pVertices, uint32 nVertices, size_t nVertexSize, const uint32* pRemap )
+    {
+        uint8* pOut = (uint8*) pVerticesOut;
+        const uint8* pIn = (const uint8*) pVertices;
+        for( uint32 v=0; v<nVertices; v++ )
+        {
+            if( pRemap[v] != UNUSED_VERTEX )
+                memcpy( pOut + nVertexSize*pRemap[v], pIn + nVertexSize*v, nVertexSize );
+        }
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    uint32 OptimizeVertexFetch( void* pVerticesOut, uint32* pIndices, uint32 nTriangles,
+                                const void* pVertices, uint32 nVertices, size_t nVertexSize )
+    {
+        std::vector<uint32> remap( nVertices );
+        uint32 nUsed = BuildVertexFetchRemap( remap.data(), pIndices, nTriangles, nVertices );
+        RemapVertices( pVerticesOut, pVertices, nVertices, nVertexSize, remap.data() );
+        RemapIndices( pIndices, pIndices, 3*(size_t)nTriangles, remap.data() );
+        return nUsed;
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    VertexCacheStatistics AnalyzeVertexCache( const uint32* pIndices, uint32 nTriangles, uint32 nVertices, uint32 nCacheSize )
+    {
+        FIFOCacheSim cache( nVertices, nCacheSize );
+        uint32 nMisses = 0;
+        for( uint32 t=0; t<nTriangles; t++ )
+            nMisses += cache.Triangle( pIndices + 3*t );
+
+        uint32 nReferenced = 0;
+        for( uint32 v=0; v<nVertices; v++ )
+        {
+            if( cache.WasLoaded(v) )
+                nReferenced++;
+        }
+
+        VertexCacheStatistics stats;
+        stats.nVerticesTransformed = nMisses;
+        stats.fACMR = nTriangles  ? nMisses / (float) nTriangles  : 0.0f;
+        stats.fATVR = nReferenced ? nMisses / (float) nReferenced : 0.0f;
+        return stats;
+    }
+}
@@ -0,0 +1,1186 @@
+//=====================================================================================================================
+//
+//   MeshSimplify.cpp
+//
+//   Quadric error metric mesh simplification
+//
+//   The lazy man's utility library
+//   Joshua Barczak
+//   Copyright 2016 Joshua Barczak
+//
+//   LICENSE:  See Doc\License.txt for terms and conditions
+//
+//=====================================================================================================================
+
+#include "MeshSimplify.h"
+#include "Mesh.h"
+#include "MeshOptimize.h"
+#include "PlyLoader.h"
+#include "Parallel.h"
+#include "VectorMath.h"
+
+#include <algorithm>
+#include <vector>
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+namespace Simpleton
+{
+    namespace
+    {
+        enum
+        {
+            CLUSTER_TRIANGLES = 65536,  ///< Approximate number of triangles per cluster in the parallel simplifier
+            COST_BUCKET_SHIFT = 19,     ///< Collapses are bucketed by the sign, exponent and top 4 mantissa bits of their cost
+            COST_BUCKETS      = 1 << (32-COST_BUCKET_SHIFT),
+            NO_VERTEX         = 0xffffffff,
+        };
+
+        const float BORDER_WEIGHT    = 10.0f;   ///< Weight of the planes which hold borders in place, relative to faces
+        const float MIN_FLIP_COSINE  = 0.25f;   ///< A collapse may not rotate a face's normal by more than acos() of this
+        const float PASS_ERROR_SCALE = 1.5f;    ///< A pass makes collapses up to this much worse than the one which meets its goal
+
+        enum VertexFlags
+        {
+            VERTEX_SEAM   = 1,  ///< Shares its position with another vertex, which has different attributes
+            VERTEX_LOCKED = 2,  ///< May not be moved
+        };
+
+        enum VertexKind
+        {
+            KIND_MANIFOLD,  ///< Interior vertex.  May collapse onto any neighbor
+            KIND_BORDER,    ///< On a single open border.  May only collapse along the border
+            KIND_SEAM,      ///< On a seam between two vertices.  Collapses along the seam, together with its partner
+            KIND_LOCKED,    ///< Seam junctions, non-manifold vertices, and anything the caller locked
+            KIND_UNUSED,
+        };
+
+        struct Quadric
+        {
+            float a00, a11, a22;
+            float a01, a02, a12;
+            float b0, b1, b2;
+            float c;
+            float w;    ///< Total weight.  Errors are weighted averages of squared plane distances
+        };
+
+        inline void AddPlane( Quadric& q, const Vec3f& n, float d, float w )
+        {
+            q.a00 += w*n.x*n.x;
+            q.a11 += w*n.y*n.y;
+            q.a22 += w*n.z*n.z;
+            q.a01 += w*n.x*n.y;
+            q.a02 += w*n.x*n.z;
+            q.a12 += w*n.y*n.z;
+            q.b0  += w*n.x*d;
+            q.b1  += w*n.y*d;
+            q.b2  += w*n.z*d;
+            q.c   += w*d*d;
+            q.w   += w;
+        }
+
+        inline void AddQuadric( Quadric& q, const Quadric& r )
+        {
+            q.a00 += r.a00;
+            q.a11 += r.a11;
+            q.a22 += r.a22;
+            q.a01 += r.a01;
+            q.a02 += r.a02;
+            q.a12 += r.a12;
+            q.b0  += r.b0;
+            q.b1  += r.b1;
+            q.b2  += r.b2;
+            q.c   += r.c;
+            q.w   += r.w;
+        }
+
+        inline float EvaluateQuadric( const Quadric& q, const Vec3f& p )
+        {
+            float r = q.a00*p.x*p.x + q.a11*p.y*p.y + q.a22*p.z*p.z
+                    + 2.0f*( q.a01*p.x*p.y + q.a02*p.x*p.z + q.a12*p.y*p.z )
+                    + 2.0f*( q.b0*p.x + q.b1*p.y + q.b2*p.z )
+                    + q.c;
+            return (q.w > 0.0f) ? fabsf(r) / q.w : 0.0f;
+        }
+
+        /// A mesh being simplified.  Positions are normalized so that the largest bounding box dimension is 1
+        struct SimplifyMeshData
+        {
+            std::vector<uint32>  Indices;
+            std::vector<uint32>  Sources;   ///< Input triangle which each triangle came from
+            std::vector<Vec3f>   Positions;
+            std::vector<uint32>  Wedges;    ///< Vertices with the same position have the same wedge.  Less than the vertex count
+            std::vector<uint8>   Flags;
+            std::vector<Quadric> Quadrics;  ///< Error of moving each vertex.  Computed by 'Simplifier::Prepare' if empty
+        };
+
+        /// A seam collapse moves a vertex and its partner at once, onto the two ends of the seam edges they share
+        struct Collapse
+        {
+            uint32 nVertex;
+            uint32 nTarget;
+            uint32 nPartner;        ///< NO_VERTEX, unless the collapse is along a seam
+            uint32 nPartnerTarget;
+            float  fCost;
+        };
+
+        /// A neighbor of a vertex, and the directed edges between them
+        struct VertexLink
+        {
+            uint32 nVertex;
+            uint32 nWedge;
+            uint32 nOut;    ///< Number of edges from the vertex to the neighbor
+            uint32 nIn;     ///< Number of edges from the neighbor to the vertex
+        };
+
+
+        //=====================================================================================================================
+        /// \brief Serial, multi-pass edge collapser.
+        ///
+        ///   Each pass picks every vertex's cheapest valid collapse, buckets the collapses by cost, and applies them
+        ///    cheapest-first.  A collapse locks the neighborhood it changes for the rest of the pass, so the collapses
+        ///    in one pass never interfere, and every check made while choosing them remains valid.
+        ///
+        //=====================================================================================================================
+        class Simplifier
+        {
+        public:
+
+            explicit Simplifier( SimplifyMeshData& rMesh ) : m_rMesh(rMesh) {}
+
+            /// Removes degenerate triangles, classifies the vertices, and computes the quadrics if the mesh has none
+            void Prepare();
+
+            /// Returns the largest squared error of any collapse made
+            float Run( uint32 nTargetTriangles, float fMaxErrorSq );
+
+        private:
+
+            uint32 GetTriangleCount() const { return (uint32)( m_rMesh.Indices.size() / 3 ); }
+
+            void GetLinks( std::vector<VertexLink>& links, uint32 v, uint32 nPartner=NO_VERTEX ) const;
+            void Classify();
+            void ComputeQuadrics();
+            bool FindCollapse( Collapse& rCollapse, uint32 v );
+            bool FindSeamCollapse( Collapse& rCollapse, uint32 v );
+            bool IsLinkConditionMet( uint32 u, uint32 nPartner, uint32 nSharedTriangles );
+            bool IsFlipFree( uint32 v, uint32 u ) const;
+            uint32 CountEdgeTriangles( uint32 v, uint32 u ) const;
+            void MoveVertex( uint32 v, uint32 u );
+            void RemoveDegenerateTriangles();
+
+            SimplifyMeshData& m_rMesh;
+            VertexFaceAdjacency m_Adjacency;
+
+            std::vector<uint8>   m_Kinds;
+            std::vector<uint32>  m_BorderNext;  ///< For border and seam vertices, the other end of the outgoing border edge
+            std::vector<uint32>  m_BorderPrev;  ///< For border and seam vertices, the other end of the incoming border edge
+            std::vector<uint32>  m_Partners;    ///< For seam vertices, the vertex on the other side of the seam
+            std::vector<uint32>  m_WedgeFirst;  ///< First seam vertex in each wedge.  Scratch space for 'Classify'
+            std::vector<uint32>  m_WedgeCounts; ///< Number of seam vertices in each wedge
+            std::vector<uint8>   m_Touched;     ///< Set on vertices whose neighborhood changed during the current pass
+
+            std::vector<VertexLink> m_LinksV;   ///< Scratch space
+            std::vector<VertexLink> m_LinksU;
+            std::vector<Collapse>   m_Candidates;
+            std::vector<uint32>     m_Shared;       ///< Number of triangles on each candidate's edge
+
+            Simplifier( const Simplifier& );
+            Simplifier& operator=( const Simplifier& );
+        };
+
+        //=====================================================================================================================
+        //=====================================================================================================================
+        void Simplifier::Prepare()
+        {
+            uint32 nVertices = (uint32) m_rMesh.Positions.size();
+            m_Kinds.resize( nVertices );
+            m_BorderNext.resize( nVertices );
+            m_BorderPrev.resize( nVertices );
+            m_Partners.resize( nVertices );
+            m_WedgeFirst.resize( nVertices );
+            m_WedgeCounts.resize( nVertices );
+            m_Touched.resize( nVertices );
+
+            RemoveDegenerateTriangles();
+            m_Adjacency.Build( m_rMesh.Indices.data(), GetTriangleCount(), nVertices );
+            Classify();
+            if( m_rMesh.Quadrics.empty() )
+                ComputeQuadrics();
+        }
+
+        //=====================================================================================================================
+        //=====================================================================================================================
+        float Simplifier::Run( uint32 nTargetTriangles, float fMaxErrorSq )
+        {
+            uint32 nVertices = (uint32) m_rMesh.Positions.size();
+            Prepare();
+
+            std::vector<Collapse> collapses;
+            std::vector<Collapse> sorted;
+            std::vector<uint32> buckets( COST_BUCKETS+1 );
+            float fResultErrorSq = 0.0f;
+
+            while( GetTriangleCount() > nTargetTriangles )
+            {
+                collapses.clear();
+                for( uint32 v=0; v<nVertices; v++ )
+                {
+                    Collapse c;
+                    if( FindCollapse( c, v ) && c.fCost <= fMaxErrorSq )
+                        collapses.push_back(c);
+                }
+                if( collapses.empty() )
+                    break;
+
+                // counting sort on the cost's bit pattern, which orders non-negative floats.  Stable, so ties go by vertex
+                std::fill( buckets.begin(), buckets.end(), 0 );
+                for( size_t i=0; i<collapses.size(); i++ )
+                {
+                    uint32 nBits;
+                    memcpy( &nBits, &collapses[i].fCost, sizeof(nBits) );
+                    buckets[ (nBits >> COST_BUCKET_SHIFT) + 1 ]++;
+                }
+                for( size_t b=0; b<COST_BUCKETS; b++ )
+                    buckets[b+1] += buckets[b];
+
+                sorted.resize( collapses.size() );
+                for( size_t i=0; i<collapses.size(); i++ )
+                {
+                    uint32 nBits;
+                    memcpy( &nBits, &collapses[i].fCost, sizeof(nBits) );
+                    sorted[ buckets[ nBits >> COST_BUCKET_SHIFT ]++ ] = collapses[i];
+                }
+
+                // each collapse removes about two triangles.  Don't go much past the cost of the collapse which would
+                //  reach the target, so that cheaper collapses uncovered by the next pass get a chance to go first
+                uint32 nExcess = GetTriangleCount() - nTargetTriangles;
+                size_t nGoal = std::min( (size_t)(nExcess/2), sorted.size()-1 );
+                float fPassLimit = sorted[nGoal].fCost * PASS_ERROR_SCALE;
+
+                std::fill( m_Touched.begin(), m_Touched.end(), 0 );
+                uint32 nRemoved = 0;
+                for( size_t i=0; i<sorted.size() && nRemoved < nExcess; i++ )
+                {
+                    const Collapse& c = sorted[i];
+                    if( c.fCost > fPassLimit && nRemoved > 0 )
+                        break;
+                    if( m_Touched[c.nVertex] || m_Touched[c.nTarget] )
+                        continue;
+                    if( c.nPartner != NO_VERTEX && (m_Touched[c.nPartner] || m_Touched[c.nPartnerTarget]) )
+                        continue;
+
+                    nRemoved += CountEdgeTriangles( c.nVertex, c.nTarget );
+                    MoveVertex( c.nVertex, c.nTarget );
+                    if( c.nPartner != NO_VERTEX )
+                    {
+                        nRemoved += CountEdgeTriangles( c.nPartner, c.nPartnerTarget );
+                        MoveVertex( c.nPartner, c.nPartnerTarget );
+                    }
+                    fResultErrorSq = std::max( fResultErrorSq, c.fCost );
+                }
+
+                if( nRemoved == 0 )
+                    break;
+
+                RemoveDegenerateTriangles();
+                m_Adjacency.Build( m_rMesh.Indices.data(), GetTriangleCount(), nVertices );
+                Classify();
+            }
+
+            return fResultErrorSq;
+        }
+
+        //=====================================================================================================================
+        /// Lists the vertices which share an edge with 'v', and how many edges go each way.
+        ///  If a seam partner is given, its edges are included, so that the links are those of the whole position
+        //=====================================================================================================================
+        void Simplifier::GetLinks( std::vector<VertexLink>& links, uint32 v, uint32 nPartner ) const
+        {
+            links.clear();
+            const uint32* pIndices = m_rMesh.Indices.data();
+            const uint32* pCorners = m_Adjacency.GetCorners(v);
+            uint32 nCorners = m_Adjacency.GetCornerCount(v);
+            const uint32* pPartnerCorners = 0;
+            uint32 nPartnerCorners = 0;
+            if( nPartner != NO_VERTEX )
+            {
+                pPartnerCorners = m_Adjacency.GetCorners(nPartner);
+                nPartnerCorners = m_Adjacency.GetCornerCount(nPartner);
+            }
+
+            for( uint32 i=0; i<nCorners+nPartnerCorners; i++ )
+            {
+                uint32 nCorner = (i < nCorners) ? pCorners[i] : pPartnerCorners[i-nCorners];
+                uint32 t = nCorner / 3;
+                uint32 k = nCorner % 3;
+                uint32 nNext = pIndices[ 3*t + (k+1)%3 ];
+                uint32 nPrev = pIndices[ 3*t + (k+2)%3 ];
+
+                for( int e=0; e<2; e++ )
+                {
+                    uint32 n = (e == 0) ? nNext : nPrev;
+                    uint32 nWedge = m_rMesh.Wedges[n];
+                    size_t j = 0;
+                    while( j < links.size() && links[j].nWedge != nWedge )
+                        j++;
+                    if( j == links.size() )
+                    {
+                        VertexLink link = { n, nWedge, 0, 0 };
+                        links.push_back( link );
+                    }
+                    if( e == 0 )
+                        links[j].nOut++;
+                    else
+                        links[j].nIn++;
+                }
+            }
+        }
+
+        //=====================================================================================================================
+        /// Edges are matched by wedge rather than by vertex, so that an attribute seam is not mistaken for a border.
+        ///  A seam vertex only sees the triangles on its own side of the seam, so it looks like a border vertex
+        //=====================================================================================================================
+        void Simplifier::Classify()
+        {
+            uint32 nVertices = (uint32) m_rMesh.Positions.size();
+            std::fill( m_WedgeFirst.begin(), m_WedgeFirst.end(), NO_VERTEX );
+            std::fill( m_WedgeCounts.begin(), m_WedgeCounts.end(), 0 );
+            for( uint32 v=0; v<nVertices; v++ )
+            {
+                m_BorderNext[v] = NO_VERTEX;
+                m_BorderPrev[v] = NO_VERTEX;
+                m_Partners[v]   = NO_VERTEX;
+
+                if( m_rMesh.Flags[v] & VERTEX_LOCKED )
+                {
+                    m_Kinds[v] = KIND_LOCKED;
+                    continue;
+                }
+                if( m_Adjacency.GetCornerCount(v) == 0 )
+                {
+                    m_Kinds[v] = KIND_UNUSED;
+                    continue;
+                }
+
+                GetLinks( m_LinksV, v );
+
+                uint32 nBorderOut = 0;
+                uint32 nBorderIn  = 0;
+                bool bComplex = false;
+                for( size_t i=0; i<m_LinksV.size(); i++ )
+                {
+                    const VertexLink& link = m_LinksV[i];
+                    if( link.nWedge == m_rMesh.Wedges[v] || link.nOut > 1 || link.nIn > 1 )
+                        bComplex = true;
+                    else if( link.nOut == 1 && link.nIn == 0 )
+                    {
+                        m_BorderNext[v] = link.nVertex;
+                        nBorderOut++;
+                    }
+                    else if( link.nOut == 0 && link.nIn == 1 )
+                    {
+                        m_BorderPrev[v] = link.nVertex;
+                        nBorderIn++;
+                    }
+                }
+
+                if( bComplex || nBorderOut != nBorderIn || nBorderOut > 1 )
+                    m_Kinds[v] = KIND_LOCKED;
+                else
+                    m_Kinds[v] = nBorderOut ? KIND_BORDER : KIND_MANIFOLD;
+
+                if( m_rMesh.Flags[v] & VERTEX_SEAM )
+                {
+                    uint32 nWedge = m_rMesh.Wedges[v];
+                    if( m_WedgeFirst[nWedge] == NO_VERTEX )
+                        m_WedgeFirst[nWedge] = v;
+                    else
+                    {
+                        m_Partners[v] = m_WedgeFirst[nWedge];
+                        m_Partners[ m_WedgeFirst[nWedge] ] = v;
+                    }
+                    m_WedgeCounts[nWedge]++;
+                }
+            }
+
+            // seam vertices may only move if there are two of them, each of which has one side of a single seam
+            //  running through it.  Walking along the seam, the two sides see the same positions in opposite order
+            const uint32* pWedges = m_rMesh.Wedges.data();
+            for( uint32 v=0; v<nVertices; v++ )
+            {
+                if( !(m_rMesh.Flags[v] & VERTEX_SEAM) || m_Kinds[v] == KIND_UNUSED )
+                    continue;
+
+                uint32 w = m_Partners[v];
+                if( m_WedgeCounts[ pWedges[v] ] != 2 )
+                {
+                    m_Kinds[v] = KIND_LOCKED;
+                    continue;
+                }
+                if( w < v )
+                    continue;
+
+                bool bPaired = m_Kinds[v] == KIND_BORDER && m_Kinds[w] == KIND_BORDER &&
+                               pWedges[ m_BorderNext[v] ] == pWedges[ m_BorderPrev[w] ] &&
+                               pWedges[ m_BorderPrev[v] ] == pWedges[ m_BorderNext[w] ];
+                m_Kinds[v] = bPaired ? KIND_SEAM : KIND_LOCKED;
+                m_Kinds[w] = m_Kinds[v];
+            }
+        }
+
+        //=====================================================================================================================
+        /// Area-weighted face planes, plus planes perpendicular to each border, so that borders don't shrink
+        //=====================================================================================================================
+        void Simplifier::ComputeQuadrics()
+        {
+            Quadric zero;
+            memset( &zero, 0, sizeof(zero) );
+            std::vector<Quadric>& quadrics = m_rMesh.Quadrics;
+            quadrics.assign( m_rMesh.Positions.size(), zero );
+
+            const uint32* pIndices = m_rMesh.Indices.data();
+            const Vec3f* pPositions = m_rMesh.Positions.data();
+            for( uint32 t=0; t<GetTriangleCount(); t++ )
+            {
+                const uint32* pTri = pIndices + 3*t;
+                const Vec3f& P0 = pPositions[pTri[0]];
+                const Vec3f& P1 = pPositions[pTri[1]];
+                const Vec3f& P2 = pPositions[pTri[2]];
+
+                Vec3f N = Cross3( P1-P0, P2-P0 );
+                float fLen = Length3(N);
+                if( fLen == 0.0f )
+                    continue;
+
+                N = N / fLen;
+                float d = -Dot3( N, P0 );
+                for( int k=0; k<3; k++ )
+                {
+                    uint32 v = pTri[k];
+                    AddPlane( quadrics[v], N, d, 0.5f*fLen );
+
+                    // border planes go to the vertex which could slide along the edge.  Seams get them too,
+                    //  from both sides, so that they stay where they are
+                    uint32 nNext = pTri[(k+1)%3];
+                    uint32 nPrev = pTri[(k+2)%3];
+                    if( m_Kinds[v] != KIND_BORDER && m_Kinds[v] != KIND_SEAM )
+                        continue;
+
+                    for( int e=0; e<2; e++ )
+                    {
+                        uint32 n = (e == 0) ? nNext : nPrev;
+                        if( n != ((e == 0) ? m_BorderNext[v] : m_BorderPrev[v]) )
+                            continue;
+
+                        Vec3f E = pPositions[n] - pPositions[v];
+                        Vec3f M = Cross3( E, N );
+                        float fLenM = Length3(M);
+                        if( fLenM == 0.0f )
+                            continue;
+                        M = M / fLenM;
+                        AddPlane( quadrics[v], M, -Dot3( M, pPositions[v] ), BORDER_WEIGHT*Dot3(E,E) );
+                    }
+                }
+            }
+        }
+
+        //=====================================================================================================================
+        /// Finds the cheapest collapse of 'v' which keeps the mesh manifold and does not flip any faces
+        //=====================================================================================================================
+        bool Simplifier::FindCollapse( Collapse& rCollapse, uint32 v )
+        {
+            uint32 nKind = m_Kinds[v];
+            if( nKind == KIND_SEAM )
+                return FindSeamCollapse( rCollapse, v );
+            if( nKind != KIND_MANIFOLD && nKind != KIND_BORDER )
+                return false;
+
+            GetLinks( m_LinksV, v );
+
+            // border vertices only move along the border, and only onto vertices which stay on it.  A seam vertex
+            //  is never a target, because it has several wedges, and we could not say which one v's triangles should use
+            m_Candidates.clear();
+            m_Shared.clear();
+            for( size_t i=0; i<m_LinksV.size(); i++ )
+            {
+                uint32 u = m_LinksV[i].nVertex;
+                if( m_rMesh.Flags[u] & VERTEX_SEAM )
+                    continue;
+                if( nKind == KIND_BORDER && ((u != m_BorderNext[v] && u != m_BorderPrev[v]) || m_Kinds[u] == KIND_MANIFOLD) )
+                    continue;
+
+                Collapse c;
+                c.nVertex        = v;
+                c.nTarget        = u;
+                c.nPartner       = NO_VERTEX;
+                c.nPartnerTarget = NO_VERTEX;
+                c.fCost          = EvaluateQuadric( m_rMesh.Quadrics[v], m_rMesh.Positions[u] );
+                m_Candidates.push_back( c );
+                m_Shared.push_back( m_LinksV[i].nIn + m_LinksV[i].nOut );
+            }
+
+            // validity checks cost much more than the quadrics, so try the targets cheapest first
+            for( size_t i=0; i<m_Candidates.size(); i++ )
+            {
+                size_t nBest = i;
+                for( size_t j=i+1; j<m_Candidates.size(); j++ )
+                {
+                    if( m_Candidates[j].fCost < m_Candidates[nBest].fCost )
+                        nBest = j;
+                }
+                std::swap( m_Candidates[i], m_Candidates[nBest] );
+                std::swap( m_Shared[i], m_Shared[nBest] );
+
+                uint32 u = m_Candidates[i].nTarget;
+                if( IsFlipFree( v, u ) && IsLinkConditionMet( u, NO_VERTEX, m_Shared[i] ) )
+                {
+                    rCollapse = m_Candidates[i];
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        //=====================================================================================================================
+        /// A seam vertex moves one step along the seam, and its partner moves the same step on the other side.
+        ///  The pair is considered once, from its lower numbered vertex
+        //=====================================================================================================================
+        bool Simplifier::FindSeamCollapse( Collapse& rCollapse, uint32 v )
+        {
+            uint32 w = m_Partners[v];
+            if( w < v )
+                return false;
+
+            GetLinks( m_LinksV, v, w );
+
+            Quadric q = m_rMesh.Quadrics[v];
+            AddQuadric( q, m_rMesh.Quadrics[w] );
+
+            Collapse candidates[2];
+            uint32 nCandidates = 0;
+            for( int e=0; e<2; e++ )
+            {
+                uint32 u  = (e == 0) ? m_BorderNext[v] : m_BorderPrev[v];
+                uint32 u2 = (e == 0) ? m_BorderPrev[w] : m_BorderNext[w];
+                if( m_Kinds[u] != KIND_SEAM || m_Partners[u] != u2 )
+                    continue;
+
+                Collapse& c = candidates[nCandidates++];
+                c.nVertex        = v;
+                c.nTarget        = u;
+                c.nPartner       = w;
+                c.nPartnerTarget = u2;
+                c.fCost          = EvaluateQuadric( q, m_rMesh.Positions[u] );
+            }
+            if( nCandidates == 2 && candidates[1].fCost < candidates[0].fCost )
+                std::swap( candidates[0], candidates[1] );
+
+            for( uint32 i=0; i<nCandidates; i++ )
+            {
+                const Collapse& c = candidates[i];
+                uint32 nShared = 0;
+                for( size_t j=0; j<m_LinksV.size(); j++ )
+                {
+                    if( m_LinksV[j].nWedge == m_rMesh.Wedges[c.nTarget] )
+                        nShared = m_LinksV[j].nIn + m_LinksV[j].nOut;
+                }
+
+                if( IsFlipFree( v, c.nTarget ) && IsFlipFree( w, c.nPartnerTarget ) &&
+                    IsLinkConditionMet( c.nTarget, c.nPartnerTarget, nShared ) )
+                {
+                    rCollapse = c;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        //=====================================================================================================================
+        /// The edge may only collapse if its ends have no neighbors in common, except the vertices opposite the edge.
+        ///  Otherwise the collapse would pinch the surface into a non-manifold edge.  Expects v's links in 'm_LinksV'
+        //=====================================================================================================================
+        bool Simplifier::IsLinkConditionMet( uint32 u, uint32 nPartner, uint32 nSharedTriangles )
+        {
+            GetLinks( m_LinksU, u, nPartner );
+
+            uint32 nCommon = 0;
+            for( size_t i=0; i<m_LinksV.size(); i++ )
+            {
+                for( size_t j=0; j<m_LinksU.size(); j++ )
+                {
+                    if( m_LinksV[i].nWedge == m_LinksU[j].nWedge )
+                        nCommon++;
+                }
+            }
+            return nCommon == nSharedTriangles;
+        }
+
+        //=====================================================================================================================
+        //=====================================================================================================================
+        bool Simplifier::IsFlipFree( uint32 v, uint32 u ) const
+        {
+            const uint32* pIndices = m_rMesh.Indices.data();
+            const Vec3f* pPositions = m_rMesh.Positions.data();
+            const uint32* pCorners = m_Adjacency.GetCorners(v);
+            uint32 nCorners = m_Adjacency.GetCornerCount(v);
+            for( uint32 i=0; i<nCorners; i++ )
+            {
+                uint32 t = pCorners[i] / 3;
+                uint32 k = pCorners[i] % 3;
+                const uint32* pTri = pIndices + 3*t;
+                if( pTri[0] == u || pTri[1] == u || pTri[2] == u )
+                    continue;
+
+                const Vec3f& P1 = pPositions[ pTri[(k+1)%3] ];
+                const Vec3f& P2 = pPositions[ pTri[(k+2)%3] ];
+                Vec3f vOld = Cross3( P1 - pPositions[v], P2 - pPositions[v] );
+                Vec3f vNew = Cross3( P1 - pPositions[u], P2 - pPositions[u] );
+
+                float fLenSq = Dot3( vNew, vNew );
+                if( fLenSq == 0.0f )
+                    return false;
+                if( Dot3( vOld, vNew ) < MIN_FLIP_COSINE * sqrtf( Dot3( vOld, vOld ) * fLenSq ) )
+                    return false;
+            }
+            return true;
+        }
+
+        /// Number of triangles which contain both ends of the edge.  These disappear when it collapses
+        //=====================================================================================================================
+        uint32 Simplifier::CountEdgeTriangles( uint32 v, uint32 u ) const
+        {
+            uint32 nCount = 0;
+            const uint32* pCorners = m_Adjacency.GetCorners(v);
+            for( uint32 i=0; i<m_Adjacency.GetCornerCount(v); i++ )
+            {
+                const uint32* pTri = m_rMesh.Indices.data() + 3*(pCorners[i]/3);
+                if( pTri[0] == u || pTri[1] == u || pTri[2] == u )
+                    nCount++;
+            }
+            return nCount;
+        }
+
+        //=====================================================================================================================
+        //=====================================================================================================================
+        void Simplifier::MoveVertex( uint32 v, uint32 u )
+        {
+            uint32* pIndices = m_rMesh.Indices.data();
+            const uint32* pCorners = m_Adjacency.GetCorners(v);
+            uint32 nCorners = m_Adjacency.GetCornerCount(v);
+
+            // everything around v changes.  Keep it out of the rest of this pass
+            for( uint32 i=0; i<nCorners; i++ )
+            {
+                uint32* pTri = pIndices + 3*(pCorners[i]/3);
+                m_Touched[pTri[0]] = 1;
+                m_Touched[pTri[1]] = 1;
+                m_Touched[pTri[2]] = 1;
+            }
+
+            for( uint32 i=0; i<nCorners; i++ )
+                pIndices[ pCorners[i] ] = u;
+
+            AddQuadric( m_rMesh.Quadrics[u], m_rMesh.Quadrics[v] );
+        }
+
+        //=====================================================================================================================
+        //=====================================================================================================================
+        void Simplifier::RemoveDegenerateTriangles()
+        {
+            uint32* pIndices = m_rMesh.Indices.data();
+            uint32* pSources = m_rMesh.Sources.data();
+            uint32 nOut = 0;
+            for( uint32 t=0; t<GetTriangleCount(); t++ )
+            {
+                uint32 i0 = pIndices[3*t];
+                uint32 i1 = pIndices[3*t+1];
+                uint32 i2 = pIndices[3*t+2];
+                if( i0 == i1 || i1 == i2 || i2 == i0 )
+                    continue;
+
+                pIndices[3*nOut]   = i0;
+                pIndices[3*nOut+1] = i1;
+                pIndices[3*nOut+2] = i2;
+                pSources[nOut] = pSources[t];
+                nOut++;
+            }
+            m_rMesh.Indices.resize( 3*nOut );
+            m_rMesh.Sources.resize( nOut );
+        }
+
+
+        //=====================================================================================================================
+        /// Copies the input into working form, and normalizes the positions.
+        ///
+        ///  Vertices which match in every attribute are merged, and the index buffer refers to the first of them.
+        ///   Vertices which share a position but differ in some attribute are kept apart, and flagged as seams.
+        ///   'pColors' may be NULL.  It holds packed vertex colors, which must also match
+        //=====================================================================================================================
+        void LoadMeshData( SimplifyMeshData& mesh, ThreadPool* pPool,
+                           const uint32* pIndices, uint32 nTriangles,
+                           const void* pVertices, uint32 nVertices, const WeldFormat& format, const uint32* pColors )
+        {
+            mesh.Sources.resize( nTriangles );
+            for( uint32 t=0; t<nTriangles; t++ )
+                mesh.Sources[t] = t;
+
+            // wedges group the vertices by position alone
+            WeldFormat positionFormat( format.nStride, format.nPositionOffset );
+            positionFormat.fPositionTolerance = format.fPositionTolerance;
+            mesh.Wedges.resize( nVertices );
+            if( pPool )
+                WeldVertices( *pPool, mesh.Wedges.data(), 0, pVertices, nVertices, positionFormat );
+            else
+                WeldVertices( mesh.Wedges.data(), 0, pVertices, nVertices, positionFormat );
+
+            std::vector<uint32> groups( mesh.Wedges );
+            if( format.nNormalOffset != WeldFormat::NO_ATTRIBUTE || format.nUVOffset != WeldFormat::NO_ATTRIBUTE )
+            {
+                if( pPool )
+                    WeldVertices( *pPool, groups.data(), 0, pVertices, nVertices, format );
+                else
+                    WeldVertices( groups.data(), 0, pVertices, nVertices, format );
+            }
+
+            // find the first vertex of each group of identical ones
+            std::vector<uint32> firsts( nVertices, NO_VERTEX );
+            if( !pColors )
+            {
+                for( uint32 v=0; v<nVertices; v++ )
+                {
+                    if( firsts[ groups[v] ] == NO_VERTEX )
+                        firsts[ groups[v] ] = v;
+                    groups[v] = firsts[ groups[v] ];
+                }
+            }
+            else
+            {
+                // colors don't fit in a WeldFormat.  Split the groups by color instead
+                std::vector<uint64> keys( nVertices );
+                for( uint32 v=0; v<nVertices; v++ )
+                {
+                    keys[v] = ((uint64)groups[v] << 32) | pColors[v];
+                    firsts[v] = v;
+                }
+                std::sort( firsts.begin(), firsts.end(),
+                    [&]( uint32 a, uint32 b ) { return keys[a] < keys[b] || (keys[a] == keys[b] && a < b); } );
+
+                for( uint32 i=0; i<nVertices; i++ )
+                {
+                    uint32 v = firsts[i];
+                    groups[v] = (i > 0 && keys[ firsts[i-1] ] == keys[v]) ? groups[ firsts[i-1] ] : v;
+                }
+            }
+
+            mesh.Indices.resize( 3*(size_t)nTriangles );
+            for( size_t i=0; i<mesh.Indices.size(); i++ )
+                mesh.Indices[i] = groups[ pIndices[i] ];
+
+            // a seam is a position with more than one distinct vertex in use
+            std::vector<uint32> wedgeSizes( nVertices, 0 );
+            std::vector<uint8> used( nVertices, 0 );
+            for( size_t i=0; i<mesh.Indices.size(); i++ )
+                used[ mesh.Indices[i] ] = 1;
+            for( uint32 v=0; v<nVertices; v++ )
+                wedgeSizes[ mesh.Wedges[v] ] += used[v];
+
+            mesh.Flags.resize( nVertices );
+            for( uint32 v=0; v<nVertices; v++ )
+                mesh.Flags[v] = (wedgeSizes[ mesh.Wedges[v] ] > 1) ? VERTEX_SEAM : 0;
+
+            Vec3f vMin(  FLT_MAX,  FLT_MAX,  FLT_MAX );
+            Vec3f vMax( -FLT_MAX, -FLT_MAX, -FLT_MAX );
+            mesh.Positions.resize( nVertices );
+            for( uint32 v=0; v<nVertices; v++ )
+            {
+                const float* p = (const float*)( ((const uint8*)pVertices) + format.nPositionOffset + format.nStride*v );
+                mesh.Positions[v] = Vec3f( p[0], p[1], p[2] );
+                vMin = Min3( vMin, mesh.Positions[v] );
+                vMax = Max3( vMax, mesh.Positions[v] );
+            }
+
+            Vec3f vSize = vMax - vMin;
+            float fExtent = std::max( vSize.x, std::max( vSize.y, vSize.z ) );
+            float fScale = (fExtent > 0.0f) ? 1.0f / fExtent : 1.0f;
+            for( uint32 v=0; v<nVertices; v++ )
+                mesh.Positions[v] = (mesh.Positions[v] - vMin) * fScale;
+
+            mesh.Quadrics.clear();
+        }
+
+        //=====================================================================================================================
+        //=====================================================================================================================
+        uint32 StoreMeshData( const SimplifyMeshData& mesh, uint32* pIndicesOut, uint32* pSourceTriangles )
+        {
+            uint32 nTriangles = (uint32)( mesh.Sources.size() );
+            if( nTriangles )
+            {
+                memcpy( pIndicesOut, mesh.Indices.data(), 3*nTriangles*sizeof(uint32) );
+                if( pSourceTriangles )
+                    memcpy( pSourceTriangles, mesh.Sources.data(), nTriangles*sizeof(uint32) );
+            }
+            return nTriangles;
+        }
+
+        inline float GetMaxErrorSq( float fTargetError )
+        {
+            return (fTargetError < sqrtf(FLT_MAX)) ? fTargetError*fTargetError : FLT_MAX;
+        }
+
+        /// Output of one cluster.  Vertex numbers are those of the whole mesh
+        struct ClusterResult
+        {
+            std::vector<uint32>  Indices;
+            std::vector<uint32>  Sources;
+            std::vector<uint32>  Vertices;  ///< Every vertex the cluster uses, in order
+            std::vector<Quadric> Quadrics;  ///< Quadrics of 'Vertices' after simplification
+        };
+
+        //=====================================================================================================================
+        /// Simplifies one cluster, with its boundary locked
+        //=====================================================================================================================
+        void SimplifyCluster( ClusterResult& result, const SimplifyMeshData& mesh, const uint32* pClusterTris, uint32 nClusterTris,
+                              const std::vector<uint8>& boundary, uint32 nTargetTriangles, float fMaxErrorSq, float& fErrorSq )
+        {
+            // gather the cluster's vertices, in order
+            std::vector<uint32>& vertices = result.Vertices;
+            vertices.reserve( 3*nClusterTris );
+            for( uint32 i=0; i<nClusterTris; i++ )
+            {
+                const uint32* pTri = mesh.Indices.data() + 3*pClusterTris[i];
+                vertices.push_back( pTri[0] );
+                vertices.push_back( pTri[1] );
+                vertices.push_back( pTri[2] );
+            }
+            std::sort( vertices.begin(), vertices.end() );
+            vertices.erase( std::unique( vertices.begin(), vertices.end() ), vertices.end() );
+
+            // boundary vertices start out with empty quadrics.  They only collect the error of the vertices which
+            //  collapse onto them, which is added to the whole mesh's quadrics afterwards
+            Quadric zero;
+            memset( &zero, 0, sizeof(zero) );
+
+            SimplifyMeshData local;
+            local.Positions.resize( vertices.size() );
+            local.Wedges.resize( vertices.size() );
+            local.Flags.resize( vertices.size() );
+            local.Quadrics.resize( vertices.size() );
+            for( size_t i=0; i<vertices.size(); i++ )
+            {
+                uint32 v = vertices[i];
+                local.Positions[i] = mesh.Positions[v];
+                local.Flags[i]     = mesh.Flags[v] | (boundary[v] ? VERTEX_LOCKED : 0);
+                local.Quadrics[i]  = boundary[v] ? zero : mesh.Quadrics[v];
+            }
+
+            // renumber the wedges, so that they are less than the cluster's vertex count
+            {
+                std::vector<uint64> keys( vertices.size() );
+                for( size_t i=0; i<vertices.size(); i++ )
+                    keys[i] = ((uint64)mesh.Wedges[ vertices[i] ] << 32) | i;
+                std::sort( keys.begin(), keys.end() );
+
+                uint32 nWedge = 0;
+                for( size_t i=0; i<keys.size(); i++ )
+                {
+                    if( i > 0 && (keys[i] >> 32) != (keys[i-1] >> 32) )
+                        nWedge++;
+                    local.Wedges[ (uint32) keys[i] ] = nWedge;
+                }
+            }
+
+            local.Indices.resize( 3*(size_t)nClusterTris );
+            local.Sources.resize( nClusterTris );
+            for( uint32 i=0; i<nClusterTris; i++ )
+            {
+                uint32 t = pClusterTris[i];
+                for( int k=0; k<3; k++ )
+                {
+                    uint32 v = mesh.Indices[3*t+k];
+                    local.Indices[3*i+k] = (uint32)( std::lower_bound( vertices.begin(), vertices.end(), v ) - vertices.begin() );
+                }
+                local.Sources[i] = mesh.Sources[t];
+            }
+
+            Simplifier simplifier( local );
+            fErrorSq = simplifier.Run( nTargetTriangles, fMaxErrorSq );
+
+            result.Indices.resize( local.Indices.size() );
+            for( size_t i=0; i<local.Indices.size(); i++ )
+                result.Indices[i] = vertices[ local.Indices[i] ];
+            result.Sources.swap( local.Sources );
+            result.Quadrics.swap( local.Quadrics );
+        }
+
+        //=====================================================================================================================
+        /// Simplifies spatial clusters in parallel, then the whole mesh.  Returns the largest squared error
+        //=====================================================================================================================
+        float SimplifyClusters( ThreadPool& pool, SimplifyMeshData& mesh, uint32 nTargetTriangles, float fMaxErrorSq )
+        {
+            // quadrics come from the whole mesh, so that they are the same as the serial version's, and
+            //  the clusters and the final pass all measure error against the original surface
+            {
+                Simplifier simplifier( mesh );
+                simplifier.Prepare();
+            }
+
+            uint32 nTriangles = (uint32) mesh.Sources.size();
+            uint32 nVertices  = (uint32) mesh.Positions.size();
+
+            // bin triangles into a grid of clusters by centroid.  Positions are normalized, so the grid covers [0,1]
+            uint32 nGrid = 1;
+            while( nGrid*nGrid*nGrid*CLUSTER_TRIANGLES < nTriangles )
+                nGrid++;
+            uint32 nClusters = nGrid*nGrid*nGrid;
+
+            std::vector<uint32> triClusters( nTriangles );
+            std::vector<uint32> clusterStarts( nClusters+1, 0 );
+            for( uint32 t=0; t<nTriangles; t++ )
+            {
+                const uint32* pTri = mesh.Indices.data() + 3*t;
+                Vec3f C = ( mesh.Positions[pTri[0]] + mesh.Positions[pTri[1]] + mesh.Positions[pTri[2]] ) * (nGrid/3.0f);
+                uint32 x = std::min( (uint32) std::max( C.x, 0.0f ), nGrid-1 );
+                uint32 y = std::min( (uint32) std::max( C.y, 0.0f ), nGrid-1 );
+                uint32 z = std::min( (uint32) std::max( C.z, 0.0f ), nGrid-1 );
+                triClusters[t] = x + nGrid*( y + nGrid*z );
+                clusterStarts[ triClusters[t]+1 ]++;
+            }
+            for( uint32 c=0; c<nClusters; c++ )
+                clusterStarts[c+1] += clusterStarts[c];
+
+            std::vector<uint32> clusterTris( nTriangles );
+            {
+                std::vector<uint32> cursors( clusterStarts.begin(), clusterStarts.end()-1 );
+                for( uint32 t=0; t<nTriangles; t++ )
+                    clusterTris[ cursors[ triClusters[t] ]++ ] = t;
+            }
+
+            // positions used by more than one cluster are locked while the clusters are simplified.  This goes by wedge,
+            //  so that the two sides of a seam are either in the same cluster, or both locked
+            std::vector<uint8> boundary( nVertices, 0 );
+            {
+                std::vector<uint32> owners( nVertices, NO_VERTEX );
+                std::vector<uint8> boundaryWedges( nVertices, 0 );
+                for( uint32 t=0; t<nTriangles; t++ )
+                {
+                    for( int k=0; k<3; k++ )
+                    {
+                        uint32 nWedge = mesh.Wedges[ mesh.Indices[3*t+k] ];
+                        if( owners[nWedge] == NO_VERTEX )
+                            owners[nWedge] = triClusters[t];
+                        else if( owners[nWedge] != triClusters[t] )
+                            boundaryWedges[nWedge] = 1;
+                    }
+                }
+                for( uint32 v=0; v<nVertices; v++ )
+                    boundary[v] = boundaryWedges[ mesh.Wedges[v] ];
+            }
+
+            std::vector<ClusterResult> results( nClusters );
+            std::vector<float> errors( nClusters, 0.0f );
+            ParallelFor( pool, 0, nClusters, 1,
+                [&]( size_t c )
+                {
+                    uint32 nClusterTris = clusterStarts[c+1] - clusterStarts[c];
+                    if( !nClusterTris )
+                        return;
+
+                    uint32 nClusterTarget = (uint32)( (double)nTargetTriangles * nClusterTris / nTriangles );
+                    SimplifyCluster( results[c], mesh, clusterTris.data() + clusterStarts[c], nClusterTris,
+                                     boundary, nClusterTarget, fMaxErrorSq, errors[c] );
+                } );
+
+            // stitch the clusters back together.  Vertices inside a cluster take its quadrics, and boundary vertices
+            //  add up the error of everything which collapsed onto them, from every cluster
+            mesh.Indices.clear();
+            mesh.Sources.clear();
+            float fErrorSq = 0.0f;
+            for( uint32 c=0; c<nClusters; c++ )
+            {
+                const ClusterResult& result = results[c];
+                mesh.Indices.insert( mesh.Indices.end(), result.Indices.begin(), result.Indices.end() );
+                mesh.Sources.insert( mesh.Sources.end(), result.Sources.begin(), result.Sources.end() );
+                for( size_t i=0; i<result.Vertices.size(); i++ )
+                {
+                    uint32 v = result.Vertices[i];
+                    if( boundary[v] )
+                        AddQuadric( mesh.Quadrics[v], result.Quadrics[i] );
+                    else
+                        mesh.Quadrics[v] = result.Quadrics[i];
+                }
+                fErrorSq = std::max( fErrorSq, errors[c] );
+            }
+
+            // finish off with a serial pass, which removes the extra detail along the cluster boundaries
+            Simplifier simplifier( mesh );
+            return std::max( fErrorSq, simplifier.Run( nTargetTriangles, fMaxErrorSq ) );
+        }
+
+        //=====================================================================================================================
+        //=====================================================================================================================
+        uint32 SimplifyMeshImpl( ThreadPool* pPool, uint32* pIndicesOut, const uint32* pIndices, uint32 nTriangles,
+                                 const void* pVertices, uint32 nVertices, const WeldFormat& format, const uint32* pColors,
+                                 uint32 nTargetTriangles, float fTargetError, float* pResultError, uint32* pSourceTriangles )
+        {
+            SimplifyMeshData mesh;
+            LoadMeshData( mesh, pPool, pIndices, nTriangles, pVertices, nVertices, format, pColors );
+
+            float fMaxErrorSq = GetMaxErrorSq( fTargetError );
+            float fErrorSq;
+            if( pPool )
+                fErrorSq = SimplifyClusters( *pPool, mesh, nTargetTriangles, fMaxErrorSq );
+            else
+            {
+                Simplifier simplifier( mesh );
+                fErrorSq = simplifier.Run( nTargetTriangles, fMaxErrorSq );
+            }
+
+            if( pResultError )
+                *pResultError = sqrtf( fErrorSq );
+
+            return StoreMeshData( mesh, pIndicesOut, pSourceTriangles );
+        }
+
+        template< class T >
+        void CompactVertexStream( T*& pStream, uint32 nVertices, uint32 nUsed, const uint32* pRemap )
+        {
+            if( !pStream )
+                return;
+
+            T* pNew = new T[nUsed];
+            RemapVertices( pNew, pStream, nVertices, sizeof(T), pRemap );
+            delete[] pStream;
+            pStream = pNew;
+        }
+
+        //=====================================================================================================================
+        //=====================================================================================================================
+        float SimplifyPlyMeshImpl( ThreadPool* pPool, PlyMesh& rMesh, uint32 nTargetTriangles, float fTargetError )
+        {
+            // interleave the positions, normals and UVs, so that a WeldFormat can compare them
+            uint32 nFloats = 3;
+            WeldFormat format( 0 );
+            if( rMesh.pNormals )
+            {
+                format.nNormalOffset = nFloats*sizeof(float);
+                nFloats += 3;
+            }
+            if( rMesh.pUVs )
+            {
+                format.nUVOffset = nFloats*sizeof(float);
+                nFloats += 2;
+            }
+            format.nStride = nFloats*sizeof(float);
+
+            std::vector<float> vertices( nFloats*(size_t)rMesh.nVertices );
+            for( uint32 v=0; v<rMesh.nVertices; v++ )
+            {
+                float* pVertex = vertices.data() + nFloats*(size_t)v;
+                memcpy( pVertex, rMesh.pPositions[v], sizeof(PlyMesh::Float3) );
+                if( rMesh.pNormals )
+                    memcpy( pVertex + format.nNormalOffset/sizeof(float), rMesh.pNormals[v], sizeof(PlyMesh::Float3) );
+                if( rMesh.pUVs )
+                    memcpy( pVertex + format.nUVOffset/sizeof(float), rMesh.pUVs[v], sizeof(PlyMesh::Float2) );
+            }
+
+            std::vector<uint32> colors;
+            if( rMesh.pVertexColors )
+            {
+                colors.resize( rMesh.nVertices );
+                for( uint32 v=0; v<rMesh.nVertices; v++ )
+                {
+                    const PlyMesh::Color& c = rMesh.pVertexColors[v];
+                    colors[v] = c.r | (c.g << 8) | (c.b << 16) | ((uint32)c.a << 24);
+                }
+            }
+
+            std::vector<uint32> sources( rMesh.nTriangles );
+            float fError = 0.0f;
+            uint32 nTriangles = SimplifyMeshImpl( pPool, rMesh.pVertexIndices, rMesh.pVertexIndices, rMesh.nTriangles,
+                                                  vertices.data(), rMesh.nVertices, format, colors.empty() ? 0 : colors.data(),
+                                                  nTargetTriangles, fTargetError, &fError, sources.data() );
+
+            if( rMesh.pFaceColors )
+            {
+                PlyMesh::Color* pColors = new PlyMesh::Color[nTriangles];
+                for( uint32 t=0; t<nTriangles; t++ )
+                    pColors[t] = rMesh.pFaceColors[ sources[t] ];
+                delete[] rMesh.pFaceColors;
+                rMesh.pFaceColors = pColors;
+            }
+            rMesh.nTriangles = nTriangles;
+
+            std::vector<uint32> remap( rMesh.nVertices );
+            uint32 nUsed = BuildVertexFetchRemap( remap.data(), rMesh.pVertexIndices, nTriangles, rMesh.nVertices );
+            RemapIndices( rMesh.pVertexIndices, rMesh.pVertexIndices, 3*(size_t)nTriangles, remap.data() );
+            CompactVertexStream( rMesh.pPositions,    rMesh.nVertices, nUsed, remap.data() );
+            CompactVertexStream( rMesh.pNormals,      rMesh.nVertices, nUsed, remap.data() );
+            CompactVertexStream( rMesh.pUVs,          rMesh.nVertices, nUsed, remap.data() );
+            CompactVertexStream( rMesh.pVertexColors, rMesh.nVertices, nUsed, remap.data() );
+            rMesh.nVertices = nUsed;
+            return fError;
+        }
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    uint32 SimplifyMesh( uint32* pIndicesOut, const uint32* pIndices, uint32 nTriangles,
+                         const float* pPositions, size_t nPositionStride, uint32 nVertices,
+                         uint32 nTargetTriangles, float fTargetError,
+                         float* pResultError, uint32* pSourceTriangles )
+    {
+        return SimplifyMeshImpl( 0, pIndicesOut, pIndices, nTriangles, pPositions, nVertices, WeldFormat( nPositionStride ), 0,
+                                 nTargetTriangles, fTargetError, pResultError, pSourceTriangles );
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    uint32 SimplifyMesh( ThreadPool& pool,
+                         uint32* pIndicesOut, const uint32* pIndices, uint32 nTriangles,
+                         const float* pPositions, size_t nPositionStride, uint32 nVertices,
+                         uint32 nTargetTriangles, float fTargetError,
+                         float* pResultError, uint32* pSourceTriangles )
+    {
+        return SimplifyMeshImpl( &pool, pIndicesOut, pIndices, nTriangles, pPositions, nVertices, WeldFormat( nPositionStride ), 0,
+                                 nTargetTriangles, fTargetError, pResultError, pSourceTriangles );
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    uint32 SimplifyMesh( uint32* pIndicesOut, const uint32* pIndices, uint32 nTriangles,
+                         const void* pVertices, uint32 nVertices, const WeldFormat& format,
+                         uint32 nTargetTriangles, float fTargetError,
+                         float* pResultError, uint32* pSourceTriangles )
+    {
+        return SimplifyMeshImpl( 0, pIndicesOut, pIndices, nTriangles, pVertices, nVertices, format, 0,
+                                 nTargetTriangles, fTargetError, pResultError, pSourceTriangles );
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    uint32 SimplifyMesh( ThreadPool& pool,
+                         uint32* pIndicesOut, const uint32* pIndices, uint32 nTriangles,
+                         const void* pVertices, uint32 nVertices, const WeldFormat& format,
+                         uint32 nTargetTriangles, float fTargetError,
+                         float* pResultError, uint32* pSourceTriangles )
+    {
+        return SimplifyMeshImpl( &pool, pIndicesOut, pIndices, nTriangles, pVertices, nVertices, format, 0,
+                                 nTargetTriangles, fTargetError, pResultError, pSourceTriangles );
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    float SimplifyPlyMesh( PlyMesh& rMesh, uint32 nTargetTriangles, float fTargetError )
+    {
+        return SimplifyPlyMeshImpl( 0, rMesh, nTargetTriangles, fTargetError );
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    float SimplifyPlyMesh( ThreadPool& pool, PlyMesh& rMesh, uint32 nTargetTriangles, float fTargetError )
+    {
+        return SimplifyPlyMeshImpl( &pool, rMesh, nTargetTriangles, fTargetError );
+    }
+}
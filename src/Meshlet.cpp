@@ -0,0 +1,538 @@
+//=====================================================================================================================
+//
+//   Meshlet.cpp
+//
+//   Splits triangle meshes into small clusters, with bounds for coarse culling
+//
+//   The lazy man's utility library
+//   Joshua Barczak
+//   Copyright 2016 Joshua Barczak
+//
+//   LICENSE:  See Doc\License.txt for terms and conditions
+//
+//=====================================================================================================================
+
+#include "Meshlet.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <float.h>
+#include <math.h>
+
+namespace Simpleton
+{
+    namespace
+    {
+        enum
+        {
+            SPAN_TRIANGLES = 32768, ///< Meshlets are built independently in spans of this many Morton-ordered triangles
+            SORT_BLOCK     = 65536, ///< Keys are sorted in blocks of this size, which are then merged
+            NO_TRIANGLE    = 0xffffffff,
+            NO_SLOT        = 0xffffffff,
+        };
+
+        const float MIN_CONE_COSINE = 0.1f;  ///< Meshlets with normals spread wider than this aren't worth culling
+
+        /// Spreads the low 10 bits of 'n' out to every third bit
+        inline uint32 Part1By2( uint32 n )
+        {
+            n &= 0x000003ff;
+            n = (n ^ (n << 16)) & 0xff0000ff;
+            n = (n ^ (n <<  8)) & 0x0300f00f;
+            n = (n ^ (n <<  4)) & 0x030c30c3;
+            n = (n ^ (n <<  2)) & 0x09249249;
+            return n;
+        }
+
+        inline const float* GetPosition( const float* pPositions, size_t nStride, uint32 v )
+        {
+            return (const float*)( ((const uint8*)pPositions) + nStride*v );
+        }
+
+        //=====================================================================================================================
+        /// Computes a sort key for each triangle:  the Morton code of its centroid, then its index
+        //=====================================================================================================================
+        struct MortonKeys
+        {
+            const uint32* pIndices;
+            const float* pPositions;
+            size_t nStride;
+            Vec3f vMin;
+            Vec3f vScale;
+            uint64* pKeys;
+
+            void operator()( size_t t0, size_t t1 ) const
+            {
+                for( size_t t=t0; t<t1; t++ )
+                {
+                    Vec3f C(0.0f);
+                    for( int k=0; k<3; k++ )
+                        C += Vec3f( GetPosition( pPositions, nStride, pIndices[3*t+k] ) );
+
+                    Vec3f Q = (C*(1.0f/3.0f) - vMin) * vScale;
+                    uint32 x = (uint32) Clamp( Q.x, 0.0f, 1023.0f );
+                    uint32 y = (uint32) Clamp( Q.y, 0.0f, 1023.0f );
+                    uint32 z = (uint32) Clamp( Q.z, 0.0f, 1023.0f );
+                    uint32 nMorton = Part1By2(x) | (Part1By2(y) << 1) | (Part1By2(z) << 2);
+                    pKeys[t] = (((uint64)nMorton) << 32) | t;
+                }
+            }
+        };
+
+        //=====================================================================================================================
+        /// Builds the meshlets for one span of triangles
+        //=====================================================================================================================
+        class SpanBuilder
+        {
+        public:
+
+            SpanBuilder( const uint32* pIndices, const float* pPositions, size_t nStride, uint32 nMaxVertices, uint32 nMaxTriangles )
+                : m_pIndices(pIndices), m_pPositions(pPositions), m_nStride(nStride),
+                  m_nMaxVertices(nMaxVertices), m_nMaxTriangles(nMaxTriangles)
+            {
+            }
+
+            void Build( MeshletMesh& rOut, const uint64* pKeys, uint32 nTriangles );
+
+        private:
+
+            uint32 FindNeighbor( uint32& nNewVertices ) const;
+            uint32 CountNewVertices( uint32 t ) const;
+            void AddTriangle( uint32 t );
+            void Flush( MeshletMesh& rOut );
+            void ComputeBounds( Meshlet& m, const MeshletMesh& rOut ) const;
+
+            const uint32* m_pIndices;
+            const float* m_pPositions;
+            size_t m_nStride;
+            uint32 m_nMaxVertices;
+            uint32 m_nMaxTriangles;
+
+            // the span's triangles, in Morton order, and their vertices, renumbered for the span
+            std::vector<uint32> m_Triangles;
+            std::vector<uint32> m_Corners;
+            std::vector<uint32> m_Vertices;     ///< Original index of each span vertex
+            std::vector<uint64> m_CornerKeys;
+
+            // triangles which use each vertex, and have not yet been placed in a meshlet
+            std::vector<uint32> m_Offsets;
+            std::vector<uint32> m_LiveCounts;
+            std::vector<uint32> m_Adjacency;
+            std::vector<uint8>  m_Emitted;
+
+            // the meshlet being built
+            std::vector<uint32> m_Slots;        ///< Each span vertex's position in the meshlet's vertex list, or NO_SLOT
+            std::vector<uint32> m_MeshletVertices;
+            std::vector<uint32> m_MeshletTriangles;
+        };
+
+        //=====================================================================================================================
+        //=====================================================================================================================
+        void SpanBuilder::Build( MeshletMesh& rOut, const uint64* pKeys, uint32 nTriangles )
+        {
+            m_Triangles.resize( nTriangles );
+            for( uint32 i=0; i<nTriangles; i++ )
+                m_Triangles[i] = (uint32) pKeys[i];
+
+            // renumber the span's vertices, so that the per-vertex arrays stay small.  Sorting (vertex,corner) pairs
+            //  groups each vertex's corners together
+            size_t nCorners = 3*(size_t)nTriangles;
+            m_CornerKeys.resize( nCorners );
+            for( uint32 i=0; i<nTriangles; i++ )
+            {
+                for( int k=0; k<3; k++ )
+                    m_CornerKeys[3*i+k] = (((uint64) m_pIndices[ 3*m_Triangles[i] + k ]) << 32) | (3*i+k);
+            }
+            std::sort( m_CornerKeys.begin(), m_CornerKeys.end() );
+
+            m_Corners.resize( nCorners );
+            m_Vertices.clear();
+            for( size_t i=0; i<nCorners; i++ )
+            {
+                uint32 v = (uint32)( m_CornerKeys[i] >> 32 );
+                if( m_Vertices.empty() || m_Vertices.back() != v )
+                    m_Vertices.push_back(v);
+                m_Corners[ (uint32) m_CornerKeys[i] ] = (uint32)( m_Vertices.size()-1 );
+            }
+
+            uint32 nVertices = (uint32) m_Vertices.size();
+            m_Offsets.assign( nVertices+1, 0 );
+            for( size_t c=0; c<m_Corners.size(); c++ )
+                m_Offsets[ m_Corners[c]+1 ]++;
+            for( uint32 v=0; v<nVertices; v++ )
+                m_Offsets[v+1] += m_Offsets[v];
+
+            m_LiveCounts.assign( nVertices, 0 );
+            m_Adjacency.resize( m_Corners.size() );
+            for( size_t c=0; c<m_Corners.size(); c++ )
+            {
+                uint32 v = m_Corners[c];
+                m_Adjacency[ m_Offsets[v] + m_LiveCounts[v]++ ] = (uint32)( c/3 );
+            }
+
+            m_Emitted.assign( nTriangles, 0 );
+            m_Slots.assign( nVertices, NO_SLOT );
+            m_MeshletVertices.clear();
+            m_MeshletTriangles.clear();
+
+            // grow each meshlet through its neighbors.  When it has none, start again from the next triangle along the curve
+            uint32 nCursor = 0;
+            for( uint32 nPlaced=0; nPlaced<nTriangles; nPlaced++ )
+            {
+                uint32 nNewVertices = 0;
+                uint32 t = FindNeighbor( nNewVertices );
+                if( t == NO_TRIANGLE )
+                {
+                    while( m_Emitted[nCursor] )
+                        nCursor++;
+                    t = nCursor;
+                    nNewVertices = CountNewVertices(t);
+                }
+
+                if( m_MeshletTriangles.size() == m_nMaxTriangles ||
+                    m_MeshletVertices.size() + nNewVertices > m_nMaxVertices )
+                    Flush( rOut );
+
+                AddTriangle(t);
+            }
+            Flush( rOut );
+        }
+
+        //=====================================================================================================================
+        /// Finds the unplaced triangle next to the meshlet which adds the fewest vertices to it.  Ties go to the triangle
+        ///  whose vertices have the fewest other unplaced triangles, which finishes off vertices, and keeps meshlets round.
+        ///  Placed triangles are removed from the adjacency, so the search only visits the meshlet's boundary
+        //=====================================================================================================================
+        uint32 SpanBuilder::FindNeighbor( uint32& nNewVertices ) const
+        {
+            uint32 nBest = NO_TRIANGLE;
+            uint32 nBestNew = 4;
+            uint32 nBestLive = 0;
+            for( size_t i=0; i<m_MeshletVertices.size(); i++ )
+            {
+                uint32 v = m_MeshletVertices[i];
+                const uint32* pAdjacent = m_Adjacency.data() + m_Offsets[v];
+                for( uint32 j=0; j<m_LiveCounts[v]; j++ )
+                {
+                    uint32 t = pAdjacent[j];
+                    uint32 nNew = CountNewVertices(t);
+                    if( nNew == 0 )
+                    {
+                        nNewVertices = 0;
+                        return t;
+                    }
+
+                    const uint32* pTri = m_Corners.data() + 3*t;
+                    uint32 nLive = m_LiveCounts[pTri[0]] + m_LiveCounts[pTri[1]] + m_LiveCounts[pTri[2]];
+                    if( nNew < nBestNew || (nNew == nBestNew && (nLive < nBestLive || (nLive == nBestLive && t < nBest))) )
+                    {
+                        nBest = t;
+                        nBestNew = nNew;
+                        nBestLive = nLive;
+                    }
+                }
+            }
+            nNewVertices = nBestNew;
+            return nBest;
+        }
+
+        //=====================================================================================================================
+        //=====================================================================================================================
+        uint32 SpanBuilder::CountNewVertices( uint32 t ) const
+        {
+            const uint32* pTri = m_Corners.data() + 3*t;
+            return (m_Slots[pTri[0]] == NO_SLOT) +
+                   (m_Slots[pTri[1]] == NO_SLOT) +
+                   (m_Slots[pTri[2]] == NO_SLOT);
+        }
+
+        //=====================================================================================================================
+        //=====================================================================================================================
+        void SpanBuilder::AddTriangle( uint32 t )
+        {
+            m_Emitted[t] = 1;
+            m_MeshletTriangles.push_back(t);
+
+            const uint32* pTri = m_Corners.data() + 3*t;
+            for( int k=0; k<3; k++ )
+            {
+                uint32 v = pTri[k];
+                if( m_Slots[v] == NO_SLOT )
+                {
+                    m_Slots[v] = (uint32) m_MeshletVertices.size();
+                    m_MeshletVertices.push_back(v);
+                }
+
+                // remove one entry per corner.  A degenerate triangle which lists a vertex twice is in its list twice
+                uint32* pAdjacent = m_Adjacency.data() + m_Offsets[v];
+                for( uint32 j=0; j<m_LiveCounts[v]; j++ )
+                {
+                    if( pAdjacent[j] == t )
+                    {
+                        pAdjacent[j] = pAdjacent[ --m_LiveCounts[v] ];
+                        break;
+                    }
+                }
+            }
+        }
+
+        //=====================================================================================================================
+        //=====================================================================================================================
+        void SpanBuilder::Flush( MeshletMesh& rOut )
+        {
+            if( m_MeshletTriangles.empty() )
+                return;
+
+            Meshlet m;
+            m.nVertexOffset   = (uint32) rOut.Vertices.size();
+            m.nTriangleOffset = (uint32) rOut.Triangles.size();
+            m.nVertexCount    = (uint32) m_MeshletVertices.size();
+            m.nTriangleCount  = (uint32) m_MeshletTriangles.size();
+
+            for( size_t i=0; i<m_MeshletVertices.size(); i++ )
+                rOut.Vertices.push_back( m_Vertices[ m_MeshletVertices[i] ] );
+
+            for( size_t i=0; i<m_MeshletTriangles.size(); i++ )
+            {
+                const uint32* pTri = m_Corners.data() + 3*m_MeshletTriangles[i];
+                for( int k=0; k<3; k++ )
+                    rOut.Triangles.push_back( (uint8) m_Slots[pTri[k]] );
+            }
+
+            ComputeBounds( m, rOut );
+            rOut.Meshlets.push_back(m);
+
+            for( size_t i=0; i<m_MeshletVertices.size(); i++ )
+                m_Slots[ m_MeshletVertices[i] ] = NO_SLOT;
+            m_MeshletVertices.clear();
+            m_MeshletTriangles.clear();
+        }
+
+        //=====================================================================================================================
+        /// The normal cone follows Zeux's meshoptimizer:  the axis is the normalized mean of the face normals, and the
+        ///  apex is moved back along the axis until it lies behind every triangle's plane
+        //=====================================================================================================================
+        void SpanBuilder::ComputeBounds( Meshlet& m, const MeshletMesh& rOut ) const
+        {
+            const uint32* pVertices = rOut.Vertices.data() + m.nVertexOffset;
+            const uint8* pTriangles = rOut.Triangles.data() + m.nTriangleOffset;
+
+            Vec3f vMin(  FLT_MAX );
+            Vec3f vMax( -FLT_MAX );
+            for( uint32 i=0; i<m.nVertexCount; i++ )
+            {
+                Vec3f P( GetPosition( m_pPositions, m_nStride, pVertices[i] ) );
+                vMin = Min3( vMin, P );
+                vMax = Max3( vMax, P );
+            }
+
+            m.vCenter = (vMin + vMax) * 0.5f;
+            float fRadiusSq = 0.0f;
+            for( uint32 i=0; i<m.nVertexCount; i++ )
+            {
+                Vec3f P( GetPosition( m_pPositions, m_nStride, pVertices[i] ) );
+                fRadiusSq = std::max( fRadiusSq, Length3Sq( P - m.vCenter ) );
+            }
+            m.fRadius = sqrtf( fRadiusSq );
+
+            // until shown otherwise, the meshlet can't be culled
+            m.vConeApex   = m.vCenter;
+            m.vConeAxis   = Vec3f(0.0f);
+            m.fConeCutoff = 1.0f;
+
+            Vec3f Normals[MESHLET_MAX_TRIANGLES];
+            Vec3f Points[MESHLET_MAX_TRIANGLES];
+            uint32 nNormals = 0;
+            Vec3f vSum(0.0f);
+            for( uint32 i=0; i<m.nTriangleCount; i++ )
+            {
+                Vec3f P0( GetPosition( m_pPositions, m_nStride, pVertices[ pTriangles[3*i] ] ) );
+                Vec3f P1( GetPosition( m_pPositions, m_nStride, pVertices[ pTriangles[3*i+1] ] ) );
+                Vec3f P2( GetPosition( m_pPositions, m_nStride, pVertices[ pTriangles[3*i+2] ] ) );
+                Vec3f N = Cross3( P1-P0, P2-P0 );
+                float fLen = Length3(N);
+                if( fLen == 0.0f )
+                    continue;
+
+                Normals[nNormals] = N / fLen;
+                Points[nNormals]  = P0;
+                vSum += Normals[nNormals];
+                nNormals++;
+            }
+
+            float fSumLen = Length3(vSum);
+            if( fSumLen == 0.0f )
+                return;
+
+            Vec3f vAxis = vSum / fSumLen;
+            float fMinDot = 1.0f;
+            for( uint32 i=0; i<nNormals; i++ )
+                fMinDot = std::min( fMinDot, Dot3( vAxis, Normals[i] ) );
+            if( fMinDot <= MIN_CONE_COSINE )
+                return;
+
+            float fMaxT = 0.0f;
+            for( uint32 i=0; i<nNormals; i++ )
+            {
+                float t = Dot3( m.vCenter - Points[i], Normals[i] ) / Dot3( vAxis, Normals[i] );
+                fMaxT = std::max( fMaxT, t );
+            }
+
+            m.vConeApex   = m.vCenter - vAxis*fMaxT;
+            m.vConeAxis   = vAxis;
+            m.fConeCutoff = sqrtf( 1.0f - fMinDot*fMinDot );
+        }
+
+
+        //=====================================================================================================================
+        /// Sorts Morton keys, in parallel if there is a pool
+        //=====================================================================================================================
+        void SortKeys( ThreadPool* pPool, std::vector<uint64>& keys )
+        {
+            if( !pPool || keys.size() <= SORT_BLOCK )
+            {
+                std::sort( keys.begin(), keys.end() );
+                return;
+            }
+
+            // keys are unique, so the result is the same as a serial sort
+            uint64* pKeys = keys.data();
+            size_t nKeys = keys.size();
+            ParallelForChunked( *pPool, 0, nKeys, SORT_BLOCK,
+                [pKeys]( size_t i0, size_t i1 )
+                {
+                    std::sort( pKeys+i0, pKeys+i1 );
+                } );
+
+            std::vector<uint64> scratch( nKeys );
+            uint64* pIn  = pKeys;
+            uint64* pOut = scratch.data();
+            for( size_t nWidth=SORT_BLOCK; nWidth<nKeys; nWidth *= 2 )
+            {
+                size_t nPairs = (nKeys + 2*nWidth - 1) / (2*nWidth);
+                ParallelFor( *pPool, 0, nPairs, 1,
+                    [pIn,pOut,nKeys,nWidth]( size_t i )
+                    {
+                        size_t b = i*2*nWidth;
+                        size_t m = std::min( b+nWidth, nKeys );
+                        size_t e = std::min( b+2*nWidth, nKeys );
+                        std::merge( pIn+b, pIn+m, pIn+m, pIn+e, pOut+b );
+                    } );
+                std::swap( pIn, pOut );
+            }
+
+            if( pIn != pKeys )
+                std::copy( pIn, pIn+nKeys, pKeys );
+        }
+
+        //=====================================================================================================================
+        //=====================================================================================================================
+        void BuildMeshletsImpl( ThreadPool* pPool,
+                                MeshletMesh& rMeshlets, const uint32* pIndices, uint32 nTriangles,
+                                const float* pPositions, size_t nPositionStride, uint32 nVertices,
+                                uint32 nMaxVertices, uint32 nMaxTriangles )
+        {
+            rMeshlets.Meshlets.clear();
+            rMeshlets.Vertices.clear();
+            rMeshlets.Triangles.clear();
+            if( !nTriangles )
+                return;
+
+            nMaxVertices  = Clamp( nMaxVertices, 3u, (uint32) MESHLET_MAX_VERTICES );
+            nMaxTriangles = Clamp( nMaxTriangles, 1u, (uint32) MESHLET_MAX_TRIANGLES );
+
+            Vec3f vMin(  FLT_MAX );
+            Vec3f vMax( -FLT_MAX );
+            for( uint32 v=0; v<nVertices; v++ )
+            {
+                Vec3f P( GetPosition( pPositions, nPositionStride, v ) );
+                vMin = Min3( vMin, P );
+                vMax = Max3( vMax, P );
+            }
+
+            Vec3f vSize = vMax - vMin;
+            float fExtent = std::max( vSize.x, std::max( vSize.y, vSize.z ) );
+
+            std::vector<uint64> keys( nTriangles );
+            MortonKeys fnKeys;
+            fnKeys.pIndices   = pIndices;
+            fnKeys.pPositions = pPositions;
+            fnKeys.nStride    = nPositionStride;
+            fnKeys.vMin       = vMin;
+            fnKeys.vScale     = Vec3f( (fExtent > 0.0f) ? 1023.0f / fExtent : 0.0f );
+            fnKeys.pKeys      = keys.data();
+            if( pPool )
+                ParallelForChunked( *pPool, 0, nTriangles, SORT_BLOCK, fnKeys );
+            else
+                fnKeys( 0, nTriangles );
+
+            SortKeys( pPool, keys );
+
+            // spans are independent.  Concatenating them in order gives the same result however they were scheduled
+            uint32 nSpans = (nTriangles + SPAN_TRIANGLES - 1) / SPAN_TRIANGLES;
+            std::vector<MeshletMesh> spans( nSpans );
+            const uint64* pKeys = keys.data();
+            auto fnSpan = [&]( size_t s )
+            {
+                uint32 nFirst = (uint32)( s*SPAN_TRIANGLES );
+                uint32 nCount = std::min( nTriangles - nFirst, (uint32) SPAN_TRIANGLES );
+                SpanBuilder builder( pIndices, pPositions, nPositionStride, nMaxVertices, nMaxTriangles );
+                builder.Build( spans[s], pKeys + nFirst, nCount );
+            };
+            if( pPool )
+                ParallelFor( *pPool, 0, nSpans, 1, fnSpan );
+            else
+            {
+                for( uint32 s=0; s<nSpans; s++ )
+                    fnSpan(s);
+            }
+
+            size_t nMeshlets = 0;
+            size_t nMeshletVertices = 0;
+            size_t nMeshletTriangles = 0;
+            for( uint32 s=0; s<nSpans; s++ )
+            {
+                nMeshlets         += spans[s].Meshlets.size();
+                nMeshletVertices  += spans[s].Vertices.size();
+                nMeshletTriangles += spans[s].Triangles.size();
+            }
+            rMeshlets.Meshlets.reserve( nMeshlets );
+            rMeshlets.Vertices.reserve( nMeshletVertices );
+            rMeshlets.Triangles.reserve( nMeshletTriangles );
+
+            for( uint32 s=0; s<nSpans; s++ )
+            {
+                uint32 nVertexBase   = (uint32) rMeshlets.Vertices.size();
+                uint32 nTriangleBase = (uint32) rMeshlets.Triangles.size();
+                for( size_t i=0; i<spans[s].Meshlets.size(); i++ )
+                {
+                    Meshlet m = spans[s].Meshlets[i];
+                    m.nVertexOffset   += nVertexBase;
+                    m.nTriangleOffset += nTriangleBase;
+                    rMeshlets.Meshlets.push_back(m);
+                }
+                rMeshlets.Vertices.insert( rMeshlets.Vertices.end(), spans[s].Vertices.begin(), spans[s].Vertices.end() );
+                rMeshlets.Triangles.insert( rMeshlets.Triangles.end(), spans[s].Triangles.begin(), spans[s].Triangles.end() );
+            }
+        }
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void BuildMeshlets( MeshletMesh& rMeshlets, const uint32* pIndices, uint32 nTriangles,
+                        const float* pPositions, size_t nPositionStride, uint32 nVertices,
+                        uint32 nMaxVertices, uint32 nMaxTriangles )
+    {
+        BuildMeshletsImpl( 0, rMeshlets, pIndices, nTriangles, pPositions, nPositionStride, nVertices, nMaxVertices, nMaxTriangles );
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void BuildMeshlets( ThreadPool& pool,
+                        MeshletMesh& rMeshlets, const uint32* pIndices, uint32 nTriangles,
+                        const float* pPositions, size_t nPositionStride, uint32 nVertices,
+                        uint32 nMaxVertices, uint32 nMaxTriangles )
+    {
+        BuildMeshletsImpl( &pool, rMeshlets, pIndices, nTriangles, pPositions, nPositionStride, nVertices, nMaxVertices, nMaxTriangles );
+    }
+}
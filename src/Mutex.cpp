@@ -13,9 +13,12 @@
 //=====================================================================================================================
 
 #include "Mutex.h"
-#include <windows.h>
 #include <assert.h>
 
+#ifdef WIN32
+    #include <windows.h>
+#endif
+
 
 namespace Simpleton
 {
@@ -29,15 +32,23 @@ namespace Simpleton
     //=====================================================================================================================
     Mutex::Mutex(  )
     {
+    #ifdef WIN32
         assert( sizeof(CRITICAL_SECTION) == SIZEOF_CRITICAL_SECTION ); // juuuust in case
         InitializeCriticalSection( (CRITICAL_SECTION*) m_criticalSection );
+    #else
+        pthread_mutex_init( &m_mutex, 0 );
+    #endif
     }
 
     //=====================================================================================================================
     //=====================================================================================================================
     Mutex::~Mutex()
     {
+    #ifdef WIN32
         DeleteCriticalSection( (CRITICAL_SECTION*) m_criticalSection );
+    #else
+        pthread_mutex_destroy( &m_mutex );
+    #endif
     }
 
 
@@ -51,14 +62,22 @@ namespace Simpleton
     //=====================================================================================================================
     void Mutex::Take()
     {
+    #ifdef WIN32
         EnterCriticalSection( (CRITICAL_SECTION*) m_criticalSection );
+    #else
+        pthread_mutex_lock( &m_mutex );
+    #endif
     }
 
     //=====================================================================================================================
     //=====================================================================================================================
     void Mutex::Release()
     {
+    #ifdef WIN32
         LeaveCriticalSection( (CRITICAL_SECTION*) m_criticalSection );
+    #else
+        pthread_mutex_unlock( &m_mutex );
+    #endif
     }
 }
 
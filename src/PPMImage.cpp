@@ -167,18 +167,20 @@ namespace Simpleton
 
     void PPMImage::Pow( float x)
     {
+        // there are only 256 possible inputs, so build a table instead of calling pow three times per pixel
+        unsigned char table[256];
+        for( unsigned int i=0; i<256; i++ )
+        {
+            float p = 255.0f*powf( i/255.0f, x );
+            table[i] = (unsigned char) ( (p < 255.0f) ? p : 255.0f );
+        }
+
         unsigned int  n = m_nWidth*m_nHeight;
         for( unsigned int i=0; i<n; i++ )
         {
-            float r = m_pPixels[i].r/255.0f;
-            float g = m_pPixels[i].g/255.0f;
-            float b = m_pPixels[i].b/255.0f;
-            r = 255.0f*powf( r, x );
-            g = 255.0f*powf( g, x );
-            b = 255.0f*powf( b, x );
-            m_pPixels[i].r = (unsigned char)r;
-            m_pPixels[i].g = (unsigned char)g;
-            m_pPixels[i].b = (unsigned char)b;
+            m_pPixels[i].r = table[m_pPixels[i].r];
+            m_pPixels[i].g = table[m_pPixels[i].g];
+            m_pPixels[i].b = table[m_pPixels[i].b];
         }
     }
     
@@ -272,7 +272,7 @@ static void PostProcessPositions( Simpleton::PlyMesh* pMesh )
 
 namespace Simpleton
 {
-    bool LoadPly( const char* pFileName, PlyMesh& rMesh, unsigned int Flags )
+    static bool LoadPlyImpl( ThreadPool* pPool, const char* pFileName, PlyMesh& rMesh, unsigned int Flags )
     {
         p_ply ply = ply_open(pFileName, NULL);
     
@@ -389,35 +389,31 @@ namespace Simpleton
             // create vertex normals from face normals if not present
             if( (Flags & (PF_REQUIRE_NORMALS)) && !nNormals )
             {
-                auto _ReadPosition = 
-                    [&ctx]( float* pPosition, uint i ) 
-                    { 
-                        for( uint k=0;k<3;k++ )
-                            pPosition[k] = ctx.pMesh->pPositions[i][k];
-                    };
-                auto _ReadNormal = 
-                    [&ctx]( float* pNormal, uint i ) 
-                    { 
-                        for( uint k=0;k<3;k++ )
-                            pNormal[k] = ctx.pMesh->pNormals[i][k];
-                    };
-                auto _WriteNormal = 
-                    [&ctx]( const float* pNormal, uint i ) 
-                    { 
-                        for( uint k=0;k<3;k++ )
-                            ctx.pMesh->pNormals[i][k] = pNormal[k];
-                    };
-
-                ComputeVertexNormals( ctx.pMesh->pVertexIndices, ctx.pMesh->nTriangles, ctx.pMesh->nVertices,
-                                      _ReadPosition,
-                                      _ReadNormal,
-                                      _WriteNormal );
+                PlyMesh* pMesh = ctx.pMesh;
+                if( pPool )
+                    ComputeVertexNormals( *pPool, pMesh->pNormals[0], sizeof(PlyMesh::Float3),
+                                          pMesh->pPositions[0], sizeof(PlyMesh::Float3),
+                                          pMesh->pVertexIndices, pMesh->nTriangles, pMesh->nVertices );
+                else
+                    ComputeVertexNormals( pMesh->pNormals[0], sizeof(PlyMesh::Float3),
+                                          pMesh->pPositions[0], sizeof(PlyMesh::Float3),
+                                          pMesh->pVertexIndices, pMesh->nTriangles, pMesh->nVertices );
             }
         }
   
         return ok;
     }
 
+    bool LoadPly( const char* pFileName, PlyMesh& rMesh, unsigned int Flags )
+    {
+        return LoadPlyImpl( 0, pFileName, rMesh, Flags );
+    }
+
+    bool LoadPly( ThreadPool& pool, const char* pFileName, PlyMesh& rMesh, unsigned int Flags )
+    {
+        return LoadPlyImpl( &pool, pFileName, rMesh, Flags );
+    }
+
 
     bool WritePly( const char* pWhere, PlyMesh& mesh )
     {
@@ -14,92 +14,135 @@
 
 #include "Types.h"
 #include "PoolAllocator.h"
-#include <malloc.h>
 
 namespace Simpleton
 {
-    void* PoolAllocator::GetMore( uint nSize )
+    PoolAllocator::PoolAllocator( size_t nChunkSize, ChunkSource* pSource )
+        : m_pSource( pSource ? pSource : ChunkSource::GetDefault() ), m_pHead(0), m_pSpare(0), m_pDtors(0)
     {
-        // pad allocs 
-        nSize = (nSize + ALIGN-1) & ~(ALIGN-1);
-        
+        size_t nGranularity = m_pSource->GetGranularity();
+        if( nChunkSize < HEADER_SIZE + ALIGN )
+            nChunkSize = HEADER_SIZE + ALIGN;
+        m_nChunkSize = ((nChunkSize + nGranularity-1) / nGranularity) * nGranularity;
+    }
+
+    void* PoolAllocator::GetMore( size_t nSize, size_t nAlign )
+    {
+        // pad allocs
+        if( nAlign < ALIGN )
+            nAlign = ALIGN;
+        nSize = (nSize + ALIGN-1) & ~(size_t)(ALIGN-1);
+
         // frontmost block has enough room?
-        if( !m_pHead || (m_pHead->nOffset + nSize > m_pHead->nCapacity) )
+        if( m_pHead )
         {
-            // no, search for a block that fits and has maximum available space
-            AllocHeader* pBlock = m_pHead;
-            AllocHeader* pPrev = 0;
-            AllocHeader* pBest = 0;
-            AllocHeader* pBestPred=0;
-            while( pBlock )
-            {
-                if( pBlock->nOffset + nSize <= pBlock->nCapacity )
-                {
-                    if( !pBest || ((pBest->nCapacity-pBest->nOffset) < (pBlock->nCapacity-pBlock->nOffset)) )
-                    {
-                        pBest = pBlock;
-                        pBestPred = pPrev;
-                    }
-                }
-            
-                pPrev = pBlock;
-                pBlock = pBlock->pNext;
-            }
+            void* p = TryAlloc( m_pHead, nSize, nAlign );
+            if( p )
+                return p;
+        }
 
-            // found suitable block?
-            if( pBest )
-            {
-                // YES: if chosen block isn't the head, make it the head to try and avoid search next time
-                if( pBestPred )
-                {
-                    pBestPred->pNext = pBest->pNext;
-                    pBest->pNext = m_pHead;
-                    m_pHead = pBest;
-                }
-            }
-            else
+        // no, take the first spare block that fits
+        AllocHeader* pBlock = 0;
+        AllocHeader** ppLink = &m_pSpare;
+        while( *ppLink )
+        {
+            if( TryAlloc( *ppLink, nSize, nAlign ) )
             {
-                // NO: suitable block not found, must allocate...
-
-                // add space for a header, and pad alloc to multiple of pool chunk size              
-                uint nBytesNeeded = HEADER_SIZE + nSize;
-                nBytesNeeded = (nBytesNeeded + CHUNKSIZE-1) & ~(CHUNKSIZE-1);
+                pBlock = *ppLink;
+                *ppLink = pBlock->pNext;
 
-                // allocate and set up new block
-                pBlock = (AllocHeader*) malloc(nBytesNeeded);
-                pBlock->pNext = m_pHead;
-                pBlock->nCapacity = nBytesNeeded;
+                // TryAlloc has already bumped the offset.  Redo it once the block is in place
                 pBlock->nOffset = HEADER_SIZE;
-                m_pHead = pBlock;                
+                break;
             }
+            ppLink = &(*ppLink)->pNext;
         }
-   
-        // alloc to frontmost block
-        uint nOffs = m_pHead->nOffset;
-        m_pHead->nOffset += nSize;
-        return ((char*)m_pHead) + nOffs;                 
+
+        if( !pBlock )
+        {
+            // suitable block not found, must allocate...
+
+            // add space for a header and alignment slop, and pad alloc to multiple of pool chunk size
+            size_t nBytesNeeded = HEADER_SIZE + nSize + nAlign-1;
+            nBytesNeeded = ((nBytesNeeded + m_nChunkSize-1) / m_nChunkSize) * m_nChunkSize;
+
+            pBlock = (AllocHeader*) m_pSource->AllocChunk(nBytesNeeded);
+            if( !pBlock )
+                return 0;
+
+            pBlock->nCapacity = nBytesNeeded;
+            pBlock->nOffset = HEADER_SIZE;
+        }
+
+        // blocks ahead of this one are abandoned until the allocator is rewound past it
+        pBlock->pNext = m_pHead;
+        m_pHead = pBlock;
+        return TryAlloc( pBlock, nSize, nAlign );
     }
 
+    void PoolAllocator::RewindTo( const Marker& marker )
+    {
+        RunDtors( marker.pDtors );
+
+        while( m_pHead != marker.pBlock )
+        {
+            AllocHeader* pBlock = m_pHead;
+            m_pHead = pBlock->pNext;
+            pBlock->nOffset = HEADER_SIZE;
+            pBlock->pNext = m_pSpare;
+            m_pSpare = pBlock;
+        }
+
+        if( m_pHead )
+            m_pHead->nOffset = marker.nOffset;
+    }
 
     void PoolAllocator::FreeAll()
     {
-        AllocHeader* pBlock = m_pHead;
-        while( pBlock )
+        RunDtors(0);
+
+        AllocHeader* pLists[] = { m_pHead, m_pSpare };
+        for( size_t i=0; i<2; i++ )
         {
-            AllocHeader* pPrev = pBlock;
-            pBlock = pBlock->pNext;
-            free(pPrev);
+            AllocHeader* pBlock = pLists[i];
+            while( pBlock )
+            {
+                AllocHeader* pPrev = pBlock;
+                pBlock = pBlock->pNext;
+                m_pSource->FreeChunk( pPrev, pPrev->nCapacity );
+            }
         }
         m_pHead=0;
+        m_pSpare=0;
     }
 
     void PoolAllocator::Recycle()
     {
-        AllocHeader* pBlock = m_pHead;
-        while( pBlock )
+        Marker empty;
+        empty.pBlock = 0;
+        empty.nOffset = 0;
+        empty.pDtors = 0;
+        RewindTo( empty );
+    }
+
+    void PoolAllocator::RunDtors( DtorRecord* pStop )
+    {
+        while( m_pDtors != pStop )
         {
-            pBlock->nOffset = HEADER_SIZE;
-            pBlock = pBlock->pNext;
+            DtorRecord* pRecord = m_pDtors;
+            m_pDtors = pRecord->pNext;
+            pRecord->pfnDestroy( pRecord->pObject );
         }
     }
-}
\ No newline at end of file
+
+    void* PoolAllocator::TryAlloc( AllocHeader* pBlock, size_t nSize, size_t nAlign )
+    {
+        uintptr_t nBase  = (uintptr_t) pBlock;
+        uintptr_t nStart = (nBase + pBlock->nOffset + nAlign-1) & ~(uintptr_t)(nAlign-1);
+        if( (nStart - nBase) + nSize > pBlock->nCapacity )
+            return 0;
+
+        pBlock->nOffset = (nStart - nBase) + nSize;
+        return (void*) nStart;
+    }
+}
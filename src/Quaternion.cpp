@@ -0,0 +1,109 @@
+//=====================================================================================================================
+//
+//   Quaternion.cpp
+//
+//   Implementation of classes: Simpleton::Quatf, Simpleton::DualQuatf
+//
+//   The lazy man's utility library
+//   Joshua Barczak
+//   Copyright 2016 Joshua Barczak
+//
+//   LICENSE:  See Doc\License.txt for terms and conditions
+//
+//=====================================================================================================================
+
+#include "Quaternion.h"
+
+namespace Simpleton
+{
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    Matrix4f Quatf::ToMatrix() const
+    {
+        float xx = x*x, yy = y*y, zz = z*z;
+        float xy = x*y, xz = x*z, yz = y*z;
+        float wx = w*x, wy = w*y, wz = w*z;
+
+        float values[] = { // NOTE: column major!
+            1-2*(yy+zz),   2*(xy+wz),   2*(xz-wy), 0,
+              2*(xy-wz), 1-2*(xx+zz),   2*(yz+wx), 0,
+              2*(xz+wy),   2*(yz-wx), 1-2*(xx+yy), 0,
+                      0,           0,           0, 1
+        };
+        return Matrix4f(values);
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    Quatf Nlerp( const Quatf& a, const Quatf& b, float t )
+    {
+        Quatf b2 = (Dot4(a,b) < 0) ? -b : b;
+        return Normalize( a*(1-t) + b2*t );
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    Quatf Slerp( const Quatf& a, const Quatf& b, float t )
+    {
+        float fCos = Dot4(a,b);
+        Quatf b2 = b;
+        if( fCos < 0 )
+        {
+            fCos = -fCos;
+            b2 = -b;
+        }
+
+        // nearly parallel.  sin(theta) is too small to divide by, but lerp is just as good
+        if( fCos > 0.9995f )
+            return Normalize( a*(1-t) + b2*t );
+
+        float fTheta = acosf( fCos );
+        float fInvSin = 1.0f / sinf( fTheta );
+        float wa = sinf( (1-t)*fTheta ) * fInvSin;
+        float wb = sinf( t*fTheta ) * fInvSin;
+        return a*wa + b2*wb;
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    Matrix4f DualQuatf::ToMatrix() const
+    {
+        Matrix4f m = Real.ToMatrix();
+        Vec3f t = GetTranslation();
+        m.Set( 0,3, t.x );
+        m.Set( 1,3, t.y );
+        m.Set( 2,3, t.z );
+        return m;
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    DualQuatf Normalize( const DualQuatf& dq )
+    {
+        float fInvLen = 1.0f / sqrtf( Dot4( dq.Real, dq.Real ) );
+        return DualQuatf( dq.Real*fInvLen, dq.Dual*fInvLen );
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    DualQuatf Blend( const DualQuatf* pDQs, const float* pWeights, size_t nCount )
+    {
+        if( !nCount )
+            return DualQuatf::Identity();
+
+        // q and -q are the same rotation.  Flip everything into the first one's hemisphere, or the blend takes the long way
+        DualQuatf sum( pDQs[0].Real*pWeights[0], pDQs[0].Dual*pWeights[0] );
+        for( size_t i=1; i<nCount; i++ )
+        {
+            float w = pWeights[i];
+            if( Dot4( pDQs[0].Real, pDQs[i].Real ) < 0 )
+                w = -w;
+
+            sum.Real = sum.Real + pDQs[i].Real*w;
+            sum.Dual = sum.Dual + pDQs[i].Dual*w;
+        }
+
+        return Normalize(sum);
+    }
+}
@@ -0,0 +1,319 @@
+//=====================================================================================================================
+//
+//   Rand.cpp
+//
+//   Miscellaneous generators of randomness
+//
+//   The lazy man's utility library
+//   Joshua Barczak
+//   Copyright 2016 Joshua Barczak
+//
+//   LICENSE:  See Doc\License.txt for terms and conditions
+//
+//=====================================================================================================================
+
+#include "Rand.h"
+#include <atomic>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define SIMPLETON_RAND_SSE2
+    #include <emmintrin.h>
+#endif
+
+namespace Simpleton
+{
+    namespace
+    {
+        // Per-thread state for Rand().  Bare integers, because VC++ cannot put a class with a constructor in TLS.
+        //  An increment of zero is never produced by seeding, so it marks a thread which has not drawn yet
+        THREAD_LOCAL uint64 t_nRandState;
+        THREAD_LOCAL uint64 t_nRandInc;
+
+        std::atomic<uint64> g_nRandThreads(0);
+
+        const uint64 RAND_SEED = 0x853c49e6748fea9bull;
+
+        inline uint32 Rotl32( uint32 x, int k ) { return (x << k) | (x >> (32-k)); }
+
+        /// One step of xoshiro128+, on lane 'l' of an interleaved state
+        inline uint32 Xoshiro128PlusStep( uint32 s[4][4], size_t l )
+        {
+            uint32 nResult = s[0][l] + s[3][l];
+            uint32 t = s[1][l] << 9;
+            s[2][l] ^= s[0][l];
+            s[3][l] ^= s[1][l];
+            s[1][l] ^= s[2][l];
+            s[0][l] ^= s[3][l];
+            s[2][l] ^= t;
+            s[3][l] = Rotl32( s[3][l], 11 );
+            return nResult;
+        }
+
+    #ifdef SIMPLETON_RAND_SSE2
+
+        /// Runs all four lanes 'nGroups' times, handing each group of outputs to 'out'
+        template< class Out_T >
+        inline void Xoshiro128PlusX4Run( uint32 s[4][4], size_t nGroups, const Out_T& out )
+        {
+            __m128i s0 = _mm_loadu_si128( (const __m128i*) s[0] );
+            __m128i s1 = _mm_loadu_si128( (const __m128i*) s[1] );
+            __m128i s2 = _mm_loadu_si128( (const __m128i*) s[2] );
+            __m128i s3 = _mm_loadu_si128( (const __m128i*) s[3] );
+
+            for( size_t i=0; i<nGroups; i++ )
+            {
+                out( i, _mm_add_epi32( s0, s3 ) );
+
+                __m128i t = _mm_slli_epi32( s1, 9 );
+                s2 = _mm_xor_si128( s2, s0 );
+                s3 = _mm_xor_si128( s3, s1 );
+                s1 = _mm_xor_si128( s1, s2 );
+                s0 = _mm_xor_si128( s0, s3 );
+                s2 = _mm_xor_si128( s2, t );
+                s3 = _mm_or_si128( _mm_slli_epi32( s3, 11 ), _mm_srli_epi32( s3, 21 ) );
+            }
+
+            _mm_storeu_si128( (__m128i*) s[0], s0 );
+            _mm_storeu_si128( (__m128i*) s[1], s1 );
+            _mm_storeu_si128( (__m128i*) s[2], s2 );
+            _mm_storeu_si128( (__m128i*) s[3], s3 );
+        }
+
+    #endif
+    }
+
+    //=====================================================================================================================
+    //
+    //            PCG32
+    //
+    //=====================================================================================================================
+
+    //=====================================================================================================================
+    /// Brown's algorithm for jumping an LCG:  composes the affine step with itself log2(nDelta) times
+    //=====================================================================================================================
+    void PCG32::Advance( uint64 nDelta )
+    {
+        uint64 nCurMult = MULTIPLIER;
+        uint64 nCurPlus = m_nInc;
+        uint64 nAccMult = 1;
+        uint64 nAccPlus = 0;
+        while( nDelta )
+        {
+            if( nDelta & 1 )
+            {
+                nAccMult *= nCurMult;
+                nAccPlus = nAccPlus*nCurMult + nCurPlus;
+            }
+            nCurPlus = (nCurMult+1)*nCurPlus;
+            nCurMult *= nCurMult;
+            nDelta >>= 1;
+        }
+        m_nState = nAccMult*m_nState + nAccPlus;
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void PCG32::FillUInts( uint32* pOut, size_t n )
+    {
+        uint64 nState = m_nState;
+        for( size_t i=0; i<n; i++ )
+            pOut[i] = Step( nState, m_nInc );
+        m_nState = nState;
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void PCG32::FillFloats( float* pOut, size_t n )
+    {
+        uint64 nState = m_nState;
+        for( size_t i=0; i<n; i++ )
+            pOut[i] = _INTERNAL::UIntToUnitFloat( Step( nState, m_nInc ) );
+        m_nState = nState;
+    }
+
+    //=====================================================================================================================
+    //
+    //            Xoshiro256Plus
+    //
+    //=====================================================================================================================
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void Xoshiro256Plus::Jump()
+    {
+        static const uint64 JUMP[] = {
+            0x180ec6d33cfd0abaull, 0xd5a61266f0c9392cull, 0xa9582618e03fc9aaull, 0x39abdc4529b1661cull
+        };
+        Jump(JUMP);
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void Xoshiro256Plus::LongJump()
+    {
+        static const uint64 LONG_JUMP[] = {
+            0x76e15d3efefdcbbfull, 0xc5004e441c522fb3ull, 0x77710069854ee241ull, 0x39109bb02acbe635ull
+        };
+        Jump(LONG_JUMP);
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void Xoshiro256Plus::FillUInts( uint32* pOut, size_t n )
+    {
+        for( size_t i=0; i<n; i++ )
+            pOut[i] = NextUInt();
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void Xoshiro256Plus::FillFloats( float* pOut, size_t n )
+    {
+        for( size_t i=0; i<n; i++ )
+            pOut[i] = NextFloat();
+    }
+
+    //=====================================================================================================================
+    /// Multiplies the state by a precomputed characteristic polynomial
+    //=====================================================================================================================
+    void Xoshiro256Plus::Jump( const uint64 pPoly[4] )
+    {
+        uint64 s[4] = {0,0,0,0};
+        for( size_t i=0; i<4; i++ )
+        {
+            for( size_t b=0; b<64; b++ )
+            {
+                if( pPoly[i] & (1ull << b) )
+                {
+                    for( size_t j=0; j<4; j++ )
+                        s[j] ^= m_s[j];
+                }
+                Next();
+            }
+        }
+        memcpy( m_s, s, sizeof(s) );
+    }
+
+    //=====================================================================================================================
+    //
+    //            Xoshiro128PlusX4
+    //
+    //=====================================================================================================================
+
+    //=====================================================================================================================
+    /// Lane 0 is seeded from SplitMix64.  Each other lane is the previous one, jumped ahead by 2^64
+    //=====================================================================================================================
+    void Xoshiro128PlusX4::Seed( uint64 nSeed )
+    {
+        static const uint32 JUMP[] = { 0x8764000b, 0xf542d2d3, 0x6fa035c3, 0x77f2db5b };
+
+        SplitMix64 sm(nSeed);
+        uint64 a = sm.Next();
+        uint64 b = sm.Next();
+        m_s[0][0] = (uint32) a;
+        m_s[1][0] = (uint32) (a >> 32);
+        m_s[2][0] = (uint32) b;
+        m_s[3][0] = (uint32) (b >> 32);
+
+        for( size_t l=1; l<4; l++ )
+        {
+            uint32 s[4] = {0,0,0,0};
+            for( size_t w=0; w<4; w++ )
+                m_s[w][l] = m_s[w][l-1];
+
+            for( size_t i=0; i<4; i++ )
+            {
+                for( size_t bit=0; bit<32; bit++ )
+                {
+                    if( JUMP[i] & (1u << bit) )
+                    {
+                        for( size_t w=0; w<4; w++ )
+                            s[w] ^= m_s[w][l];
+                    }
+                    Xoshiro128PlusStep( m_s, l );
+                }
+            }
+
+            for( size_t w=0; w<4; w++ )
+                m_s[w][l] = s[w];
+        }
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void Xoshiro128PlusX4::FillUInts( uint32* pOut, size_t n )
+    {
+        size_t nGroups = n/4;
+    #ifdef SIMPLETON_RAND_SSE2
+        Xoshiro128PlusX4Run( m_s, nGroups, [pOut]( size_t i, __m128i r ) {
+            _mm_storeu_si128( (__m128i*)(pOut + 4*i), r );
+        });
+    #else
+        for( size_t i=0; i<nGroups; i++ )
+            for( size_t l=0; l<4; l++ )
+                pOut[4*i+l] = Xoshiro128PlusStep( m_s, l );
+    #endif
+
+        size_t nLeft = n - 4*nGroups;
+        if( nLeft )
+        {
+            uint32 tmp[4];
+            for( size_t l=0; l<4; l++ )
+                tmp[l] = Xoshiro128PlusStep( m_s, l );
+            memcpy( pOut + 4*nGroups, tmp, nLeft*sizeof(uint32) );
+        }
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void Xoshiro128PlusX4::FillFloats( float* pOut, size_t n )
+    {
+        size_t nGroups = n/4;
+    #ifdef SIMPLETON_RAND_SSE2
+        const __m128 SCALE = _mm_set1_ps( 1.0f/16777216.0f );
+        Xoshiro128PlusX4Run( m_s, nGroups, [pOut,SCALE]( size_t i, __m128i r ) {
+            // shifted down to 24 bits, so the signed conversion is exact
+            __m128 f = _mm_cvtepi32_ps( _mm_srli_epi32( r, 8 ) );
+            _mm_storeu_ps( pOut + 4*i, _mm_mul_ps( f, SCALE ) );
+        });
+    #else
+        for( size_t i=0; i<nGroups; i++ )
+            for( size_t l=0; l<4; l++ )
+                pOut[4*i+l] = _INTERNAL::UIntToUnitFloat( Xoshiro128PlusStep( m_s, l ) );
+    #endif
+
+        size_t nLeft = n - 4*nGroups;
+        if( nLeft )
+        {
+            float tmp[4];
+            for( size_t l=0; l<4; l++ )
+                tmp[l] = _INTERNAL::UIntToUnitFloat( Xoshiro128PlusStep( m_s, l ) );
+            memcpy( pOut + 4*nGroups, tmp, nLeft*sizeof(float) );
+        }
+    }
+
+    //=====================================================================================================================
+    //
+    //            Rand
+    //
+    //=====================================================================================================================
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    float Rand()
+    {
+        // first draw on this thread.  Give it its own stream
+        if( !t_nRandInc )
+            PCG32::Seed( t_nRandState, t_nRandInc, RAND_SEED, g_nRandThreads.fetch_add(1) );
+
+        return _INTERNAL::UIntToUnitFloat( PCG32::Step( t_nRandState, t_nRandInc ) );
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void SeedRand( uint64 nSeed )
+    {
+        PCG32::Seed( t_nRandState, t_nRandInc, nSeed, 0 );
+    }
+}
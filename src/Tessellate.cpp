@@ -282,12 +282,12 @@ namespace Simpleton
 
     void AffineTransformMesh( std::vector<TessVertex>& verts, const Simpleton::Matrix4f& M, const Simpleton::Matrix4f& MInv )
     {
-        for( uint i=0; i<verts.size(); i++ )
-        {
-            verts[i].vPos = AffineTransformPoint(M,verts[i].vPos);
-            verts[i].vNormal = AffineTransformNormal(MInv,verts[i].vNormal);
-            verts[i].vNormal = Normalize3(verts[i].vNormal);
-        }
+        if( verts.empty() )
+            return;
+
+        TessVertex* pVerts = &verts[0];
+        AffineTransformPoints( M, &pVerts->vPos, sizeof(TessVertex), &pVerts->vPos, sizeof(TessVertex), verts.size() );
+        AffineTransformNormals( MInv, &pVerts->vNormal, sizeof(TessVertex), &pVerts->vNormal, sizeof(TessVertex), verts.size(), true );
     }
 
     void GenerateCatmullRohmTangents( Vec2f* pTangents, const Vec2f* pCVs,  uint nCVs )
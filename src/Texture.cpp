@@ -17,6 +17,8 @@
 #include "MiscMath.h"
 #include "Types.h"
 #include "Rand.h"
+#include "FastMath.h"
+#include "Parallel.h"
 #include <math.h>
 
 namespace Simpleton
@@ -62,6 +64,20 @@ namespace Simpleton
         return nTexels;
     }
 
+    /// 2x2 box filter of two RGBA rows into one row of the next mip.  'nWidth' is the width of the output row
+    static void DownsampleRow_RGBA( uint8* pOut, const uint8* pL0, const uint8* pL1, uint nWidth )
+    {
+        for( uint x=0; x<nWidth; x++ )
+        {
+            for( uint c=0; c<4; c++ )
+            {
+                uint v = pL0[8*x+c] + pL0[8*x+c+4] +
+                         pL1[8*x+c] + pL1[8*x+c+4];
+                *(pOut++) = v>>2;
+            }
+        }
+    }
+
     /// Given a single RGB image, expand top level to RGBA and generate a mip chain
     void GenerateMips_RGB_To_RGBA( void* pOut, const void* pIn, uint nTopWidth, uint nTopHeight, uint nMipsToGenerate )
     {
@@ -90,18 +106,8 @@ namespace Simpleton
             uint nCurrentHeight = MAX(1,nTopHeight>>1);
             for( uint y=0; y<nCurrentHeight; y++ )
             {
-                const uint8* pL0 = pTopMip;
-                const uint8* pL1 = pTopMip+8*nCurrentWidth;
-                for( uint x=0; x<nCurrentWidth; x++ )
-                {
-                    for( uint c=0; c<4; c++ )
-                    {
-                        uint v = pL0[8*x+c] + pL0[8*x+c+4] +
-                                 pL1[8*x+c] + pL1[8*x+c+4];
-                        *(pCurrentMip++) = v>>2;
-                    }
-                }
-                
+                DownsampleRow_RGBA( pCurrentMip, pTopMip, pTopMip+8*nCurrentWidth, nCurrentWidth );
+                pCurrentMip += 4*nCurrentWidth;
                 pTopMip += 16*nCurrentWidth;
             }
             nTopWidth = nCurrentWidth;
@@ -123,20 +129,42 @@ namespace Simpleton
             uint nCurrentHeight = MAX(1,nTopHeight>>1);
             for( uint y=0; y<nCurrentHeight; y++ )
             {
-                const uint8* pL0 = pTopMip;
-                const uint8* pL1 = pTopMip+8*nCurrentWidth;
-                for( uint x=0; x<nCurrentWidth; x++ )
+                DownsampleRow_RGBA( pCurrentMip, pTopMip, pTopMip+8*nCurrentWidth, nCurrentWidth );
+                pCurrentMip += 4*nCurrentWidth;
+                pTopMip += 16*nCurrentWidth;
+            }
+            nTopWidth = nCurrentWidth;
+            nTopHeight = nCurrentHeight;
+        }
+    }
+
+    void GenerateMips_RGBA_InPlace( ThreadPool& pool, void* pInOut, uint nTopWidth, uint nTopHeight, uint nMipsToGenerate )
+    {
+        if( !nMipsToGenerate )
+            nMipsToGenerate = CountTextureMips(nTopWidth,nTopHeight,1);
+        
+        uint8* pCurrentMip = ((uint8*)pInOut) + 4*nTopWidth*nTopHeight;
+        const uint8* pTopMip = (const uint8*)pInOut;
+        for( uint m=1; m<nMipsToGenerate; m++ )
+        {
+            uint nCurrentWidth  = MAX(1,nTopWidth>>1);
+            uint nCurrentHeight = MAX(1,nTopHeight>>1);
+
+            // each mip depends on the one above it, so we parallelize within a level only
+            //  aim for ~16K pixels per chunk so that the small mips don't bother to go wide
+            size_t nRowsPerChunk = MAX( 1, (16*1024) / nCurrentWidth );
+            ParallelForChunked( pool, 0, nCurrentHeight, nRowsPerChunk,
+                [=]( size_t y0, size_t y1 )
                 {
-                    for( uint c=0; c<4; c++ )
+                    for( size_t y=y0; y<y1; y++ )
                     {
-                        uint v = pL0[8*x+c] + pL0[8*x+c+4] +
-                                 pL1[8*x+c] + pL1[8*x+c+4];
-                        *(pCurrentMip++) = v>>2;
+                        const uint8* pL0 = pTopMip + 16*nCurrentWidth*y;
+                        DownsampleRow_RGBA( pCurrentMip + 4*nCurrentWidth*y, pL0, pL0+8*nCurrentWidth, nCurrentWidth );
                     }
-                }
-                
-                pTopMip += 16*nCurrentWidth;
-            }
+                } );
+
+            pTopMip     += 16*nCurrentWidth*nCurrentHeight;
+            pCurrentMip += 4*nCurrentWidth*nCurrentHeight;
             nTopWidth = nCurrentWidth;
             nTopHeight = nCurrentHeight;
         }
@@ -146,13 +174,27 @@ namespace Simpleton
     void CreateRandomRotations( int8* pOut, uint nWidth, uint nHeight )
     {
         uint nPix = nWidth*nHeight;
-        for( uint i=0; i<nPix; i++ )
+        for( uint i=0; i<nPix; i += 8 )
         {
-            float t= Rand(-3.1415926f,3.1415926f);
-            float cosT = cos(t);
-            float sinT = sin(t);
-            pOut[2*i]   = (int8)(cosT*127);
-            pOut[2*i+1] = (int8)(sinT*127);
+            // only draw as many angles as will be stored, so that the random sequence is the same as one at a time
+            uint nLanes = (nPix-i < 8) ? nPix-i : 8;
+            float t[8] = { 0 };
+            for( uint j=0; j<nLanes; j++ )
+                t[j] = Rand(-3.1415926f,3.1415926f);
+
+            float8 sinT, cosT;
+            FastSinCos( float8::Load(t), sinT, cosT );
+
+            float c[8];
+            float s[8];
+            (cosT*float8(127.0f)).Store(c);
+            (sinT*float8(127.0f)).Store(s);
+
+            for( uint j=0; j<nLanes; j++ )
+            {
+                pOut[2*(i+j)]   = (int8)c[j];
+                pOut[2*(i+j)+1] = (int8)s[j];
+            }
         }
     }
 
@@ -13,8 +13,18 @@
 //=====================================================================================================================
 
 #include "Thread.h"
-#include <windows.h>
-#include <process.h>
+#include <string.h>
+
+#ifdef WIN32
+    #include <windows.h>
+    #include <process.h>
+#else
+    #include <pthread.h>
+    #include <unistd.h>
+    #ifdef __linux__
+        #include <sched.h>
+    #endif
+#endif
 
 namespace Simpleton
 {
@@ -22,9 +32,14 @@ namespace Simpleton
     //=====================================================================================================================
     /// Thread procedure for thread classes.  
     //=====================================================================================================================
+#ifdef WIN32
     unsigned int __stdcall SimpletonThreadProc( void* pThreadData )
+#else
+    void* SimpletonThreadProc( void* pThreadData )
+#endif
     {
         Thread* pThread = (Thread*) pThreadData;
+        pThread->ApplyThreadSettings();
         pThread->OnExecuteThread();     // do work
         pThread->m_bDeadFlag = true;    // set 'dead' flag to indicate that work is done
         return 0;
@@ -39,9 +54,9 @@ namespace Simpleton
 
     //=====================================================================================================================
     //=====================================================================================================================
-    Thread::Thread( ) : m_nThreadHandle(0), m_bDeadFlag(false)
+    Thread::Thread( ) : m_bDeadFlag(false), m_bJoined(false), m_nThreadHandle(0), m_nAffinity(-1)
     {
-
+        m_Name[0] = 0;
     }
 
     //=====================================================================================================================
@@ -51,7 +66,14 @@ namespace Simpleton
         // close thread handle upon destruction
         if( m_nThreadHandle )
         {
+        #ifdef WIN32
             CloseHandle( m_nThreadHandle );
+        #else
+            pthread_t* pThread = (pthread_t*) m_nThreadHandle;
+            if( !m_bJoined )
+                pthread_detach( *pThread );
+            delete pThread;
+        #endif
         }
     }
 
@@ -86,7 +108,15 @@ namespace Simpleton
         }
 
         // create thread
+    #ifdef WIN32
         m_nThreadHandle = (void*) _beginthreadex( 0, 0, &SimpletonThreadProc, this, 0, 0 );
+    #else
+        pthread_t* pThread = new pthread_t;
+        if( pthread_create( pThread, 0, &SimpletonThreadProc, this ) != 0 )
+            delete pThread;
+        else
+            m_nThreadHandle = pThread;
+    #endif
 
         if( m_nThreadHandle == 0 )
         {
@@ -124,8 +154,117 @@ namespace Simpleton
             return;
         }
 
+    #ifdef WIN32
         WaitForSingleObject( m_nThreadHandle, INFINITE );
+    #else
+        // pthreads can only be joined once
+        if( !m_bJoined )
+        {
+            pthread_join( *((pthread_t*) m_nThreadHandle), 0 );
+            m_bJoined = true;
+        }
+    #endif
     }
-}
 
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void Thread::SetName( const char* pName )
+    {
+        strncpy( m_Name, pName, MAX_NAME_LENGTH-1 );
+        m_Name[MAX_NAME_LENGTH-1] = 0;
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void Thread::SetAffinity( unsigned int nCore )
+    {
+        m_nAffinity = (int) nCore;
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    unsigned int Thread::GetHardwareThreadCount()
+    {
+    #ifdef WIN32
+        SYSTEM_INFO info;
+        GetSystemInfo( &info );
+        return info.dwNumberOfProcessors;
+    #else
+        long n = sysconf( _SC_NPROCESSORS_ONLN );
+        return (n > 0) ? (unsigned int) n : 1;
+    #endif
+    }
+
+    //=====================================================================================================================
+    //
+    //            Private Methods
+    //
+    //=====================================================================================================================
+
+#ifdef WIN32
+
+    // This is the documented way of naming a thread for the VC++ debugger
+    static const DWORD MS_VC_EXCEPTION = 0x406D1388;
+
+    #pragma pack(push,8)
+    struct THREADNAME_INFO
+    {
+        DWORD dwType;       ///< Must be 0x1000
+        LPCSTR szName;      ///< Pointer to name (in user addr space)
+        DWORD dwThreadID;   ///< Thread ID (-1=caller thread)
+        DWORD dwFlags;      ///< Reserved for future use, must be zero
+    };
+    #pragma pack(pop)
+
+#endif
+
+    //=====================================================================================================================
+    /// Called on the new thread before OnExecuteThread
+    //=====================================================================================================================
+    void Thread::ApplyThreadSettings()
+    {
+    #ifdef WIN32
+        if( m_Name[0] )
+        {
+            THREADNAME_INFO info;
+            info.dwType = 0x1000;
+            info.szName = m_Name;
+            info.dwThreadID = (DWORD)-1;
+            info.dwFlags = 0;
+            __try
+            {
+                RaiseException( MS_VC_EXCEPTION, 0, sizeof(info)/sizeof(ULONG_PTR), (ULONG_PTR*)&info );
+            }
+            __except( EXCEPTION_EXECUTE_HANDLER )
+            {
+            }
+        }
+
+        if( m_nAffinity >= 0 )
+            SetThreadAffinityMask( GetCurrentThread(), ((DWORD_PTR)1) << m_nAffinity );
+
+    #else
+
+        if( m_Name[0] )
+        {
+        #ifdef __APPLE__
+            pthread_setname_np( m_Name );
+        #else
+            pthread_setname_np( pthread_self(), m_Name );
+        #endif
+        }
+
+        #ifdef __linux__
+            if( m_nAffinity >= 0 )
+            {
+                cpu_set_t cpus;
+                CPU_ZERO( &cpus );
+                CPU_SET( m_nAffinity, &cpus );
+                pthread_setaffinity_np( pthread_self(), sizeof(cpus), &cpus );
+            }
+        #endif
+
+    #endif
+    }
+}
 
@@ -0,0 +1,300 @@
+//=====================================================================================================================
+//
+//   ThreadPool.cpp
+//
+//   Implementation of class: Simpleton::ThreadPool
+//
+//   The lazy man's utility library
+//   Joshua Barczak
+//   Copyright 2016 Joshua Barczak
+//
+//   LICENSE:  See Doc\License.txt for terms and conditions
+//
+//=====================================================================================================================
+
+#include "Types.h"
+#include "Thread.h"
+#include "ThreadPool.h"
+#include <thread>
+#include <stdio.h>
+
+namespace Simpleton
+{
+    /// Worker that the current thread belongs to, if any.  Used to route pushes and pops to the thread's own deque
+    static THREAD_LOCAL void* t_pCurrentWorker = 0;
+
+    class ThreadPool::WorkerThread : public Thread
+    {
+    public:
+        WorkerThread( ThreadPool::Worker* pWorker ) : m_pWorker(pWorker) {}
+
+    protected:
+
+        virtual void OnExecuteThread()
+        {
+            t_pCurrentWorker = m_pWorker;
+
+            ThreadPool* pPool = m_pWorker->pPool;
+            uint nIdle = 0;
+            while( !pPool->m_bShutdown.load( std::memory_order_acquire ) )
+            {
+                WorkItem* pWork = pPool->FindWork( m_pWorker );
+                if( pWork )
+                {
+                    pWork->Do();
+                    nIdle = 0;
+                }
+                else if( ++nIdle <= SPIN_COUNT )
+                {
+                    _mm_pause();
+                }
+                else if( nIdle <= SPIN_COUNT+YIELD_COUNT )
+                {
+                    std::this_thread::yield();
+                }
+                else
+                {
+                    // go to sleep, unless something turned up while we were deciding to
+                    uint32 nKey = pPool->m_IdleWorkers.PrepareWait();
+                    if( pPool->m_bShutdown.load( std::memory_order_acquire ) )
+                    {
+                        pPool->m_IdleWorkers.CancelWait();
+                        break;
+                    }
+
+                    pWork = pPool->FindWork( m_pWorker );
+                    if( pWork )
+                    {
+                        pPool->m_IdleWorkers.CancelWait();
+                        pWork->Do();
+                    }
+                    else
+                    {
+                        pPool->m_IdleWorkers.Wait(nKey);
+                    }
+                    nIdle = 0;
+                }
+            }
+
+            t_pCurrentWorker = 0;
+        }
+
+    private:
+        ThreadPool::Worker* m_pWorker;
+    };
+
+
+    //=====================================================================================================================
+    //
+    //         Constructors/Destructors
+    //
+    //=====================================================================================================================
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    ThreadPool::ThreadPool() : m_bShutdown(false), m_nSubmitted(0)
+    {
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    ThreadPool::~ThreadPool()
+    {
+        Shutdown();
+    }
+
+    //=====================================================================================================================
+    //
+    //            Public Methods
+    //
+    //=====================================================================================================================
+
+    //=====================================================================================================================
+    /// Creates the worker threads.  Has no effect if the pool is already running
+    //=====================================================================================================================
+    void ThreadPool::Start( size_t nWorkers, bool bPinToCores )
+    {
+        if( !m_Workers.empty() )
+            return;
+
+        m_bShutdown.store( false );
+
+        // all worker state must exist before any thread starts stealing from it
+        for( size_t i=0; i<nWorkers; i++ )
+        {
+            Worker* pWorker = new Worker;
+            pWorker->pPool = this;
+            pWorker->nIndex = i;
+            pWorker->nRandState = (uint32)(i+1) * 0x9E3779B9;
+            m_Workers.push_back(pWorker);
+        }
+
+        unsigned int nCores = Thread::GetHardwareThreadCount();
+        for( size_t i=0; i<nWorkers; i++ )
+        {
+            char name[32];
+            sprintf( name, "Worker %u", (unsigned int) i );
+
+            Thread* pThread = new WorkerThread( m_Workers[i] );
+            pThread->SetName( name );
+            if( bPinToCores )
+                pThread->SetAffinity( (unsigned int)( i % nCores ) );
+
+            m_WorkerThreads.push_back(pThread);
+            pThread->Start();
+        }
+    }
+
+    //=====================================================================================================================
+    /// Stops and destroys the worker threads.  Any work left in the queues is executed on the calling thread
+    //=====================================================================================================================
+    void ThreadPool::Shutdown()
+    {
+        WaitAll();
+
+        m_bShutdown.store( true, std::memory_order_release );
+        m_IdleWorkers.NotifyAll();
+        for( size_t i=0; i<m_WorkerThreads.size(); i++ )
+        {
+            m_WorkerThreads[i]->WaitForCompletion();
+            delete m_WorkerThreads[i];
+        }
+        m_WorkerThreads.clear();
+
+        // work items which were running when we raised the flag may have spawned more work
+        WaitAll();
+
+        for( size_t i=0; i<m_Workers.size(); i++ )
+            delete m_Workers[i];
+        m_Workers.clear();
+    }
+
+    //=====================================================================================================================
+    /// Workers push onto their own deque without locking.  Other threads go through the submission queue
+    //=====================================================================================================================
+    void ThreadPool::PushWork( WorkItem* pItem )
+    {
+        Worker* pWorker = GetCurrentWorker();
+        if( pWorker )
+        {
+            pWorker->Deque.Push(pItem);
+        }
+        else
+        {
+            m_Lock.Take();
+            m_WorkItems.push_back(pItem);
+            m_nSubmitted.store( m_WorkItems.size(), std::memory_order_release );
+            m_Lock.Release();
+        }
+
+        m_IdleWorkers.NotifyOne();
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    bool ThreadPool::DoWork()
+    {
+        WorkItem* pWork = FindWork( GetCurrentWorker() );
+        if( !pWork )
+            return false;
+
+        pWork->Do();
+        return true;
+    }
+
+
+    //=====================================================================================================================
+    //
+    //            Private Methods
+    //
+    //=====================================================================================================================
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    ThreadPool::Worker* ThreadPool::GetCurrentWorker() const
+    {
+        Worker* pWorker = static_cast<Worker*>( t_pCurrentWorker );
+        if( pWorker && pWorker->pPool == this )
+            return pWorker;
+        return 0;
+    }
+
+    //=====================================================================================================================
+    /// Workers check their own deque first, then the submission queue, then try to steal.
+    //=====================================================================================================================
+    WorkItem* ThreadPool::FindWork( Worker* pWorker )
+    {
+        WorkItem* pWork = 0;
+        if( pWorker )
+            pWork = pWorker->Deque.Pop();
+        if( !pWork )
+            pWork = PopSubmitted();
+        if( !pWork )
+            pWork = Steal( pWorker );
+        return pWork;
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    WorkItem* ThreadPool::PopSubmitted()
+    {
+        if( m_nSubmitted.load( std::memory_order_acquire ) == 0 )
+            return 0;
+
+        m_Lock.Take();
+        if( m_WorkItems.empty() )
+        {
+            m_Lock.Release();
+            return 0;
+        }
+        WorkItem* pWork = m_WorkItems.front();
+        m_WorkItems.pop_front();
+        m_nSubmitted.store( m_WorkItems.size(), std::memory_order_relaxed );
+        m_Lock.Release();
+        return pWork;
+    }
+
+    //=====================================================================================================================
+    /// Visits every other worker once, starting at a random victim.
+    ///   A steal can fail because another thief got there first.  We only give up once every deque looks empty
+    //=====================================================================================================================
+    WorkItem* ThreadPool::Steal( Worker* pThief )
+    {
+        size_t nWorkers = m_Workers.size();
+        if( nWorkers == 0 )
+            return 0;
+
+        size_t nStart = 0;
+        if( pThief )
+        {
+            // xorshift32
+            uint32 x = pThief->nRandState;
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            pThief->nRandState = x;
+            nStart = x % nWorkers;
+        }
+
+        bool bContended;
+        do
+        {
+            bContended = false;
+            for( size_t i=0; i<nWorkers; i++ )
+            {
+                Worker* pVictim = m_Workers[ (nStart+i) % nWorkers ];
+                if( pVictim == pThief )
+                    continue;
+
+                WorkItem* pWork = pVictim->Deque.Steal();
+                if( pWork )
+                    return pWork;
+
+                if( !pVictim->Deque.IsEmpty() )
+                    bContended = true;
+            }
+        } while( bContended );
+
+        return 0;
+    }
+}
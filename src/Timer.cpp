@@ -16,6 +16,7 @@
         
 
 #include "Timer.h"
+#include <stdint.h>
 #ifdef WIN32
 
     // #define this or it breaks
@@ -25,14 +26,9 @@
     #include <windows.h>
 
 #else
-    // on non-windows, time.h should do the job.
+    // on non-windows, the POSIX monotonic clock does the job
     #include <time.h>
 
-    // check in case we port to some platform without enough precision
-    #if (CLOCKS_PER_SEC < 1000000)
-        #error "CLOCKS_PER_SEC is too low for micro-second precision.  Do something about it."
-    #endif
-
 #endif
 
 
@@ -96,32 +92,37 @@ namespace Simpleton
 
     #else
 
-        // UNIX version can use clock() for everything since they have better precision
+        // UNIX version uses the monotonic clock.  clock() would measure CPU time for the whole process,
+        //   which runs fast or slow depending on how many threads are busy
 
         class UnixTimer : public Timer::TimerImpl
         {
-            clock_t m_start;
+            timespec m_start;
+
+            int64_t ElapsedNanoSeconds() const
+            {
+                timespec now;
+                clock_gettime( CLOCK_MONOTONIC, &now );
+                return (int64_t)(now.tv_sec - m_start.tv_sec)*1000000000 + (now.tv_nsec - m_start.tv_nsec);
+            }
+
         public:
 
-            UnixTimer() : m_start(clock()) {};
+            UnixTimer() { clock_gettime( CLOCK_MONOTONIC, &m_start ); };
         
             unsigned int Tick() const
             {
-                clock_t elapsed = clock() - m_start;
-                elapsed /= ((CLOCKS_PER_SEC)/1000);
-                return (int)elapsed;
+                return (unsigned int)( ElapsedNanoSeconds() / 1000000 );
             }
 
             unsigned long TickMicroSeconds() const
             {
-                clock_t elapsed = clock() - m_start;
-                elapsed /= ((CLOCKS_PER_SEC)/1000000);
-                return (int)elapsed;
+                return (unsigned long)( ElapsedNanoSeconds() / 1000 );
             }
 
             void Reset()
             {
-                m_start = clock();
+                clock_gettime( CLOCK_MONOTONIC, &m_start );
             }
         };
 
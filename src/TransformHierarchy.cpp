@@ -0,0 +1,201 @@
+//=====================================================================================================================
+//
+//   TransformHierarchy.cpp
+//
+//   Implementation of class: Simpleton::TransformHierarchy
+//
+//   The lazy man's utility library
+//   Joshua Barczak
+//   Copyright 2016 Joshua Barczak
+//
+//   LICENSE:  See Doc\License.txt for terms and conditions
+//
+//=====================================================================================================================
+
+#include "TransformHierarchy.h"
+#include "Parallel.h"
+#include <string.h>
+
+namespace Simpleton
+{
+
+    //=====================================================================================================================
+    //
+    //         Constructors/Destructors
+    //
+    //=====================================================================================================================
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    TransformHierarchy::TransformHierarchy() : m_bSorted(true)
+    {
+    }
+
+    //=====================================================================================================================
+    //
+    //            Public Methods
+    //
+    //=====================================================================================================================
+
+    //=====================================================================================================================
+    /// \param nParentID    ID of an existing node, or NO_PARENT to add a root
+    /// \param rLocal       Transform from the node's space to its parent's space
+    //=====================================================================================================================
+    uint32 TransformHierarchy::AddNode( uint32 nParentID, const Matrix4f& rLocal )
+    {
+        uint32 nID   = (uint32) m_ParentIDs.size();
+        uint32 nSlot = (uint32) m_Local.size();
+
+        // new nodes go on the end, out of level order, until the next sort
+        m_ParentIDs.push_back( nParentID );
+        m_Levels.push_back( (nParentID == NO_PARENT) ? 0 : m_Levels[nParentID]+1 );
+        m_IDToSlot.push_back( nSlot );
+        m_ParentSlots.push_back( (nParentID == NO_PARENT) ? (uint32)NO_PARENT : m_IDToSlot[nParentID] );
+        m_Local.push_back( rLocal );
+        m_World.push_back( rLocal );
+        m_Dirty.push_back( 1 );
+        m_bSorted = false;
+        return nID;
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void TransformHierarchy::SetLocalTransform( uint32 nID, const Matrix4f& rLocal )
+    {
+        uint32 nSlot = m_IDToSlot[nID];
+        m_Local[nSlot] = rLocal;
+        m_Dirty[nSlot] = 1;
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void TransformHierarchy::Update()
+    {
+        if( !m_bSorted )
+            Sort();
+
+        for( size_t i=0; i+1<m_LevelStart.size(); i++ )
+            UpdateRange( m_LevelStart[i], m_LevelStart[i+1] );
+
+        if( !m_Dirty.empty() )
+            memset( &m_Dirty[0], 0, m_Dirty.size() );
+    }
+
+    //=====================================================================================================================
+    /// Each level is a separate parallel loop, since it depends on the level above it
+    //=====================================================================================================================
+    void TransformHierarchy::Update( ThreadPool& rPool )
+    {
+        if( !m_bSorted )
+            Sort();
+
+        for( size_t i=0; i+1<m_LevelStart.size(); i++ )
+        {
+            uint32 nFirst = m_LevelStart[i];
+            uint32 nLast  = m_LevelStart[i+1];
+            if( nLast - nFirst <= PARALLEL_GRAIN )
+            {
+                UpdateRange( nFirst, nLast );
+            }
+            else
+            {
+                ParallelForChunked( rPool, nFirst, nLast, PARALLEL_GRAIN,
+                    [this]( size_t i0, size_t i1 ) { UpdateRange( (uint32)i0, (uint32)i1 ); } );
+            }
+        }
+
+        if( !m_Dirty.empty() )
+            memset( &m_Dirty[0], 0, m_Dirty.size() );
+    }
+
+    //=====================================================================================================================
+    //=====================================================================================================================
+    void TransformHierarchy::Clear()
+    {
+        m_ParentIDs.clear();
+        m_Levels.clear();
+        m_IDToSlot.clear();
+        m_ParentSlots.clear();
+        m_Local.clear();
+        m_World.clear();
+        m_Dirty.clear();
+        m_LevelStart.clear();
+        m_bSorted = true;
+    }
+
+    //=====================================================================================================================
+    //
+    //            Private Methods
+    //
+    //=====================================================================================================================
+
+    //=====================================================================================================================
+    /// Counting sort of the slots by level.  Nodes on the same level stay in ID order
+    //=====================================================================================================================
+    void TransformHierarchy::Sort()
+    {
+        uint32 nNodes = GetNodeCount();
+
+        uint32 nLevels = 0;
+        for( uint32 i=0; i<nNodes; i++ )
+            nLevels = (m_Levels[i]+1 > nLevels) ? m_Levels[i]+1 : nLevels;
+
+        m_LevelStart.assign( nLevels+1, 0 );
+        for( uint32 i=0; i<nNodes; i++ )
+            m_LevelStart[ m_Levels[i]+1 ]++;
+        for( uint32 i=0; i<nLevels; i++ )
+            m_LevelStart[i+1] += m_LevelStart[i];
+
+        std::vector<uint32> NewSlots( nNodes );
+        std::vector<uint32> Cursor( m_LevelStart.begin(), m_LevelStart.end()-1 );
+        for( uint32 i=0; i<nNodes; i++ )
+            NewSlots[i] = Cursor[ m_Levels[i] ]++;
+
+        std::vector<uint32>   ParentSlots( nNodes );
+        std::vector<Matrix4f> Local( nNodes );
+        std::vector<Matrix4f> World( nNodes );
+        std::vector<uint8>    Dirty( nNodes );
+        for( uint32 i=0; i<nNodes; i++ )
+        {
+            uint32 nOld = m_IDToSlot[i];
+            uint32 nNew = NewSlots[i];
+            ParentSlots[nNew] = (m_ParentIDs[i] == NO_PARENT) ? (uint32)NO_PARENT : NewSlots[ m_ParentIDs[i] ];
+            Local[nNew] = m_Local[nOld];
+            World[nNew] = m_World[nOld];
+            Dirty[nNew] = m_Dirty[nOld];
+        }
+
+        m_IDToSlot.swap( NewSlots );
+        m_ParentSlots.swap( ParentSlots );
+        m_Local.swap( Local );
+        m_World.swap( World );
+        m_Dirty.swap( Dirty );
+        m_bSorted = true;
+    }
+
+    //=====================================================================================================================
+    /// Updates slots [nFirst,nLast), which must all be on one level.
+    ///  Parents are on earlier levels, so their dirty flags are final by the time this runs
+    //=====================================================================================================================
+    void TransformHierarchy::UpdateRange( uint32 nFirst, uint32 nLast )
+    {
+        const uint32* pParents = &m_ParentSlots[0];
+        uint8* pDirty = &m_Dirty[0];
+
+        for( uint32 i=nFirst; i<nLast; i++ )
+        {
+            uint32 nParent = pParents[i];
+            if( nParent == NO_PARENT )
+            {
+                if( pDirty[i] )
+                    m_World[i] = m_Local[i];
+            }
+            else
+            {
+                pDirty[i] |= pDirty[nParent];
+                if( pDirty[i] )
+                    m_World[i] = m_Local[i] * m_World[nParent];
+            }
+        }
+    }
+}